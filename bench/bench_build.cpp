@@ -0,0 +1,352 @@
+#include "generate_project.h"
+
+#include "platform.h"
+#include "io.h"
+#include "string_builder.h"
+#include "process.h"
+#include "file_system.h"
+
+
+// NOTE: End to end benchmark of Bricks. Generates a synthetic project (see generate_project.h),
+//       builds it with the given bricks executable and appends the results as one line of JSON to
+//       the output file, so the results of different commits can be compared.
+//
+//       bench_build <bricks> [--label name] [--output file] [--folder folder] [--runs n]
+//                   [--entities n] [--sources n] [--import_depth n] [--brick_fan_in n]
+//                   [--headers n] [--header_includes n]
+//
+//       Every run builds the project with --rebuild and once more without changes, which measures
+//       what Bricks itself costs. Bricks reports the time it spent parsing and planning and its own
+//       peak memory with --timings. The first build isn't measured, it warms up the file cache.
+
+#define DEFAULT_RUNS 5
+
+struct BenchOptions {
+    String bricks;
+    String label;
+    String output;
+    String folder;
+    s32 runs;
+
+    ProjectShape shape;
+};
+
+// NOTE: One build. Times are in microseconds.
+struct BuildSample {
+    s64 wall;
+    s64 parse;
+    s64 plan;
+    s64 peak_memory_kb;
+};
+
+// NOTE: One list per measurement, over all runs.
+struct BuildSamples {
+    List<s64> wall;
+    List<s64> parse;
+    List<s64> plan;
+    List<s64> peak_memory_kb;
+};
+
+struct SampleStats {
+    s64 median;
+    s64 min;
+    s64 max;
+};
+
+
+INTERNAL b32 parse_count(String str, s32 *value) {
+    if (str.size == 0 || str.size > 9) return false;
+
+    s32 result = 0;
+    for (s64 i = 0; i < str.size; i += 1) {
+        if (str[i] < '0' || str[i] > '9') return false;
+        result = result * 10 + (str[i] - '0');
+    }
+
+    *value = result;
+    return true;
+}
+
+INTERNAL s64 last_slash(String path) {
+    for (s64 i = path.size; i > 0; i -= 1) {
+        if (path[i - 1] == '/' || path[i - 1] == '\\') return i - 1;
+    }
+
+    return -1;
+}
+
+// NOTE: The builds run in the project folder, so all paths given to them have to be absolute.
+INTERNAL String absolute_path(String path, String current_folder) {
+    b32 is_absolute = (path.size > 0 && (path[0] == '/' || path[0] == '\\')) || (path.size > 1 && path[1] == ':');
+    if (is_absolute) return path;
+
+    return format(DefaultAllocator, "%S/%S", current_folder, path);
+}
+
+INTERNAL b32 parse_options(Array<String> args, BenchOptions *options) {
+    *options = {};
+    options->runs   = DEFAULT_RUNS;
+    options->output = "build/bench/results.jsonl";
+    options->folder = "build/bench/project";
+    options->shape  = default_project_shape();
+
+    for (s64 i = 1; i < args.size; i += 1) {
+        String arg = args[i];
+
+        if (arg.size < 2 || arg[0] != '-' || arg[1] != '-') {
+            if (options->bricks != "") {
+                print("Unknown argument %S.\n", arg);
+                return false;
+            }
+
+            options->bricks = arg;
+            continue;
+        }
+
+        if (i + 1 >= args.size) {
+            print("Argument %S is missing a value.\n", arg);
+            return false;
+        }
+
+        String value = args[i + 1];
+        i += 1;
+
+        s32 *count = 0;
+        if      (arg == "--runs")            count = &options->runs;
+        else if (arg == "--entities")        count = &options->shape.entities;
+        else if (arg == "--sources")         count = &options->shape.sources;
+        else if (arg == "--import_depth")    count = &options->shape.import_depth;
+        else if (arg == "--brick_fan_in")    count = &options->shape.brick_fan_in;
+        else if (arg == "--headers")         count = &options->shape.headers;
+        else if (arg == "--header_includes") count = &options->shape.header_includes;
+
+        if (count) {
+            if (!parse_count(value, count)) {
+                print("Argument %S expects a number, got %S.\n", arg, value);
+                return false;
+            }
+        } else if (arg == "--label") {
+            options->label = value;
+        } else if (arg == "--output") {
+            options->output = value;
+        } else if (arg == "--folder") {
+            options->folder = value;
+        } else {
+            print("Unknown argument %S.\n", arg);
+            return false;
+        }
+    }
+
+    if (options->bricks == "") {
+        print("Usage: bench_build <bricks executable> [--label name] [--output file] [--folder folder] [--runs n]\n");
+        print("                   [--entities n] [--sources n] [--import_depth n] [--brick_fan_in n] [--headers n] [--header_includes n]\n");
+        return false;
+    }
+
+    if (options->runs < 1 || options->shape.entities < 1 || options->shape.sources < 1) {
+        print("--runs, --entities and --sources need to be at least 1.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// NOTE: Finds "key": and reads the number after it.
+INTERNAL b32 read_json_number(String line, String key, s64 *value) {
+    String pattern = t_format("\"%S\": ", key);
+
+    for (s64 start = 0; start + pattern.size <= line.size; start += 1) {
+        if (String(line.data + start, pattern.size) != pattern) continue;
+
+        s64 i = start + pattern.size;
+        b32 negative = i < line.size && line[i] == '-';
+        if (negative) i += 1;
+
+        s64 result = 0;
+        s64 digits = 0;
+        for (; i < line.size && line[i] >= '0' && line[i] <= '9'; i += 1) {
+            result = result * 10 + (line[i] - '0');
+            digits += 1;
+        }
+
+        if (digits == 0) return false;
+
+        *value = negative ? -result : result;
+        return true;
+    }
+
+    return false;
+}
+
+// NOTE: Runs Bricks in the project folder. Returns false if the build failed.
+INTERNAL b32 run_build(BenchOptions *options, String timings_file, b32 rebuild, BuildSample *sample) {
+    *sample = {};
+
+    platform_delete_file(timings_file);
+
+#if defined(OS_WINDOWS)
+    String command = t_format("cmd /c cd /d \"%S\" && \"%S\" --timings \"%S\"%S", options->folder, options->bricks, timings_file, rebuild ? String(" --rebuild") : String());
+#else
+    String command = t_format("cd \"%S\" && \"%S\" --timings \"%S\"%S", options->folder, options->bricks, timings_file, rebuild ? String(" --rebuild") : String());
+#endif
+
+    ProcessLauncher launcher = {};
+    DEFER(destroy(&launcher));
+
+    if (!launch_process(&launcher, command, 0)) {
+        print("Could not run %S.\n", command);
+        return false;
+    }
+
+    List<FinishedProcess> finished = {};
+    DEFER(destroy(&finished));
+
+    while (finished.size == 0) wait_for_processes(&launcher, &finished);
+
+    FinishedProcess *process = &finished[0];
+    DEFER(destroy(process));
+
+    if (process->error || process->exit_code != 0) {
+        print("%S\nThe build failed: %S\n", process->output, command);
+        return false;
+    }
+
+    sample->wall = process->duration;
+
+    auto read_result = platform_read_entire_file(timings_file);
+    DEFER(destroy(&read_result.content));
+
+    s64 result = 0;
+    if (read_result.error ||
+        !read_json_number(read_result.content, "parse_us",       &sample->parse) ||
+        !read_json_number(read_result.content, "plan_us",        &sample->plan)  ||
+        !read_json_number(read_result.content, "peak_memory_kb", &sample->peak_memory_kb) ||
+        !read_json_number(read_result.content, "result",         &result) || result != 0) {
+        print("%S did not write its timings to %S, it may be older than --timings.\n", options->bricks, timings_file);
+        return false;
+    }
+
+    return true;
+}
+
+INTERNAL void add_sample(BuildSamples *samples, BuildSample *sample) {
+    append(&samples->wall,           sample->wall);
+    append(&samples->parse,          sample->parse);
+    append(&samples->plan,           sample->plan);
+    append(&samples->peak_memory_kb, sample->peak_memory_kb);
+}
+
+INTERNAL void destroy(BuildSamples *samples) {
+    destroy(&samples->wall);
+    destroy(&samples->parse);
+    destroy(&samples->plan);
+    destroy(&samples->peak_memory_kb);
+}
+
+// NOTE: Sorts the values.
+INTERNAL SampleStats get_stats(List<s64> values) {
+    // NOTE: A handful of runs, insertion sort is enough.
+    for (s64 i = 1; i < values.size; i += 1) {
+        s64 value = values[i];
+
+        s64 j = i;
+        for (; j > 0 && values[j - 1] > value; j -= 1) values[j] = values[j - 1];
+        values[j] = value;
+    }
+
+    SampleStats result = {};
+    result.min    = values[0];
+    result.max    = values[values.size - 1];
+    result.median = values.size % 2 ? values[values.size / 2] : (values[values.size / 2 - 1] + values[values.size / 2]) / 2;
+
+    return result;
+}
+
+INTERNAL void append_stats(StringBuilder *builder, String name, SampleStats stats) {
+    format(builder, ", \"%S\": {\"median\": %d, \"min\": %d, \"max\": %d}", name, (s32)stats.median, (s32)stats.min, (s32)stats.max);
+}
+
+s32 application_main(Array<String> args) {
+    BenchOptions options = {};
+    if (!parse_options(args, &options)) return -1;
+
+    String current_folder = platform_current_folder(DefaultAllocator);
+    if (current_folder == "") {
+        print("Could not retrieve current path.\n");
+        return -1;
+    }
+
+    options.folder = absolute_path(options.folder, current_folder);
+    options.output = absolute_path(options.output, current_folder);
+
+    // NOTE: A name without a folder is looked up in the path.
+    if (last_slash(options.bricks) != -1) options.bricks = absolute_path(options.bricks, current_folder);
+
+    ProjectShape *shape = &options.shape;
+
+    s32 file_count = generate_project(options.folder, shape);
+    if (file_count < 0) {
+        print("Could not generate the project in %S.\n", options.folder);
+        return -1;
+    }
+
+    print("Generated %d files in %S: %d modules with %d entities of %d sources, %d bricks per entity, %d headers.\n",
+          file_count, options.folder, shape->import_depth + 1, shape->entities, shape->sources, shape->brick_fan_in, shape->headers);
+
+    String timings_file = t_format("%S/timings", options.folder);
+
+    BuildSample warmup = {};
+    if (!run_build(&options, timings_file, true, &warmup)) return -1;
+
+    BuildSamples full_builds = {};
+    BuildSamples noop_builds = {};
+    DEFER(destroy(&full_builds));
+    DEFER(destroy(&noop_builds));
+
+    for (s32 run = 0; run < options.runs; run += 1) {
+        BuildSample sample = {};
+
+        if (!run_build(&options, timings_file, true, &sample)) return -1;
+        add_sample(&full_builds, &sample);
+
+        if (!run_build(&options, timings_file, false, &sample)) return -1;
+        add_sample(&noop_builds, &sample);
+    }
+
+    // NOTE: Parsing and planning don't depend on what runs afterwards, the no-op builds have the least noise.
+    SampleStats full  = get_stats(full_builds.wall);
+    SampleStats noop  = get_stats(noop_builds.wall);
+    SampleStats parse = get_stats(noop_builds.parse);
+    SampleStats plan  = get_stats(noop_builds.plan);
+    SampleStats peak  = get_stats(full_builds.peak_memory_kb);
+
+    // NOTE: The label isn't escaped, names of commits or branches don't need it.
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "{\"label\": \"%S\", \"runs\": %d, \"files\": %d", options.label, options.runs, file_count);
+    format(&builder, ", \"entities\": %d, \"sources\": %d, \"import_depth\": %d, \"brick_fan_in\": %d, \"headers\": %d, \"header_includes\": %d",
+           shape->entities, shape->sources, shape->import_depth, shape->brick_fan_in, shape->headers, shape->header_includes);
+
+    append_stats(&builder, "full_build_us",  full);
+    append_stats(&builder, "noop_build_us",  noop);
+    append_stats(&builder, "parse_us",       parse);
+    append_stats(&builder, "plan_us",        plan);
+    append_stats(&builder, "peak_memory_kb", peak);
+    append(&builder, "}\n");
+
+    String line = to_allocated_string(&builder, DefaultAllocator);
+    DEFER(destroy(&line));
+
+    platform_create_all_folders(String(options.output.data, last_slash(options.output)));
+    if (!platform_append_to_file(options.output, line.data, line.size)) {
+        print("Could not write to %S.\n", options.output);
+        return -1;
+    }
+
+    print("Full build %d ms, no-op build %d ms, parse %d ms, peak memory %d MB (medians of %d runs).\n",
+          (s32)(full.median / 1000), (s32)(noop.median / 1000), (s32)(parse.median / 1000), (s32)(peak.median / 1024), options.runs);
+    print("Appended the results to %S.\n", options.output);
+
+    return 0;
+}
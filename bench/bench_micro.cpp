@@ -0,0 +1,420 @@
+#include "bricks.h"
+
+#include "platform.h"
+#include "io.h"
+#include "string_builder.h"
+#include "blueprint.h"
+#include "brickyard.h"
+#include "process.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+// NOTE: Micro benchmarks of the paths of Bricks that run for every blueprint, entity and dependency.
+//       Links all of Bricks, which is compiled with BRICKS_NO_MAIN for it.
+//
+//       bench_micro [name] [--repetitions n] [--entities n]
+//
+//       Every benchmark is first warmed up, which also finds how many calls make up a batch that
+//       takes long enough to be timed precisely. Then each repetition times one batch, and the
+//       median and percentiles are of the time per call over all repetitions.
+
+extern ApplicationState App;
+
+#define DEFAULT_REPETITIONS 31
+#define DEFAULT_ENTITIES    200
+
+#define WARMUP_MICROSECONDS 200000
+#define BATCH_MICROSECONDS  2000
+
+typedef void BenchFunc(void *data);
+
+struct BenchOptions {
+    String filter;
+    s32 repetitions;
+    s32 entities;
+};
+
+struct Benchmark {
+    String name;
+    BenchFunc *run;
+    void *data;
+
+    s64 bytes; // NOTE: Read per call, for cycles per byte. 0 if it doesn't apply.
+    s64 items; // NOTE: Looked up or merged per call, for the time per item.
+
+    // NOTE: Optional. Called between batches, outside of the measured time.
+    BenchFunc *reset;
+};
+
+// NOTE: The result is only written, so the compiler can't drop the calls.
+INTERNAL volatile s64 Sink;
+
+
+// NOTE: Cycles of the time stamp counter. It ticks at a fixed rate close to the base clock, not
+//       the actual one under turbo or power saving. 0 where there is none.
+INTERNAL u64 read_cycles() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+INTERNAL s64 run_batch(Benchmark *bench, s64 calls, u64 *cycles) {
+    SCOPE_TEMP_STORAGE();
+
+    s64 start_time   = platform_time_microseconds();
+    u64 start_cycles = read_cycles();
+
+    for (s64 i = 0; i < calls; i += 1) bench->run(bench->data);
+
+    *cycles = read_cycles() - start_cycles;
+    s64 time = platform_time_microseconds() - start_time;
+
+    if (bench->reset) bench->reset(bench->data);
+
+    return time;
+}
+
+INTERNAL void sort(List<s64> *values) {
+    for (s64 i = 1; i < values->size; i += 1) {
+        s64 value = (*values)[i];
+
+        s64 j = i;
+        for (; j > 0 && (*values)[j - 1] > value; j -= 1) (*values)[j] = (*values)[j - 1];
+        (*values)[j] = value;
+    }
+}
+
+INTERNAL s64 percentile(List<s64> *sorted, s32 percent) {
+    return (*sorted)[(sorted->size - 1) * percent / 100];
+}
+
+// NOTE: Two decimals, the value is in hundredths.
+INTERNAL String decimal_string(s64 hundredths) {
+    return t_format("%d.%d%d", (s32)(hundredths / 100), (s32)(hundredths / 10 % 10), (s32)(hundredths % 10));
+}
+
+INTERNAL String duration_string(s64 nanoseconds) {
+    if (nanoseconds < 10000)    return t_format("%d ns", (s32)nanoseconds);
+    if (nanoseconds < 10000000) return t_format("%S us", decimal_string(nanoseconds / 10));
+
+    return t_format("%S ms", decimal_string(nanoseconds / 10000));
+}
+
+INTERNAL void run_benchmark(BenchOptions *options, Benchmark *bench) {
+    if (options->filter != "" && bench->name != options->filter) return;
+
+    // NOTE: Doubles the batch until it takes long enough, and keeps going until the warmup is over.
+    s64 calls = 1;
+    s64 warmup_start = platform_time_microseconds();
+
+    while (true) {
+        u64 cycles = 0;
+        s64 time = run_batch(bench, calls, &cycles);
+
+        if (time < BATCH_MICROSECONDS) {
+            calls *= 2;
+            continue;
+        }
+
+        if (platform_time_microseconds() - warmup_start >= WARMUP_MICROSECONDS) break;
+    }
+
+    List<s64> times  = {};
+    List<s64> cycles = {};
+    DEFER(destroy(&times));
+    DEFER(destroy(&cycles));
+
+    for (s32 i = 0; i < options->repetitions; i += 1) {
+        u64 batch_cycles = 0;
+        s64 time = run_batch(bench, calls, &batch_cycles);
+
+        append(&times,  time * 1000 / calls);
+        append(&cycles, (s64)batch_cycles / calls);
+    }
+
+    sort(&times);
+    sort(&cycles);
+
+    s64 median = percentile(&times, 50);
+
+    print("%S: median %S, p90 %S, p99 %S, min %S per call",
+          bench->name, duration_string(median), duration_string(percentile(&times, 90)),
+          duration_string(percentile(&times, 99)), duration_string(times[0]));
+
+    if (bench->items) print(", %S per item", duration_string(median / bench->items));
+
+    s64 median_cycles = percentile(&cycles, 50);
+    if (bench->bytes && median_cycles) {
+        print(", %S cycles per byte", decimal_string(median_cycles * 100 / bench->bytes));
+    }
+    if (bench->bytes && median) {
+        print(", %d MB/s", (s32)(bench->bytes * 1000000000 / median / (1024 * 1024)));
+    }
+
+    print(" (%d calls x %d repetitions)\n", (s32)calls, options->repetitions);
+}
+
+
+// NOTE: A blueprint like a real one, with comments, bricks and executables that use them.
+INTERNAL String synthetic_blueprint(s32 entities) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    append(&builder, "// ========================================================\n");
+    append(&builder, "// Generated by bench_micro.\n");
+    append(&builder, "// ========================================================\n");
+    append(&builder, "build_folder: \"build\";\n\n");
+
+    for (s32 i = 0; i < entities; i += 1) {
+        if (i % 4 == 0) {
+            format(&builder, "brick: brick_%d {\n", i);
+            format(&builder, "    include: \"bricks/brick_%d/include\";\n", i);
+            format(&builder, "    symbols: \"USE_BRICK_%d\", \"BRICK_VERSION=%d\";\n", i, i);
+            format(&builder, "    sources: /\"bricks/brick_%d\", \"brick.cpp\", \"brick_util.cpp\";\n", i);
+            append(&builder, "}\n\n");
+            continue;
+        }
+
+        format(&builder, "// Entity number %d.\n", i);
+        format(&builder, "%S: entity_%d {\n", i % 4 == 1 ? String("library") : String("executable"), i);
+        append(&builder, "    folder: \"build/debug\";\n");
+        append(&builder, "    folder(release): \"build/release\";\n");
+        append(&builder, "    include: \"include\", \"source\";\n");
+        append(&builder, "    symbols: \"DEVELOPER\", \"BOUNDS_CHECKING\";\n");
+        format(&builder, "    sources: /\"source/entity_%d\", \"main.cpp\", \"parser.cpp\", \"jobs.cpp\", \"memory.cpp\";\n", i);
+        append(&builder, "    sources(#win32): /\"source/win32\", \"platform.cpp\";\n");
+        append(&builder, "    sources(#linux): /\"source/linux\", \"platform.cpp\";\n");
+        format(&builder, "    dependencies: brick_%d;\n", i / 4 * 4);
+        append(&builder, "    dependencies(#win32): \"Dbghelp.lib\";\n");
+        append(&builder, "}\n\n");
+    }
+
+    return to_allocated_string(&builder, DefaultAllocator);
+}
+
+INTERNAL void reset_persistent_memory() {
+    destroy(&App.persistent_memory);
+    init(&App.persistent_memory, MEGABYTES(1));
+
+    App.persistent_alloc = make_pool_allocator(&App.persistent_memory);
+}
+
+
+INTERNAL void bench_lexer(void *data) {
+    Sink = count_tokens(*(String*)data);
+}
+
+INTERNAL void bench_parse_blueprint(void *data) {
+    Blueprint *blueprint = create_blueprint();
+    parse_blueprint(blueprint, *(String*)data);
+
+    Sink = blueprint->entities.alloc;
+    destroy(blueprint);
+}
+
+// NOTE: The blueprints and entities are allocated with the persistent allocator.
+INTERNAL void reset_parse_blueprint(void *data) {
+    reset_persistent_memory();
+}
+
+struct LookupData {
+    Blueprint *blueprint;
+    Brickyard *brickyard;
+    List<String> names;
+};
+
+INTERNAL void bench_find_dependency(void *data) {
+    LookupData *lookup = (LookupData*)data;
+
+    FOR (lookup->names, name) Sink = find_dependency(lookup->blueprint, *name) != 0;
+}
+
+INTERNAL void bench_brickyard_find(void *data) {
+    LookupData *lookup = (LookupData*)data;
+
+    FOR (lookup->names, name) Sink = find(lookup->brickyard, *name).size;
+}
+
+struct MergeData {
+    List<String> dest;
+    List<String> src;
+    s64 dest_size; // NOTE: dest is cut back to this before every merge.
+};
+
+INTERNAL void bench_merge_arrays(void *data) {
+    MergeData *merge = (MergeData*)data;
+
+    merge->dest.size = merge->dest_size;
+    merge_arrays(&merge->dest, merge->src);
+
+    Sink = merge->dest.size;
+}
+
+// NOTE: The worst case, the string is the last one in the list.
+INTERNAL void bench_append_unique(void *data) {
+    MergeData *merge = (MergeData*)data;
+
+    append_unique(&merge->dest, merge->dest[merge->dest.size - 1]);
+
+    Sink = merge->dest.size;
+}
+
+// NOTE: Folders and libraries like the ones an Entity gets from its Bricks, half of src is in dest already.
+INTERNAL void init_merge_data(MergeData *merge, s32 count) {
+    for (s32 i = 0; i < count; i += 1) {
+        append(&merge->dest, format(DefaultAllocator, "dependencies/library_%d/include", i));
+        append(&merge->src,  format(DefaultAllocator, "dependencies/library_%d/include", i + count / 2));
+    }
+
+    merge->dest_size = merge->dest.size;
+}
+
+INTERNAL void destroy(MergeData *merge) {
+    FOR (merge->dest, it) destroy(it);
+    FOR (merge->src,  it) destroy(it);
+
+    destroy(&merge->dest);
+    destroy(&merge->src);
+}
+
+
+INTERNAL b32 parse_options(Array<String> args, BenchOptions *options) {
+    *options = {};
+    options->repetitions = DEFAULT_REPETITIONS;
+    options->entities    = DEFAULT_ENTITIES;
+
+    for (s64 i = 1; i < args.size; i += 1) {
+        String arg = args[i];
+
+        if (arg != "--repetitions" && arg != "--entities") {
+            if (options->filter != "") {
+                print("Unknown argument %S.\n", arg);
+                return false;
+            }
+
+            options->filter = arg;
+            continue;
+        }
+
+        s32 *value = arg == "--repetitions" ? &options->repetitions : &options->entities;
+
+        i += 1;
+        if (i >= args.size) {
+            print("Argument %S is missing a number.\n", arg);
+            return false;
+        }
+
+        *value = 0;
+        for (s64 c = 0; c < args[i].size; c += 1) {
+            if (args[i][c] < '0' || args[i][c] > '9' || c > 8) {
+                *value = 0;
+                break;
+            }
+
+            *value = *value * 10 + (args[i][c] - '0');
+        }
+
+        if (*value < 1) {
+            print("Argument %S expects a positive number, got %S.\n", arg, args[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+s32 application_main(Array<String> args) {
+    init(&App.persistent_memory, MEGABYTES(1));
+    DEFER(destroy(&App.persistent_memory));
+
+    App.persistent_alloc = make_pool_allocator(&App.persistent_memory);
+
+    BenchOptions options = {};
+    if (!parse_options(args, &options)) {
+        print("Usage: bench_micro [lexer|parse_blueprint|find_dependency|brickyard_find|merge_arrays|append_unique] [--repetitions n] [--entities n]\n");
+        return -1;
+    }
+
+    String code = synthetic_blueprint(options.entities);
+    DEFER(destroy(&code));
+
+    print("Blueprint of %d entities, %d KB, %d tokens.\n\n", options.entities, (s32)(code.size / 1024), (s32)count_tokens(code));
+
+    Benchmark lexer = {};
+    lexer.name  = "lexer";
+    lexer.run   = bench_lexer;
+    lexer.data  = &code;
+    lexer.bytes = code.size;
+    run_benchmark(&options, &lexer);
+
+    Benchmark parse = {};
+    parse.name  = "parse_blueprint";
+    parse.run   = bench_parse_blueprint;
+    parse.reset = reset_parse_blueprint;
+    parse.data  = &code;
+    parse.bytes = code.size;
+    run_benchmark(&options, &parse);
+
+    // NOTE: Parsed after the benchmark above, which throws the persistent memory away.
+    LookupData lookup = {};
+    DEFER(destroy(&lookup.names));
+
+    lookup.blueprint = create_blueprint();
+    parse_blueprint(lookup.blueprint, code);
+    DEFER(destroy(lookup.blueprint));
+
+    Brickyard brickyard = {};
+    brickyard.allocator = DefaultAllocator;
+    lookup.brickyard = &brickyard;
+    DEFER(destroy(&brickyard));
+
+    for (s64 i = 0; i < lookup.blueprint->entities.alloc; i += 1) {
+        auto *entry = &lookup.blueprint->entities.entries[i];
+        if (entry->hash == 0) continue;
+
+        append(&lookup.names, entry->key);
+        add(&brickyard, entry->key, "", t_format("/home/user/projects/%S", entry->key));
+    }
+
+    Benchmark find_dep = {};
+    find_dep.name  = "find_dependency";
+    find_dep.run   = bench_find_dependency;
+    find_dep.data  = &lookup;
+    find_dep.items = lookup.names.size;
+    run_benchmark(&options, &find_dep);
+
+    Benchmark yard = {};
+    yard.name  = "brickyard_find";
+    yard.run   = bench_brickyard_find;
+    yard.data  = &lookup;
+    yard.items = lookup.names.size;
+    run_benchmark(&options, &yard);
+
+    MergeData merge = {};
+    init_merge_data(&merge, 64);
+    DEFER(destroy(&merge));
+
+    Benchmark merge_bench = {};
+    merge_bench.name  = "merge_arrays";
+    merge_bench.run   = bench_merge_arrays;
+    merge_bench.data  = &merge;
+    merge_bench.items = merge.src.size;
+    run_benchmark(&options, &merge_bench);
+
+    merge.dest.size = merge.dest_size;
+
+    Benchmark unique = {};
+    unique.name = "append_unique";
+    unique.run  = bench_append_unique;
+    unique.data = &merge;
+    run_benchmark(&options, &unique);
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "generate_project.h"
+
+#include "platform.h"
+#include "string_builder.h"
+
+
+ProjectShape default_project_shape() {
+    ProjectShape result = {};
+    result.entities        = 4;
+    result.sources         = 16;
+    result.import_depth    = 3;
+    result.brick_fan_in    = 4;
+    result.headers         = 32;
+    result.header_includes = 3;
+
+    return result;
+}
+
+struct ProjectWriter {
+    String folder;
+    StringBuilder builder;
+
+    s32 file_count;
+    b32 error;
+};
+
+// NOTE: Writes what is in the builder to the file and resets it.
+INTERNAL void write_file(ProjectWriter *writer, String file, StringBuilder *builder) {
+    if (writer->error) return;
+
+    PlatformFile handle = platform_file_open(t_format("%S/%S", writer->folder, file), PlatformFileOverride);
+    if (!handle.open || !write_builder_to_file(builder, &handle)) writer->error = true;
+
+    platform_file_close(&handle);
+    reset(builder);
+
+    writer->file_count += 1;
+}
+
+INTERNAL void create_folder(ProjectWriter *writer, String folder) {
+    if (!platform_create_all_folders(t_format("%S/%S", writer->folder, folder))) writer->error = true;
+}
+
+// NOTE: Header i includes the ones after it, so a source including header 0 reads all of them.
+INTERNAL void write_headers(ProjectWriter *writer, ProjectShape *shape, String module, String prefix) {
+    create_folder(writer, t_format("%S/include", module));
+
+    for (s32 i = 0; i < shape->headers; i += 1) {
+        SCOPE_TEMP_STORAGE();
+
+        StringBuilder *builder = &writer->builder;
+        append(builder, "#pragma once\n\n");
+
+        s32 last = i + shape->header_includes;
+        if (last >= shape->headers) last = shape->headers - 1;
+
+        for (s32 included = i + 1; included <= last; included += 1) {
+            format(builder, "#include \"header_%d.h\"\n", included);
+        }
+
+        format(builder, "\ninline int %Sheader_%d(int x) {\n", prefix, i);
+        if (i < last) {
+            format(builder, "    return %Sheader_%d(x) ^ %d;\n", prefix, i + 1, i);
+        } else {
+            format(builder, "    return x ^ %d;\n", i);
+        }
+        append(builder, "}\n");
+
+        write_file(writer, t_format("%S/include/header_%d.h", module, i), builder);
+    }
+}
+
+// NOTE: Appends the declarations of the bricks to the blueprint.
+INTERNAL void write_bricks(ProjectWriter *writer, ProjectShape *shape, String module, String prefix, StringBuilder *blueprint) {
+    create_folder(writer, t_format("%S/bricks", module));
+
+    for (s32 i = 0; i < shape->brick_fan_in; i += 1) {
+        SCOPE_TEMP_STORAGE();
+
+        format(&writer->builder, "int %Sbrick_%d(int x) {\n    return x ^ %d;\n}\n", prefix, i, i);
+        write_file(writer, t_format("%S/bricks/brick_%d.cpp", module, i), &writer->builder);
+
+        format(blueprint, "brick: brick_%d {\n", i);
+        append(blueprint, "    include: \"include\";\n");
+        format(blueprint, "    symbols: \"USE_BRICK_%d\";\n", i);
+        format(blueprint, "    sources: \"bricks/brick_%d.cpp\";\n", i);
+        append(blueprint, "}\n\n");
+    }
+}
+
+INTERNAL void write_sources(ProjectWriter *writer, ProjectShape *shape, String module, String prefix, String entity, b32 with_main) {
+    for (s32 i = 0; i < shape->sources; i += 1) {
+        SCOPE_TEMP_STORAGE();
+
+        StringBuilder *builder = &writer->builder;
+
+        s32 header = shape->headers ? i % shape->headers : 0;
+        if (shape->headers) format(builder, "#include \"header_%d.h\"\n\n", header);
+
+        format(builder, "int %S%S_%d(int x) {\n", prefix, entity, i);
+        if (shape->headers) {
+            format(builder, "    return %Sheader_%d(x) ^ %d;\n", prefix, header, i);
+        } else {
+            format(builder, "    return x ^ %d;\n", i);
+        }
+        append(builder, "}\n");
+
+        if (with_main && i == 0) format(builder, "\nint main() {\n    return %S%S_0(0) < 0;\n}\n", prefix, entity);
+
+        write_file(writer, t_format("%S/source/%S_%d.cpp", module, entity, i), builder);
+    }
+}
+
+// NOTE: Writes the blueprint of one module: its bricks, then one entity per shape->entities. Each
+//       depends on all bricks of the module and on the entity with the same index in the next module.
+INTERNAL void write_module(ProjectWriter *writer, ProjectShape *shape, s32 depth) {
+    String module = depth == 0 ? String(".") : t_format("modules/m%d", depth);
+    String prefix = depth == 0 ? String("top_") : t_format("m%d_", depth);
+
+    b32 is_top   = depth == 0;
+    b32 has_next = depth < shape->import_depth;
+
+    create_folder(writer, t_format("%S/source", module));
+
+    write_headers(writer, shape, module, prefix);
+
+    StringBuilder blueprint = {};
+    DEFER(destroy(&blueprint));
+
+    append(&blueprint, "// Generated by bench_build, see bench/generate_project.h.\n");
+    if (has_next) format(&blueprint, "use local \"modules/m%d\" as next;\n", depth + 1);
+    append(&blueprint, "\n");
+
+    write_bricks(writer, shape, module, prefix, &blueprint);
+
+    for (s32 i = 0; i < shape->entities; i += 1) {
+        SCOPE_TEMP_STORAGE();
+
+        String entity = is_top ? t_format("app_%d", i) : t_format("lib_%d", i);
+        write_sources(writer, shape, module, prefix, entity, is_top);
+
+        format(&blueprint, "%S: %S {\n", is_top ? String("executable") : String("library"), entity);
+        if (is_top) append(&blueprint, "    folder: \"build\";\n");
+        append(&blueprint, "    include: \"include\";\n");
+
+        append(&blueprint, "    sources: /\"source\"");
+        for (s32 source = 0; source < shape->sources; source += 1) format(&blueprint, ", \"%S_%d.cpp\"", entity, source);
+        append(&blueprint, ";\n");
+
+        if (shape->brick_fan_in || has_next) {
+            append(&blueprint, "    dependencies: ");
+            for (s32 brick = 0; brick < shape->brick_fan_in; brick += 1) {
+                format(&blueprint, brick ? ", brick_%d" : "brick_%d", brick);
+            }
+            if (has_next) format(&blueprint, shape->brick_fan_in ? ", next.lib_%d" : "next.lib_%d", i);
+            append(&blueprint, ";\n");
+        }
+
+        append(&blueprint, "}\n\n");
+    }
+
+    write_file(writer, t_format("%S/blueprint", module), &blueprint);
+}
+
+s32 generate_project(String folder, ProjectShape *shape) {
+    ProjectWriter writer = {};
+    writer.folder = folder;
+    DEFER(destroy(&writer.builder));
+
+    if (!platform_create_all_folders(folder)) return -1;
+
+    for (s32 depth = 0; depth <= shape->import_depth; depth += 1) {
+        write_module(&writer, shape, depth);
+
+        if (writer.error) return -1;
+    }
+
+    return writer.file_count;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "definitions.h"
+#include "string2.h"
+
+
+// NOTE: The shape of a synthetic project for benchmarking Bricks itself. Every module is a folder
+//       with a blueprint, the one at the top has the executables and each one below is imported by
+//       the one before it and has the libraries they link.
+//
+//       <folder>/blueprint                       Executables, imports modules/m1.
+//       <folder>/modules/m<k>/blueprint          Libraries, imports modules/m<k + 1>.
+//       <module>/source/<entity>_<i>.cpp         Sources, each includes one of the headers.
+//       <module>/include/header_<i>.h            Headers, each includes the next header_includes ones.
+//       <module>/bricks/brick_<i>.cpp            Sources of the bricks every entity of the module uses.
+struct ProjectShape {
+    s32 entities;        // NOTE: Per module.
+    s32 sources;         // NOTE: Per entity.
+    s32 import_depth;    // NOTE: Modules below the top one.
+    s32 brick_fan_in;    // NOTE: Bricks every entity uses.
+    s32 headers;         // NOTE: Per module.
+    s32 header_includes; // NOTE: Headers every header includes.
+};
+
+ProjectShape default_project_shape();
+
+// NOTE: Replaces the files of an earlier project in folder. Returns the number of files written,
+//       -1 if one could not be written.
+s32 generate_project(String folder, ProjectShape *shape);
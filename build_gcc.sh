@@ -1,7 +1,7 @@
 #! /bin/bash
 
 echo Building Executable bricks
-g++ -D"DEVELOPER" -D"BOUNDS_CHECKING" -I"source" -I"dependencies/mountain/source" -g -o build/debug/bricks "source/bricks.cpp" "source/blueprint.cpp" "source/brickyard.cpp" "source/core_compilers/gcc.cpp" "source/core_compilers/msvc.cpp" "dependencies/mountain/source/io.cpp" "dependencies/mountain/source/utf.cpp" "dependencies/mountain/source/ui.cpp" "dependencies/mountain/source/font.cpp" "dependencies/mountain/source/config.cpp" "dependencies/mountain/source/linux/platform.cpp"
+g++ -D"DEVELOPER" -D"BOUNDS_CHECKING" -I"source" -I"dependencies/mountain/source" -g -o build/debug/bricks "source/bricks.cpp" "source/blueprint.cpp" "source/brickyard.cpp" "source/jobs.cpp" "source/build_log.cpp" "source/file_cache.cpp" "source/glob.cpp" "source/remote.cpp" "source/remote_cache.cpp" "source/local_cache.cpp" "source/compression.cpp" "source/http.cpp" "source/compiler_plugin.cpp" "source/linux/process.cpp" "source/linux/file_system.cpp" "source/linux/file_watcher.cpp" "source/linux/shared_library.cpp" "source/linux/network.cpp" "source/core_compilers/gcc.cpp" "source/core_compilers/msvc.cpp" "source/core_compilers/clang.cpp" "dependencies/mountain/source/io.cpp" "dependencies/mountain/source/utf.cpp" "dependencies/mountain/source/ui.cpp" "dependencies/mountain/source/font.cpp" "dependencies/mountain/source/config.cpp" "dependencies/mountain/source/linux/platform.cpp" -ldl
 
 echo build_gcc.sh finished.
 
@@ -1,4 +1,4 @@
 @echo off
 
 echo Building Executable bricks
-cl /nologo /permissive- /W2 /Zi /D"DEVELOPER" /D"BOUNDS_CHECKING" /I"source" /I"dependencies/mountain/source" /Fe"build/debug/bricks.exe" /Fo".bricks/bricks.exe/debug/" /Fd"build/debug/" "source/bricks.cpp" "source/blueprint.cpp" "source/brickyard.cpp" "source/core_compilers\msvc.cpp" "source/core_compilers\gcc.cpp" "dependencies/mountain/source/io.cpp" "dependencies/mountain/source/utf.cpp" "dependencies/mountain/source/ui.cpp" "dependencies/mountain/source/font.cpp" "dependencies/mountain/source/config.cpp" "dependencies/mountain/source/win32/platform.cpp" /link /SUBSYSTEM:CONSOLE /INCREMENTAL:NO "User32.lib" "Shell32.lib" "Gdi32.lib" "Ole32.lib"
+cl /nologo /permissive- /W2 /Zi /D"DEVELOPER" /D"BOUNDS_CHECKING" /I"source" /I"dependencies/mountain/source" /Fe"build/debug/bricks.exe" /Fo".bricks/bricks.exe/debug/" /Fd"build/debug/" "source/bricks.cpp" "source/blueprint.cpp" "source/brickyard.cpp" "source/jobs.cpp" "source/build_log.cpp" "source/file_cache.cpp" "source/glob.cpp" "source/remote.cpp" "source/remote_cache.cpp" "source/local_cache.cpp" "source/compression.cpp" "source/http.cpp" "source/compiler_plugin.cpp" "source/win32/process.cpp" "source/win32/file_system.cpp" "source/win32/file_watcher.cpp" "source/win32/shared_library.cpp" "source/win32/network.cpp" "source/core_compilers\msvc.cpp" "source/core_compilers\clang.cpp" "source/core_compilers\gcc.cpp" "dependencies/mountain/source/io.cpp" "dependencies/mountain/source/utf.cpp" "dependencies/mountain/source/ui.cpp" "dependencies/mountain/source/font.cpp" "dependencies/mountain/source/config.cpp" "dependencies/mountain/source/win32/platform.cpp" /link /SUBSYSTEM:CONSOLE /INCREMENTAL:NO "User32.lib" "Shell32.lib" "Gdi32.lib" "Ole32.lib" "Ws2_32.lib"
@@ -3,4 +3,4 @@
 echo Building Executable bricks
 IF NOT EXIST build/release mkdir "build/release"
 IF NOT EXIST .bricks/bricks.exe/release mkdir ".bricks/bricks.exe/release"
-cl /nologo /permissive- /W2 /D"DEVELOPER" /D"BOUNDS_CHECKING" /I"source" /I"dependencies/mountain/source" /Fe"build/release/bricks.exe" /Fo".bricks/bricks.exe/release/" "source/bricks.cpp" "source/blueprint.cpp" "source/brickyard.cpp" "source/core_compilers\msvc.cpp" "dependencies/mountain/source/io.cpp" "dependencies/mountain/source/utf.cpp" "dependencies/mountain/source/ui.cpp" "dependencies/mountain/source/font.cpp" "dependencies/mountain/source/config.cpp" "dependencies/mountain/source/win32/platform.cpp" /link /SUBSYSTEM:CONSOLE /INCREMENTAL:NO "User32.lib" "Shell32.lib" "Gdi32.lib" "Ole32.lib"
+cl /nologo /permissive- /W2 /D"DEVELOPER" /D"BOUNDS_CHECKING" /I"source" /I"dependencies/mountain/source" /Fe"build/release/bricks.exe" /Fo".bricks/bricks.exe/release/" "source/bricks.cpp" "source/blueprint.cpp" "source/brickyard.cpp" "source/jobs.cpp" "source/build_log.cpp" "source/file_cache.cpp" "source/glob.cpp" "source/remote.cpp" "source/remote_cache.cpp" "source/local_cache.cpp" "source/compression.cpp" "source/http.cpp" "source/compiler_plugin.cpp" "source/win32/process.cpp" "source/win32/file_system.cpp" "source/win32/file_watcher.cpp" "source/win32/shared_library.cpp" "source/win32/network.cpp" "source/core_compilers\msvc.cpp" "source/core_compilers\clang.cpp" "dependencies/mountain/source/io.cpp" "dependencies/mountain/source/utf.cpp" "dependencies/mountain/source/ui.cpp" "dependencies/mountain/source/font.cpp" "dependencies/mountain/source/config.cpp" "dependencies/mountain/source/win32/platform.cpp" /link /SUBSYSTEM:CONSOLE /INCREMENTAL:NO "User32.lib" "Shell32.lib" "Gdi32.lib" "Ole32.lib" "Ws2_32.lib"
@@ -0,0 +1,6 @@
+#! /bin/bash
+
+echo Building compiler plugin gcc_wrapper
+g++ -shared -fPIC -fvisibility=hidden -I"../../source" -o wrapper_plugin.so "wrapper_plugin.cpp"
+
+echo build_gcc.sh finished.
@@ -0,0 +1,145 @@
+// NOTE: Sample compiler plugin for Bricks.
+//       Builds executables with gcc like the core compiler, but runs every command through
+//       the wrapper set in the environment variable BRICKS_COMPILER_WRAPPER (e.g. distcc,
+//       icecc or a local sandbox script).
+//
+//       Build it with build_gcc.sh and use it in a blueprint:
+//           plugin: "samples/compiler_plugin/wrapper_plugin.so";
+//           compiler: "gcc_wrapper";
+
+#include "bricks_plugin.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+
+static void append(std::string *str, BricksString bs) {
+    str->append(bs.data, (size_t)bs.size);
+}
+
+static BricksString to_bricks_string(std::string const &str) {
+    BricksString result = {str.data(), (int64_t)str.size()};
+    return result;
+}
+
+static void generate_commands(BricksHost const *host, BricksEntity const *entity) {
+    if (entity->kind != BRICKS_ENTITY_EXECUTABLE) {
+        host->add_diagnostic(host->context, BRICKS_DIAG_ERROR, to_bricks_string("gcc_wrapper can only build executables."));
+        return;
+    }
+
+    std::string command;
+    append(&command, entity->tool_prefix);
+    command += "gcc";
+
+    for (int64_t i = 0; i < entity->options.size; i += 1) {
+        command += " ";
+        append(&command, entity->options.data[i]);
+    }
+
+    for (int64_t i = 0; i < entity->symbols.size; i += 1) {
+        command += " -D";
+        append(&command, entity->symbols.data[i]);
+    }
+
+    for (int64_t i = 0; i < entity->include_folders.size; i += 1) {
+        command += " -I";
+        append(&command, entity->include_folders.data[i]);
+    }
+
+    command += " -o";
+    append(&command, entity->file_path);
+
+    for (int64_t i = 0; i < entity->sources.size; i += 1) {
+        command += " \"";
+        append(&command, entity->sources.data[i]);
+        command += "\"";
+    }
+
+    for (int64_t i = 0; i < entity->libraries.size; i += 1) {
+        command += " \"";
+        append(&command, entity->libraries.data[i]);
+        command += "\"";
+    }
+
+    host->add_command(host->context, to_bricks_string(command));
+}
+
+static void process_diagnostics(BricksHost const *host, BricksEntity const *entity, BricksString output) {
+    std::string text(output.data, (size_t)output.size);
+
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+
+        int32_t kind = -1;
+        if      (line.find(": error:")   != std::string::npos) kind = BRICKS_DIAG_ERROR;
+        else if (line.find(": warning:") != std::string::npos) kind = BRICKS_DIAG_WARNING;
+        else if (line.find(": note:")    != std::string::npos) kind = BRICKS_DIAG_NOTE;
+
+        if (kind != -1) host->add_diagnostic(host->context, kind, to_bricks_string(line));
+    }
+}
+
+// NOTE: Make style dependency files as written by -MD.
+static void parse_depfile(BricksHost const *host, BricksEntity const *entity, BricksString content) {
+    std::string text(content.data, (size_t)content.size);
+
+    size_t colon = text.find(": ");
+    if (colon == std::string::npos) return;
+
+    std::string file;
+    for (size_t i = colon + 2; i <= text.size(); i += 1) {
+        char c = i < text.size() ? text[i] : ' ';
+
+        if (c == '\\' && i + 1 < text.size() && (text[i + 1] == '\n' || text[i + 1] == '\r')) {
+            continue;
+        }
+        if (c == '\\' && i + 1 < text.size() && text[i + 1] == ' ') {
+            file += ' ';
+            i += 1;
+            continue;
+        }
+
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            if (!file.empty()) host->add_dependency(host->context, to_bricks_string(file));
+            file.clear();
+        } else {
+            file += c;
+        }
+    }
+}
+
+static void generate_job_command(BricksHost const *host, BricksEntity const *entity, BricksString command) {
+    char const *wrapper = getenv("BRICKS_COMPILER_WRAPPER");
+    if (!wrapper || !wrapper[0]) return;
+
+    std::string wrapped = wrapper;
+    wrapped += " ";
+    append(&wrapped, command);
+
+    host->add_command(host->context, to_bricks_string(wrapped));
+}
+
+
+BRICKS_PLUGIN_EXPORT BricksCompilerPlugin const *bricks_compiler_plugin(uint32_t host_version) {
+    static BricksCompilerPlugin plugin = {};
+    if (host_version < BRICKS_PLUGIN_MIN_VERSION) return 0;
+
+    plugin.version = BRICKS_PLUGIN_VERSION;
+    plugin.size    = sizeof(BricksCompilerPlugin);
+    plugin.name    = "gcc_wrapper";
+
+    plugin.generate_commands    = generate_commands;
+    plugin.process_diagnostics  = process_diagnostics;
+    plugin.parse_depfile        = parse_depfile;
+    plugin.generate_job_command = generate_job_command;
+
+    return &plugin;
+}
+
@@ -3,13 +3,17 @@
 #include "blueprint.h"
 #include "platform.h"
 #include "string_builder.h"
+#include "glob.h"
 #include "io.h"
 
+#include <string.h>
+
 
 INTERNAL String BasicFile =
     "brick: debug {\n"
     "    options(@msvc): \"-Zi\";\n"
     "    options(@gcc ): \"-g\";\n"
+    "    options(@clang): \"-g\";\n"
     "}\n";
 
 
@@ -485,6 +489,7 @@ INTERNAL bool match(Parser *parser, TokenKind kind) {
 
 
 
+INTERNAL String combine_file_path(String folder, String sub_folder, String name);
 INTERNAL void parse_declaration(Parser *parser, Blueprint *blueprint) {
     if (!consume(parser, TOKEN_IDENTIFIER, "Missing field name.")) return;
     Token field = parser->previous_token;
@@ -500,6 +505,11 @@ INTERNAL void parse_declaration(Parser *parser, Blueprint *blueprint) {
     } else if (equal(field.content, "build_folder")) {
         if (!consume(parser, TOKEN_STRING, "Expected string in build_folder field.")) return;
         blueprint->build_folder = parser->previous_token.content;
+    } else if (equal(field.content, "plugin")) {
+        if (!consume(parser, TOKEN_STRING, "Expected shared library path in plugin field.")) return;
+
+        String file = combine_file_path(blueprint->path, "", parser->previous_token.content);
+        if (!load_compiler_plugin(file)) blueprint->status = BLUEPRINT_ERROR;
     } else {
         parse_error(parser, field.loc, "Unknown identifier.");
     }
@@ -541,7 +551,7 @@ INTERNAL String enum_string(EntityKind kind) {
     return EntityKindLookup[kind];
 }
 
-INTERNAL b32 parse_deps(Parser *parser, Entity *entity, b32 skip) {
+INTERNAL b32 parse_deps(Parser *parser, Field *field) {
     b32 result = true;
 
     do {
@@ -553,18 +563,15 @@ INTERNAL b32 parse_deps(Parser *parser, Entity *entity, b32 skip) {
                 dep.module = dep.entity;
                 dep.entity = parser->previous_token.content;
             }
-            if (skip) continue;
 
             if (dep.module != "") {
                 dep.module = allocate_string(dep.module, App.persistent_alloc);
             }
             dep.entity = allocate_string(dep.entity, App.persistent_alloc);
 
-            if (skip) continue;
-            append(&entity->dependencies, dep);
+            append(&field->dependencies, dep);
         } else if (match(parser, TOKEN_STRING)) {
-            if (skip) continue;
-            append(&entity->libraries, allocate_string(parser->previous_token.content, App.persistent_alloc));
+            append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
         } else {
             parse_error(parser, parser->current_token.loc, "Expected library string or entity identifier.");
         }
@@ -573,82 +580,188 @@ INTERNAL b32 parse_deps(Parser *parser, Entity *entity, b32 skip) {
     return result;
 }
 
-INTERNAL b32 parse_group(Parser *parser, Entity *entity, b32 skip) {
+INTERNAL b32 parse_group(Parser *parser, Field *field) {
     b32 result = true;
 
     do {
         if (!consume(parser, TOKEN_STRING, "Expected string as symbol.")) result = false;
 
-        if (skip) continue;
-        append(&entity->groups, allocate_string(parser->previous_token.content, App.persistent_alloc));
+        append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
     } while (match(parser, TOKEN_COMMA));
 
     return result;
 }
 
-INTERNAL b32 parse_symbols(Parser *parser, Entity *entity, b32 skip) {
+INTERNAL b32 parse_symbols(Parser *parser, Field *field) {
     b32 result = true;
 
     do {
         if (!consume(parser, TOKEN_STRING, "Expected string as symbol.")) result = false;
 
-        if (skip) continue;
-        append(&entity->symbols, allocate_string(parser->previous_token.content, App.persistent_alloc));
+        append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
     } while (match(parser, TOKEN_COMMA));
 
     return result;
 }
 
-INTERNAL b32 parse_options(Parser *parser, Entity *entity, b32 skip) {
+INTERNAL b32 parse_options(Parser *parser, Field *field) {
     b32 result = true;
 
     do {
         if (!consume(parser, TOKEN_STRING, "Expected string as option.")) result = false;
 
-        if (skip) continue;
-        append(&entity->options, allocate_string(parser->previous_token.content, App.persistent_alloc));
+        append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
     } while (match(parser, TOKEN_COMMA));
 
     return result;
 }
 
-INTERNAL b32 parse_includes(Parser *parser, Entity *entity, b32 skip) {
+INTERNAL b32 parse_includes(Parser *parser, Field *field) {
     b32 result = true;
 
     do {
         if (!consume(parser, TOKEN_STRING, "Expected string as include folder.")) result = false;
-        if (skip) continue;
 
         String file = combine_file_path(parser->bp->path, "", parser->previous_token.content);
-        append(&entity->include_folders, file);
+        append(&field->values, file);
     } while (match(parser, TOKEN_COMMA));
 
     return result;
 }
 
-INTERNAL b32 parse_build_folder(Parser *parser, Entity *entity, b32 skip) {
+INTERNAL b32 parse_build_folder(Parser *parser, Field *field) {
     b32 result = false;
 
     if (consume(parser, TOKEN_STRING, "Missing build folder.")) {
-        if (!skip) {
-            entity->build_folder = allocate_string(parser->previous_token.content, App.persistent_alloc);
+        append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
+        result = true;
+    }
+
+    return result;
+}
+
+INTERNAL b32 parse_linker(Parser *parser, Field *field) {
+    b32 result = false;
+
+    if (consume(parser, TOKEN_STRING, "Expected linker name.")) {
+        append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
+        result = true;
+    }
+
+    return result;
+}
+
+INTERNAL b32 parse_lto(Parser *parser, Field *field) {
+    if (!consume(parser, TOKEN_IDENTIFIER, "Expected thin, full or none as lto mode.")) return false;
+
+    String mode = parser->previous_token.content;
+    if (mode != "thin" && mode != "full" && mode != "none") {
+        parse_error(parser, parser->previous_token.loc, t_format("Unknown lto mode %S. Expected thin, full or none.", mode));
+        return false;
+    }
+
+    append(&field->values, mode);
+    return true;
+}
+
+// NOTE: debug_info: split; compressed; minimal; or split dwp; to package the split debug info.
+INTERNAL b32 parse_debug_info(Parser *parser, Field *field) {
+    if (!consume(parser, TOKEN_IDENTIFIER, "Expected split, compressed or minimal as debug info mode.")) return false;
+
+    String mode = parser->previous_token.content;
+    if (mode != "split" && mode != "compressed" && mode != "minimal") {
+        parse_error(parser, parser->previous_token.loc, t_format("Unknown debug info mode %S. Expected split, compressed or minimal.", mode));
+        return false;
+    }
+
+    append(&field->values, mode);
+
+    if (mode == "split" && match(parser, TOKEN_IDENTIFIER)) {
+        String package = parser->previous_token.content;
+        if (package != "dwp") {
+            parse_error(parser, parser->previous_token.loc, t_format("Unknown option %S for split debug info. Expected dwp.", package));
+            return false;
         }
+
+        append(&field->values, package);
+    }
+
+    return true;
+}
+
+// NOTE: pgo: generate; pgo: use; or pgo: use "folder"; where the profiles are read from.
+INTERNAL b32 parse_pgo(Parser *parser, Field *field) {
+    if (!consume(parser, TOKEN_IDENTIFIER, "Expected generate, use or none as pgo mode.")) return false;
+
+    String mode = parser->previous_token.content;
+    if (mode != "generate" && mode != "use" && mode != "none") {
+        parse_error(parser, parser->previous_token.loc, t_format("Unknown pgo mode %S. Expected generate, use or none.", mode));
+        return false;
+    }
+
+    append(&field->values, mode);
+
+    if (mode == "use" && match(parser, TOKEN_STRING)) {
+        String folder = combine_file_path(parser->bp->path, "", parser->previous_token.content);
+        append(&field->values, folder);
+    }
+
+    return true;
+}
+
+INTERNAL b32 parse_pgo_train(Parser *parser, Field *field) {
+    b32 result = false;
+
+    if (consume(parser, TOKEN_STRING, "Expected training command.")) {
+        append(&field->values, allocate_string(parser->previous_token.content, App.persistent_alloc));
         result = true;
     }
 
     return result;
 }
 
-INTERNAL b32 parse_sources(Parser *parser, Entity *entity, b32 skip) {
+// NOTE: glob "gen/**/*.cpp" - "gen/**/*_test.cpp" adds all matching files but the excluded ones.
+//       Globs are expanded right away, relative to the blueprint and the sub folder like files.
+INTERNAL b32 parse_glob(Parser *parser, Field *field, String sub_folder) {
+    if (!consume(parser, TOKEN_STRING, "Expected pattern string after glob.")) return false;
+    String pattern = combine_file_path(parser->bp->path, sub_folder, parser->previous_token.content);
+
+    List<String> excludes = {};
+    DEFER(destroy(&excludes));
+
+    while (match(parser, TOKEN_MINUS)) {
+        if (!consume(parser, TOKEN_STRING, "Expected pattern string to exclude after -.")) return false;
+        append(&excludes, combine_file_path(parser->bp->path, sub_folder, parser->previous_token.content));
+    }
+
+    BlueprintGlob glob = {};
+    glob.pattern = pattern;
+    FOR (excludes, exclude) append(&glob.excludes, *exclude);
+
+    s64 count = field->values.size;
+    expand_glob(&App.file_cache, pattern, excludes, &field->values, App.persistent_alloc, &glob.folders);
+
+    glob.files_hash = hash_glob_files({field->values.data + count, field->values.size - count});
+    append(&parser->bp->globs, glob);
+
+    if (field->values.size == count) {
+        add_diagnostic(DIAG_WARNING, t_format("No source files match %S in blueprint file %S.", pattern, parser->current_file));
+    }
+
+    return true;
+}
+
+INTERNAL b32 parse_sources(Parser *parser, Field *field) {
     b32 result = false;
 
     String sub_folder = "";
     do {
         if (match(parser, TOKEN_STRING)) {
-            if (skip) continue;
-
             String file = combine_file_path(parser->bp->path, sub_folder, parser->previous_token.content);
-            append(&entity->sources, file);
+            append(&field->values, file);
+        } else if (current_token_is(parser, TOKEN_IDENTIFIER) && parser->current_token.content == "glob") {
+            advance_token(parser);
+            if (!parse_glob(parser, field, sub_folder)) return result;
         } else if (match(parser, TOKEN_SLASH)) {
             if (!consume(parser, TOKEN_STRING, "Expected sub folder string.")) return result;
             sub_folder = parser->previous_token.content;
@@ -661,41 +774,45 @@ INTERNAL b32 parse_sources(Parser *parser, Entity *entity, b32 skip) {
     return result;
 }
 
-INTERNAL b32 parse_field_spec(Parser *parser, Blueprint *bp, Entity *entity) {
-    b32 skip_field = true;
-
+INTERNAL b32 parse_field_spec(Parser *parser, Field *field) {
     if (match(parser, TOKEN_LEFT_PARENTHESIS)) {
         if (match(parser, TOKEN_RIGHT_PARENTHESIS)) {
-            return false;
+            return true;
         }
 
         do {
+            FieldSpec spec = {};
+
             if (match(parser, TOKEN_RIGHT_PARENTHESIS)) {
                 break;
             } else if (match(parser, TOKEN_IDENTIFIER)) {
-                if (parser->previous_token.content == bp->build_type) skip_field = false;
+                spec.kind = FIELD_SPEC_BUILD_TYPE;
+                spec.name = parser->previous_token.content;
             } else if (match(parser, TOKEN_HASHTAG)) {
                 // TODO: Also allow strings?
-                if (!consume(parser, TOKEN_IDENTIFIER, "Expected platform specifier.")) return true;
-                if (parser->previous_token.content == App.target_platform) skip_field = false;
+                if (!consume(parser, TOKEN_IDENTIFIER, "Expected platform specifier.")) return false;
+                spec.kind = FIELD_SPEC_PLATFORM;
+                spec.name = parser->previous_token.content;
             } else if (match(parser, TOKEN_AT)) {
                 // TODO: Also allow strings?
-                if (!consume(parser, TOKEN_IDENTIFIER, "Expected compiler specifier.")) return true;
-                if (parser->previous_token.content == entity->compiler) skip_field = false;
+                if (!consume(parser, TOKEN_IDENTIFIER, "Expected compiler specifier.")) return false;
+                spec.kind = FIELD_SPEC_COMPILER;
+                spec.name = parser->previous_token.content;
             } else {
                 parse_error(parser, parser->current_token.loc, "Expected build type or platform specifier as field argument.");
+                return false;
             }
+
+            append(&field->specs, spec);
         } while (match(parser, TOKEN_COMMA));
 
         match(parser, TOKEN_RIGHT_PARENTHESIS);
-    } else {
-        skip_field = false;
     }
 
-    return skip_field;
+    return true;
 }
 
-INTERNAL b32 parse_field(Parser *parser, Entity *entity, Blueprint *bp) {
+INTERNAL b32 parse_field(Parser *parser, Entity *entity) {
     b32 result = false;
     if (!consume(parser, TOKEN_IDENTIFIER, t_format("Unkown field %S.", parser->current_token.content))) {
         return result;
@@ -704,25 +821,47 @@ INTERNAL b32 parse_field(Parser *parser, Entity *entity, Blueprint *bp) {
     Token  name_token = parser->previous_token;
     String name = name_token.content;
 
-    // TODO: Maybe this should be in the parse functions?
-    b32 skip_field = parse_field_spec(parser, bp, entity);
+    Field field = {};
+    if (!parse_field_spec(parser, &field)) return result;
 
     if (!consume(parser, TOKEN_COLON, "Missing : in field.")) return result;
 
     if        (name == "sources") {
-        result = parse_sources(parser, entity, skip_field);
+        field.kind = FIELD_SOURCES;
+        result = parse_sources(parser, &field);
     } else if (name == "folder") {
-        result = parse_build_folder(parser, entity, skip_field);
+        field.kind = FIELD_FOLDER;
+        result = parse_build_folder(parser, &field);
     } else if (name == "include") {
-        result = parse_includes(parser, entity, skip_field);
+        field.kind = FIELD_INCLUDE;
+        result = parse_includes(parser, &field);
     } else if (name == "symbols") {
-        result = parse_symbols(parser, entity, skip_field);
+        field.kind = FIELD_SYMBOLS;
+        result = parse_symbols(parser, &field);
     } else if (name == "options") {
-        result = parse_options(parser, entity, skip_field);
+        field.kind = FIELD_OPTIONS;
+        result = parse_options(parser, &field);
     } else if (name == "dependencies") {
-        result = parse_deps(parser, entity, skip_field);
+        field.kind = FIELD_DEPENDENCIES;
+        result = parse_deps(parser, &field);
     } else if (name == "group") {
-        result = parse_group(parser, entity, skip_field);
+        field.kind = FIELD_GROUP;
+        result = parse_group(parser, &field);
+    } else if (name == "linker") {
+        field.kind = FIELD_LINKER;
+        result = parse_linker(parser, &field);
+    } else if (name == "lto") {
+        field.kind = FIELD_LTO;
+        result = parse_lto(parser, &field);
+    } else if (name == "debug_info") {
+        field.kind = FIELD_DEBUG_INFO;
+        result = parse_debug_info(parser, &field);
+    } else if (name == "pgo") {
+        field.kind = FIELD_PGO;
+        result = parse_pgo(parser, &field);
+    } else if (name == "pgo_train") {
+        field.kind = FIELD_PGO_TRAIN;
+        result = parse_pgo_train(parser, &field);
     } else {
         parse_error(parser, name_token.loc, t_format("Unkown field %S.", name));
     }
@@ -735,6 +874,8 @@ INTERNAL b32 parse_field(Parser *parser, Entity *entity, Blueprint *bp) {
         return false;
     }
 
+    append(&entity->fields, field);
+
     return result;
 }
 
@@ -779,7 +920,7 @@ INTERNAL void parse_entity_declaration(Parser *parser, Blueprint *blueprint) {
     do {
         if (match(parser, TOKEN_RIGHT_BRACE)) break;
 
-        if (!parse_field(parser, entity, blueprint)) {
+        if (!parse_field(parser, entity)) {
             return;
         }
     } while (parser->previous_token.kind == TOKEN_SEMICOLON || match(parser, TOKEN_RIGHT_BRACE));
@@ -914,6 +1055,21 @@ void parse_blueprint(Blueprint *bp, String code) {
     bp->status = BLUEPRINT_READY;
 }
 
+s64 count_tokens(String code) {
+    if (code.size == 0) return 0;
+
+    Blueprint blueprint = {};
+    Parser parser = init_parser(code, &blueprint);
+
+    s64 count = 0;
+    while (!current_token_is(&parser, TOKEN_END_OF_INPUT) && !current_token_is(&parser, TOKEN_UNKNOWN)) {
+        advance_token(&parser);
+        count += 1;
+    }
+
+    return count;
+}
+
 void parse_blueprint_file(Blueprint *bp, String file) {
     auto read_result = platform_read_entire_file(file);
     if (read_result.error) {
@@ -948,18 +1104,140 @@ Entity *create_entity() {
     return ALLOC(App.persistent_alloc, Entity, 1);
 }
 
+INTERNAL b32 field_matches(Field *field, BuildConfiguration *config, String compiler) {
+    if (field->specs.size == 0) return true;
+
+    // NOTE: A field is included if any of the specifiers matches.
+    FOR (field->specs, spec) {
+        switch (spec->kind) {
+        case FIELD_SPEC_BUILD_TYPE: {
+            if (spec->name == config->build_type) return true;
+        } break;
+
+        case FIELD_SPEC_PLATFORM: {
+            if (spec->name == config->target_platform) return true;
+            if (spec->name == config->target_info.name) return true;
+        } break;
+
+        case FIELD_SPEC_COMPILER: {
+            if (spec->name == compiler) return true;
+        } break;
+        }
+    }
+
+    return false;
+}
+
+Entity *instantiate(Entity *prototype, BuildConfiguration *config) {
+    assert(prototype->prototype == 0);
+
+    while (prototype->instances.size <= config->index) {
+        append(&prototype->instances, (Entity*)0);
+    }
+
+    Entity *entity = prototype->instances[config->index];
+    if (entity) return entity;
+
+    entity = create_entity();
+    entity->kind      = prototype->kind;
+    entity->status    = prototype->status;
+    entity->lib_kind  = prototype->lib_kind;
+    entity->prototype = prototype;
+    entity->config    = config;
+    entity->compiler  = prototype->compiler;
+    entity->linker    = prototype->linker;
+    entity->name      = prototype->name;
+    entity->build_folder = prototype->build_folder;
+
+    // NOTE: Without an explicit compiler in the blueprint the target decides.
+    if (entity->compiler == "") entity->compiler = config->target_info.compiler;
+    if (entity->linker   == "") entity->linker   = config->target_info.linker;
+
+    FOR (prototype->fields, field) {
+        if (!field_matches(field, config, entity->compiler)) continue;
+
+        switch (field->kind) {
+        case FIELD_SOURCES: {
+            FOR (field->values, value) append(&entity->sources, *value);
+        } break;
+
+        case FIELD_FOLDER: {
+            FOR (field->values, value) entity->build_folder = *value;
+        } break;
+
+        case FIELD_INCLUDE: {
+            FOR (field->values, value) append(&entity->include_folders, *value);
+        } break;
+
+        case FIELD_SYMBOLS: {
+            FOR (field->values, value) append(&entity->symbols, *value);
+        } break;
+
+        case FIELD_OPTIONS: {
+            FOR (field->values, value) append(&entity->options, *value);
+        } break;
+
+        case FIELD_DEPENDENCIES: {
+            FOR (field->dependencies, dep) append(&entity->dependencies, *dep);
+            FOR (field->values, value) append(&entity->libraries, *value);
+        } break;
+
+        case FIELD_GROUP: {
+            FOR (field->values, value) append(&entity->groups, *value);
+        } break;
+
+        case FIELD_LINKER: {
+            FOR (field->values, value) entity->linker = *value;
+        } break;
+
+        case FIELD_LTO: {
+            String mode = field->values[0];
+
+            if      (mode == "thin") entity->lto = LTO_THIN;
+            else if (mode == "full") entity->lto = LTO_FULL;
+            else                     entity->lto = LTO_NONE;
+        } break;
+
+        case FIELD_DEBUG_INFO: {
+            String mode = field->values[0];
+
+            if      (mode == "split")      entity->debug_info = DEBUG_INFO_SPLIT;
+            else if (mode == "compressed") entity->debug_info = DEBUG_INFO_COMPRESSED;
+            else                           entity->debug_info = DEBUG_INFO_MINIMAL;
+
+            entity->debug_package = field->values.size > 1;
+        } break;
+
+        case FIELD_PGO: {
+            String mode = field->values[0];
+
+            if      (mode == "generate") entity->pgo = PGO_GENERATE;
+            else if (mode == "use")      entity->pgo = PGO_USE;
+            else                         entity->pgo = PGO_NONE;
+
+            entity->pgo_folder = field->values.size > 1 ? field->values[1] : String();
+        } break;
+
+        case FIELD_PGO_TRAIN: {
+            FOR (field->values, value) entity->pgo_train = *value;
+        } break;
+        }
+    }
+
+    // NOTE: bricks pgo builds every Entity with a pgo field twice, first instrumented and then
+    //       with the profiles of the training runs.
+    if (config->pgo != PGO_NONE && entity->pgo != PGO_NONE) entity->pgo = config->pgo;
+
+    prototype->instances[config->index] = entity;
+
+    return entity;
+}
+
 Blueprint *create_blueprint() {
     Blueprint *blueprint = ALLOC(App.persistent_alloc, Blueprint, 1);
 
-#if defined(OS_WINDOWS)
-    blueprint->compiler = "msvc";
-    blueprint->linker   = "msvc";
-#elif defined(OS_LINUX)
-    blueprint->compiler = "gcc";
-    blueprint->linker   = "gcc";
-#endif
-
-    blueprint->build_type = App.build_type;
+    // NOTE: compiler and linker stay empty unless the blueprint sets them.
+    //       The target of the configuration then picks them on instantiation.
 
     return blueprint;
 }
@@ -968,10 +1246,26 @@ void destroy(Blueprint *blueprint) {
     destroy(&blueprint->entities);
     destroy(&blueprint->local_imports);
     destroy(&blueprint->named_imports);
+    destroy_globs(blueprint);
 
     INIT_STRUCT(blueprint);
 }
 
+void destroy_globs(Blueprint *blueprint) {
+    FOR (blueprint->globs, glob) {
+        destroy(&glob->excludes);
+        destroy(&glob->folders);
+    }
+    destroy(&blueprint->globs);
+}
+
+u64 hash_glob_files(Array<String> files) {
+    u64 hash = HASH_SEED;
+    FOR (files, file) hash = hash_content(hash, *file);
+
+    return hash;
+}
+
 
 Blueprint *find_submodule(Blueprint *bp, String name) {
     if (name != "") {
@@ -997,12 +1291,183 @@ Entity *find_dependency(Blueprint *bp, String name) {
     return 0;
 }
 
-void add_build_command(Entity *entity, StringBuilder *builder) {
-    if (entity->build_command_count < ENTITY_COMMAND_COUNT) {
-        entity->build_commands[entity->build_command_count] = to_allocated_string(builder, App.persistent_alloc);
-        entity->build_command_count += 1;
+// NOTE: sh -c gets the command as one argument, which linux limits to 128 KB.
+//       cmd only takes 8 KB.
+#if defined(OS_WINDOWS)
+INTERNAL s64 const RESPONSE_FILE_THRESHOLD = 8000;
+#else
+INTERNAL s64 const RESPONSE_FILE_THRESHOLD = 120000;
+#endif
+
+INTERNAL String concat(Array<String> parts, Allocator alloc) {
+    s64 size = 0;
+    FOR (parts, part) size += part->size;
+
+    String result = {};
+    result.data = ALLOC(alloc, u8, size);
+
+    FOR (parts, part) {
+        memcpy(result.data + result.size, part->data, part->size);
+        result.size += part->size;
+    }
+
+    return result;
+}
+
+INTERNAL b32 write_response_file(String file, Array<String> arguments) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    FOR (arguments, argument) append(&builder, *argument);
+
+    PlatformFile rsp = platform_file_open(file, PlatformFileOverride);
+    if (!rsp.open) return false;
+
+    b32 result = write_builder_to_file(&builder, &rsp);
+    platform_file_close(&rsp);
+
+    return result;
+}
+
+s32 add_build_command(Entity *entity, CommandKind kind, String program, Array<String> arguments, String response_file) {
+    BuildCommand command = {};
+    command.kind = kind;
+    command.hash = hash_content(program);
+
+    s64 size = program.size;
+    FOR (arguments, argument) {
+        size += argument->size;
+        command.hash = hash_content(command.hash, *argument);
+    }
+
+    if (size > RESPONSE_FILE_THRESHOLD && response_file != "" && write_response_file(response_file, arguments)) {
+        String parts[] = {program, " @\"", response_file, "\""};
+
+        command.command       = concat({parts, 4}, App.persistent_alloc);
+        command.response_file = allocate_string(response_file, App.persistent_alloc);
     } else {
-        add_diagnostic(entity, DIAG_ERROR, "Too many build commands generated.");
+        String *parts = ALLOC(DefaultAllocator, String, arguments.size + 1);
+        DEFER(deallocate(DefaultAllocator, parts, sizeof(String) * (arguments.size + 1)));
+
+        parts[0] = program;
+        for (s64 i = 0; i < arguments.size; i += 1) parts[i + 1] = arguments[i];
+
+        command.command = concat({parts, arguments.size + 1}, App.persistent_alloc);
+    }
+
+    append(&entity->build_commands, command);
+
+    return (s32)entity->build_commands.size - 1;
+}
+
+void append_arguments(StringBuilder *builder, Array<String> values, String flag, b32 quote) {
+    FOR (values, value) {
+        append(builder, ' ');
+        append(builder, flag);
+
+        if (quote) append(builder, '"');
+        append(builder, *value);
+        if (quote) append(builder, '"');
+    }
+}
+
+String quoted_files(Array<String> files, Allocator alloc) {
+    s64 size = 0;
+    FOR (files, file) size += file->size + 3;
+
+    String result = {};
+    result.data = ALLOC(alloc, u8, size);
+
+    FOR (files, file) {
+        result.data[result.size + 0] = ' ';
+        result.data[result.size + 1] = '"';
+        memcpy(result.data + result.size + 2, file->data, file->size);
+        result.data[result.size + file->size + 2] = '"';
+
+        result.size += file->size + 3;
+    }
+
+    return result;
+}
+
+void add_command_input(Entity *entity, s32 command, String file) {
+    append(&entity->build_commands[command].inputs, file);
+}
+
+void add_command_output(Entity *entity, s32 command, String file) {
+    append(&entity->build_commands[command].outputs, file);
+}
+
+void add_command_dependency(Entity *entity, s32 command, s32 dependency) {
+    assert(dependency < command);
+
+    append(&entity->build_commands[command].dependencies, dependency);
+}
+
+void set_command_depfile(Entity *entity, s32 command, String file) {
+    entity->build_commands[command].depfile = file;
+    add_command_output(entity, command, file);
+}
+
+void depend_on_previous_commands(Entity *entity, s32 command) {
+    for (s32 i = 0; i < command; i += 1) {
+        add_command_dependency(entity, command, i);
+    }
+}
+
+b32 is_build_output(String file) {
+    return find(&App.output_files, file) != 0;
+}
+
+void add_link_command_files(Entity *entity, s32 command, Array<String> object_files) {
+    depend_on_previous_commands(entity, command);
+
+    FOR (object_files, file) {
+        add_command_input(entity, command, *file);
+    }
+
+    if (entity->build_commands[command].kind == COMMAND_LINK) {
+        FOR (entity->libraries, lib) {
+            if (is_build_output(*lib)) add_command_input(entity, command, *lib);
+        }
+    }
+
+    add_command_output(entity, command, entity->file_path);
+}
+
+INTERNAL String source_name(String source) {
+    s64 start = 0;
+    s64 end   = source.size;
+
+    for (s64 i = source.size; i > 0; i -= 1) {
+        u8 c = source[i - 1];
+        if (c == '/' || c == '\\') {
+            start = i;
+            break;
+        }
+        if (c == '.' && end == source.size) end = i - 1;
+    }
+
+    return String(source.data + start, end - start);
+}
+
+void get_object_files(Entity *entity, String extension, List<String> *object_files) {
+    for (s64 i = 0; i < entity->sources.size; i += 1) {
+        String name = source_name(entity->sources[i]);
+
+        b32 is_unique = true;
+        for (s64 j = 0; j < i; j += 1) {
+            if (source_name(entity->sources[j]) == name) is_unique = false;
+        }
+
+        String file = {};
+        if (is_unique) {
+            file = format(App.persistent_alloc, "%S%S.%S", entity->intermediate_folder, name, extension);
+        } else {
+            file = format(App.persistent_alloc, "%S%S_%d.%S", entity->intermediate_folder, name, (s32)i, extension);
+        }
+
+        append(object_files, file);
     }
 }
 
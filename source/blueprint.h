@@ -6,6 +6,8 @@
 
 struct Import;
 struct StringBuilder;
+struct BuildConfiguration;
+struct BuildJob;
 
 struct Dependency {
     String module;
@@ -18,7 +20,48 @@ enum LibraryKind {
     SHARED_LIBRARY,
 };
 
-const s32 ENTITY_COMMAND_COUNT = 4;
+enum LtoMode {
+    LTO_NONE,
+    LTO_THIN,
+    LTO_FULL,
+};
+
+// NOTE: Most of a debug link is spent copying DWARF from the objects into the output.
+enum DebugInfoMode {
+    DEBUG_INFO_DEFAULT,    // NOTE: Whatever the options say, e.g. -g from basic.debug.
+    DEBUG_INFO_SPLIT,      // NOTE: In a .dwo file next to every object, the linker doesn't touch it.
+    DEBUG_INFO_COMPRESSED,
+    DEBUG_INFO_MINIMAL,    // NOTE: Line tables only, enough for stack traces.
+};
+
+enum CommandKind {
+    COMMAND_COMPILE,
+    COMMAND_ARCHIVE,
+    COMMAND_LINK,
+    COMMAND_CUSTOM,
+
+    COMMAND_KIND_COUNT,
+};
+// NOTE: The commands of an Entity form a small graph. A command starts once the commands it
+//       depends on are done and is skipped if all outputs are newer than its inputs.
+//       Commands without outputs always run.
+struct BuildCommand {
+    CommandKind kind;
+    String command;
+
+    // NOTE: Of the whole command line, including the arguments in the response file.
+    u64 hash;
+    String response_file;
+
+    List<String> inputs;
+    List<String> outputs;
+
+    // NOTE: Optional. Written by the command and read with Compiler::parse_depfile,
+    //       lists inputs that are only known after compiling, e.g. headers.
+    String depfile;
+
+    List<s32> dependencies; // NOTE: Indices into Entity::build_commands.
+};
 
 enum EntityKind {
     ENTITY_NONE,
@@ -28,6 +71,41 @@ enum EntityKind {
 
     ENTITY_COUNT,
 };
+enum FieldKind {
+    FIELD_SOURCES,
+    FIELD_FOLDER,
+    FIELD_INCLUDE,
+    FIELD_SYMBOLS,
+    FIELD_OPTIONS,
+    FIELD_DEPENDENCIES,
+    FIELD_GROUP,
+    FIELD_LINKER,
+    FIELD_LTO,
+    FIELD_DEBUG_INFO,
+    FIELD_PGO,
+    FIELD_PGO_TRAIN,
+};
+enum FieldSpecKind {
+    FIELD_SPEC_BUILD_TYPE,
+    FIELD_SPEC_PLATFORM,
+    FIELD_SPEC_COMPILER,
+};
+struct FieldSpec {
+    FieldSpecKind kind;
+    String name;
+};
+// NOTE: Fields are stored unevaluated while parsing. The specifiers in parenthesis
+//       are only checked when the Entity gets instantiated for a BuildConfiguration,
+//       so a blueprint is parsed once no matter how many configurations are built.
+struct Field {
+    FieldKind kind;
+
+    List<FieldSpec> specs;
+
+    List<String>     values;
+    List<Dependency> dependencies;
+};
+
 enum EntityStatus {
     ENTITY_STATUS_UNBUILD,
     ENTITY_STATUS_READY,
@@ -37,6 +115,15 @@ struct Entity {
     EntityKind kind;
     EntityStatus status;
 
+    // NOTE: Entities in a Blueprint are prototypes. They only carry the parsed fields.
+    //       The ones that are actually build are instances for one configuration.
+    Entity *prototype;
+    BuildConfiguration *config;
+
+    List<Field>   fields;
+    List<Entity*> instances;
+    BuildJob *job;
+
     LibraryKind lib_kind;
 
     String file_path;
@@ -45,6 +132,17 @@ struct Entity {
     String compiler;
     String linker;
 
+    LtoMode lto;
+
+    // NOTE: debug_info: split dwp; packs the .dwo files into <file>.dwp after the link.
+    DebugInfoMode debug_info;
+    b32 debug_package;
+
+    // NOTE: Profiles of training runs are written to and read from pgo_folder.
+    PgoMode pgo;
+    String  pgo_folder;
+    String  pgo_train; // NOTE: Command bricks pgo runs to train the instrumented build.
+
     String name;
     String build_folder;
 
@@ -58,10 +156,8 @@ struct Entity {
     List<Dependency> dependencies;
     
     // NOTE: Needed to write out the commands into a shell script.
-    //       Multiple commands needed for libs as e.g. msvc can't link libs in one go
-    //       and needs seperate object files to be linked.
-    String build_commands[ENTITY_COMMAND_COUNT];
-    s32 build_command_count;
+    //       E.g. one compile command per source file and a link command depending on them.
+    List<BuildCommand> build_commands;
 
     List<Diagnostic> diagnostics;
 };
@@ -73,6 +169,16 @@ enum BlueprintStatus {
     BLUEPRINT_BUILDING,
     BLUEPRINT_ERROR,
 };
+// NOTE: A glob in sources, kept for bricks --watch. The folders it listed are watched, when one
+//       of them changes the glob is expanded again and compared, see globs_changed.
+struct BlueprintGlob {
+    String pattern;
+    List<String> excludes;
+
+    List<String> folders;
+    u64 files_hash; // NOTE: Of the files it matched, see hash_glob_files.
+};
+
 struct Blueprint {
     BlueprintStatus status;
     String name;
@@ -84,25 +190,62 @@ struct Blueprint {
     String linker;
 
     String build_folder;
-    String build_type;
 
     HashTable<String, Entity*>    entities;
     HashTable<String, Blueprint*> local_imports;
     HashTable<String, Blueprint*> named_imports;
+
+    List<BlueprintGlob> globs;
 };
 
 void parse_blueprint(Blueprint *bp, String code);
+
+// NOTE: Only runs the lexer and returns the number of tokens, for bench/bench_micro.cpp.
+s64 count_tokens(String code);
 void parse_blueprint_file(Blueprint *bp, String file);
 
 Entity *create_entity();
+Entity *instantiate(Entity *prototype, BuildConfiguration *config);
 
 Blueprint *create_blueprint();
 void destroy(Blueprint *bp);
 
+// NOTE: The strings are in App.persistent_alloc like the rest of the blueprint.
+void destroy_globs(Blueprint *bp);
+
+u64 hash_glob_files(Array<String> files);
+
 Blueprint *find_submodule (Blueprint *bp, String name);
 Entity    *find_dependency(Blueprint *bp, String name);
 
-void add_build_command(Entity *entity, StringBuilder *builder);
+// NOTE: Arguments start with a space and are copied behind the program with a single allocation.
+//       Longer commands than the shell accepts get their arguments written to the response file
+//       and passed with @file instead. Returns the index of the command for the functions below.
+s32  add_build_command(Entity *entity, CommandKind kind, String program, Array<String> arguments, String response_file);
+void add_command_input (Entity *entity, s32 command, String file);
+void add_command_output(Entity *entity, s32 command, String file);
+void add_command_dependency(Entity *entity, s32 command, s32 dependency);
+void set_command_depfile(Entity *entity, s32 command, String file);
+
+// NOTE: Makes the command wait for every command added before it, e.g. a link for all compiles.
+void depend_on_previous_commands(Entity *entity, s32 command);
+
+// NOTE: " flag\"value\"" for every value, for the parts all commands of an Entity share.
+void append_arguments(StringBuilder *builder, Array<String> values, String flag, b32 quote);
+
+// NOTE: " \"file\"" for every file in one allocation.
+String quoted_files(Array<String> files, Allocator alloc);
+
+// NOTE: For the link or archive command that writes the file of the Entity from the object
+//       files of the commands before it. Links also read the libraries built by dependencies.
+void add_link_command_files(Entity *entity, s32 command, Array<String> object_files);
+
+// NOTE: True for files written by an Entity of this build, e.g. libraries an executable links.
+b32 is_build_output(String file);
+
+// NOTE: One object file per source in the intermediate folder. Sources with the same
+//       name in different folders get numbered object files.
+void get_object_files(Entity *entity, String extension, List<String> *object_files);
 
 void print_diagnostics(Entity *entity);
 void add_diagnostic(Entity *entity, DiagnosticKind kind, String msg);
@@ -5,9 +5,20 @@
 #include "io.h"
 #include "string_builder.h"
 #include "blueprint.h"
+#include "jobs.h"
+#include "process.h"
+#include "file_system.h"
+#include "file_watcher.h"
+#include "glob.h"
+#include "remote.h"
+#include "remote_cache.h"
+#include "local_cache.h"
+#include "http.h"
 
 #include "core_compilers.h"
 
+#include <string.h>
+
 
 ApplicationState App;
 
@@ -20,22 +31,90 @@ b32 create_trace() {
     return App.trace_file_name != "";
 }
 
-void load_core_compilers() {
-    append(&App.compilers, load_msvc());
-    append(&App.compilers, load_gcc());
+b32 create_profile() {
+    return App.profile;
 }
 
+s32 link_thread_count() {
+    return App.link_threads;
+}
+
+String workspace_folder() {
+    return App.starting_folder;
+}
 
-INTERNAL String enum_string(EntityKind kind) {
-    String const lookup[ENTITY_COUNT] = {
-        "None",
-        "Brick",
-        "Executable",
-        "Library",
-    };
+// NOTE: Only whole folder names match, /home/a/repo doesn't change /home/a/repo2.
+String map_workspace_paths(String text, String workspace, Allocator alloc) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    if (workspace.size == 0) return allocate_string(text, alloc);
+
+    s64 copied = 0;
+    for (s64 i = 0; i + workspace.size <= text.size; i += 1) {
+        if (text[i] != workspace[0] || memcmp(text.data + i, workspace.data, workspace.size) != 0) continue;
+
+        s64 end = i + workspace.size;
+        if (end < text.size && text[end] != '/' && text[end] != '\\' && text[end] != '"') continue;
+
+        append(&builder, String(text.data + copied, i - copied));
+        append(&builder, '.');
+
+        copied = end;
+        i = end - 1;
+    }
 
-    assert(kind < ENTITY_COUNT);
-    return lookup[kind];
+    append(&builder, String(text.data + copied, text.size - copied));
+
+    return to_allocated_string(&builder, alloc);
+}
+
+INTERNAL u64 rotate_left(u64 value, s32 bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// NOTE: One lane of xxHash64. Every bit of a word reaches every bit of the result, a plain FNV over
+//       words only moves the top bits of a word into the top bits of the hash.
+u64 hash_content(u64 hash, String content) {
+    u64 const PRIME_1 = 11400714785074694791ull;
+    u64 const PRIME_2 = 14029467366897019727ull;
+    u64 const PRIME_3 = 1609587929392839161ull;
+    u64 const PRIME_4 = 9650029242287828579ull;
+    u64 const PRIME_5 = 2870177450012600261ull;
+
+    hash += PRIME_5 + (u64)content.size;
+
+    s64 i = 0;
+    for (; i + 8 <= content.size; i += 8) {
+        u64 word = 0;
+        memcpy(&word, content.data + i, 8);
+
+        hash ^= rotate_left(word * PRIME_2, 31) * PRIME_1;
+        hash  = rotate_left(hash, 27) * PRIME_1 + PRIME_4;
+    }
+
+    for (; i < content.size; i += 1) {
+        hash ^= content.data[i] * PRIME_5;
+        hash  = rotate_left(hash, 11) * PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+u64 hash_content(String content) {
+    return hash_content(HASH_SEED, content);
+}
+
+void load_core_compilers() {
+    append(&App.compilers, load_msvc());
+    append(&App.compilers, load_gcc());
+    append(&App.compilers, load_clang());
 }
 
 
@@ -75,7 +154,7 @@ INTERNAL String combine_entity_path(String bp_folder, String build_folder, Strin
     return to_allocated_string(&builder, App.persistent_alloc);
 }
 
-INTERNAL String combine_intermediate_path(String bp_folder, String name, String extension) {
+INTERNAL String combine_intermediate_path(String bp_folder, String name, String extension, BuildConfiguration *config) {
     StringBuilder builder = {};
     if (bp_folder != "") {
         bp_folder = remove_trailing_slashes(bp_folder);
@@ -95,14 +174,21 @@ INTERNAL String combine_intermediate_path(String bp_folder, String name, String
     }
 
     append(&builder, '/');
-    if (App.build_type != "") {
-        format(&builder, "%S/", App.build_type);
+
+    // NOTE: Only other targets than the host get their own folder, so the layout
+    //       stays the same for normal builds.
+    if (config->target_info.name != App.target_platform) {
+        format(&builder, "%S/", config->target_info.name);
+    }
+
+    if (config->build_type != "") {
+        format(&builder, "%S/", config->build_type);
     }
     
     return to_allocated_string(&builder, App.persistent_alloc);
 }
 
-INTERNAL void append_unique(List<String> *list, String str) {
+void append_unique(List<String> *list, String str) {
     FOR (*list, elem) {
         if (*elem == str) return;
     }
@@ -112,7 +198,7 @@ INTERNAL void append_unique(List<String> *list, String str) {
 
 // TODO: This is very slow and bad.
 //       Alternatively the array could be sorted and then binary searched.
-INTERNAL void merge_arrays(List<String> *dest, Array<String> src) {
+void merge_arrays(List<String> *dest, Array<String> src) {
     FOR (src, string) {
         append_unique(dest, *string);
     }
@@ -126,43 +212,73 @@ INTERNAL void add_brick_to_entity(Entity *entity, Entity *brick) {
     merge_arrays(&entity->options,      brick->options);
     merge_arrays(&entity->libraries,    brick->libraries);
     merge_arrays(&entity->symbols,      brick->symbols);
+
+    // NOTE: A Brick that turns debug info on can pick its mode as well.
+    if (entity->debug_info == DEBUG_INFO_DEFAULT) {
+        entity->debug_info    = brick->debug_info;
+        entity->debug_package = brick->debug_package;
+    }
+}
+
+INTERNAL b32 is_profile_file(String name) {
+    String extensions[] = {".gcda", ".profraw", ".profdata", ".pgc"};
+
+    for (s32 i = 0; i < 4; i += 1) {
+        String ext = extensions[i];
+        if (name.size > ext.size && String(name.data + name.size - ext.size, ext.size) == ext) return true;
+    }
+
+    return false;
+}
+
+INTERNAL void clear_profiles(String folder) {
+    List<FolderEntry> entries = {};
+    DEFER(destroy(&entries));
+
+    if (!platform_list_folder(folder, &entries, DefaultAllocator)) return;
+
+    FOR (entries, entry) {
+        if (!entry->is_folder && is_profile_file(entry->name)) {
+            platform_delete_file(t_format("%S/%S", folder, entry->name));
+        }
+
+        destroy(entry);
+    }
 }
 
-INTERNAL void build(Blueprint *blueprint, Entity *entity) {
+// NOTE: Resolves the dependencies of an Entity instance and generates its build commands.
+//       Nothing is run here, the returned job is executed later by run_jobs.
+INTERNAL BuildJob *prepare_build(JobPool *pool, Blueprint *blueprint, Entity *entity) {
+    if (entity->job) return entity->job;
+
+    BuildConfiguration *config = entity->config;
+
     Compiler *compiler = find_compiler(entity->compiler);
     if (compiler == 0) {
         String msg = t_format("Unknown compiler %S specified for Entity %S.\n", entity->compiler, entity->name);
         add_diagnostic(DIAG_ERROR, msg);
-        return;
+        return 0;
     }
 
-    // NOTE: Always print all diagnostics on failure or success.
-    DEFER(print_diagnostics(entity));
+    BuildJob *job = create_job(pool, blueprint, entity, compiler);
+    entity->job = job;
 
     FOR (entity->dependencies, dep) {
         Blueprint *module = find_submodule(blueprint, dep->module);
         if (!module) {
             blueprint->status = BLUEPRINT_ERROR;
-            return;
+            entity->status = ENTITY_STATUS_ERROR;
+            return job;
         }
 
         Entity *sub = find_dependency(module, dep->entity);
         if (!sub) {
             blueprint->status = BLUEPRINT_ERROR;
-            return;
+            entity->status = ENTITY_STATUS_ERROR;
+            return job;
         }
 
-        if (!sub) {
-            String msg = {};
-            if (dep->module == "") {
-                msg = t_format("Could not find dependency %S.", dep->entity);
-            } else {
-                msg = t_format("Could not find dependency %S.%S.", dep->module, dep->entity);
-            }
-
-            add_diagnostic(entity, DIAG_ERROR, msg);
-            return;
-        }
+        sub = instantiate(sub, config);
 
         switch (sub->kind) {
         case ENTITY_BRICK: {
@@ -170,15 +286,17 @@ INTERNAL void build(Blueprint *blueprint, Entity *entity) {
         } break;
 
         case ENTITY_LIBRARY: {
-            if (sub->status != ENTITY_STATUS_READY) build(module, sub);
+            BuildJob *sub_job = prepare_build(pool, module, sub);
 
-            if (sub->status == ENTITY_STATUS_READY) {
+            if (sub_job && sub->status != ENTITY_STATUS_ERROR) {
                 append(&entity->libraries, sub->file_path);
                 merge_arrays(&entity->libraries, sub->libraries);
+
+                add_job_dependency(job, sub_job);
             } else {
                 String msg = t_format("Could not build library %S.", sub->name);
                 add_diagnostic(entity, DIAG_ERROR, msg);
-                return;
+                return job;
             }
         } break;
 
@@ -187,54 +305,32 @@ INTERNAL void build(Blueprint *blueprint, Entity *entity) {
             String msg = t_format("Can only add Bricks and Libraries as dependencies at the moment. (entity: %S, dep: %S)\n", entity->name, sub->name);
             add_diagnostic(entity, DIAG_ERROR, msg);
 
-            return;
+            return job;
         }
     }
 
-    if (blueprint->name == "") {
-        char const *fmt = "Building %S %S";
-
-        print(fmt, enum_string(entity->kind), entity->name);
-        if (create_trace()) {
-            append(&App.trace_file, "echo ");
-            format(&App.trace_file, fmt, enum_string(entity->kind), entity->name);
-            append(&App.trace_file, "\n");
-        }
-    } else {
-        char const *fmt = "Building %S %S.%S";
-
-        print(fmt, enum_string(entity->kind), blueprint->name, entity->name);
-        if (create_trace()) {
-            append(&App.trace_file, "echo ");
-            format(&App.trace_file, fmt, enum_string(entity->kind), blueprint->name, entity->name);
-            append(&App.trace_file, "\n");
-        }
-    }
-
-    platform_flush_write_buffer(Console.out);
-
     String extension = {};
     if (entity->kind == ENTITY_EXECUTABLE) {
-        extension = App.target_info.exe;
+        extension = config->target_info.exe;
     } else if (entity->kind == ENTITY_LIBRARY) {
         if (entity->lib_kind == STATIC_LIBRARY) {
-            extension = App.target_info.static_lib;
+            extension = config->target_info.static_lib;
         } else {
             entity->status = ENTITY_STATUS_ERROR;
 
             String msg = t_format("Libary %S could not be build (Not implemented).", entity->name);
             add_diagnostic(DIAG_ERROR, msg);
-            return;
+            return job;
         }
     } else {
         entity->status = ENTITY_STATUS_ERROR;
 
         String msg = t_format("Entity %S could not be build (Not implemented).", entity->name);
         add_diagnostic(DIAG_ERROR, msg);
-        return;
+        return job;
     }
 
-    entity->intermediate_folder = combine_intermediate_path(blueprint->path, entity->name, extension);
+    entity->intermediate_folder = combine_intermediate_path(blueprint->path, entity->name, extension, config);
 
     // NOTE: Static libs are in the intermediate folder to not pollute the build folder by default.
     if (entity->kind == ENTITY_LIBRARY && entity->lib_kind == STATIC_LIBRARY && entity->build_folder == "") {
@@ -243,52 +339,30 @@ INTERNAL void build(Blueprint *blueprint, Entity *entity) {
         entity->file_path = combine_entity_path(blueprint->path, entity->build_folder, entity->name, extension);
     }
 
-    platform_create_all_folders(path_without_filename(entity->file_path));
-    platform_create_folder(entity->intermediate_folder);
-
-    if (create_trace()) {
-        format(&App.trace_file, "IF NOT EXIST %S mkdir \"%S\"\n", path_without_filename(entity->file_path), path_without_filename(entity->file_path));
-        format(&App.trace_file, "IF NOT EXIST %S mkdir \"%S\"\n", entity->intermediate_folder, entity->intermediate_folder);
+    Entity **other = find(&App.output_files, entity->file_path);
+    if (other) {
+        String msg = t_format("%S [%S] and [%S] would both write %S. Use a folder per build type or platform.", entity->name, (*other)->config->name, config->name, entity->file_path);
+        add_diagnostic(entity, DIAG_ERROR, msg);
+        return job;
     }
+    insert(&App.output_files, entity->file_path, entity);
 
-    compiler->generate_commands(DefaultAllocator, blueprint, entity);
-
-    for (s32 i = 0; i < entity->build_command_count; i += 1) {
-        String command = entity->build_commands[i];
-
-        // TODO: The context could use a fixed size buffer to remove allocations.
-        //       I don't think outputs over 1mb would be helpful in any way.
-        auto context = platform_execute(command);
-        if (context.error) {
-            log_error("Could not run command %S.", command);
-            break;
-        }
-
-        compiler->process_diagnostics(entity, context.output);
-
-        destroy(&context.output);
+    create_folders(&App.file_cache, path_without_filename(entity->file_path));
+    create_folders(&App.file_cache, entity->intermediate_folder);
 
-        if (create_trace()) {
-            format(&App.trace_file, "%S\n", command);
-        }
+    if (entity->pgo != PGO_NONE && entity->pgo_folder == "") {
+        entity->pgo_folder = format(App.persistent_alloc, "%Spgo", entity->intermediate_folder);
     }
 
-    if (entity->status == ENTITY_STATUS_ERROR) {
-        App.has_errors = true;
-
-        print("... failed\n");
-    } else {
-        entity->status = ENTITY_STATUS_READY;
-
-        print("... done\n");
+    // NOTE: Profiles of an older instrumented build don't match the new one.
+    if (entity->pgo == PGO_GENERATE) {
+        create_folders(&App.file_cache, entity->pgo_folder);
+        clear_profiles(entity->pgo_folder);
     }
 
-    // TODO: Print might be not a great option. Maybe do something like a DIAG_MESSAGE?
-    if (be_verbose()) {
-        for (s32 i = 0; i < entity->build_command_count; i += 1) {
-            print("with command: %S\n", entity->build_commands[i]);
-        }
-    }
+    compiler->generate_commands(DefaultAllocator, blueprint, entity);
+
+    return job;
 }
 
 INTERNAL String last_directory(String path) {
@@ -308,20 +382,112 @@ enum ApplicationMode {
     APP_MODE_ERROR, // TODO: Is an error code needed here?
     APP_MODE_BUILDING,
     APP_MODE_REGISTER,
+    APP_MODE_PGO,
+    APP_MODE_STATS,
+    APP_MODE_WORKER,
+    APP_MODE_CACHE_SERVER,
 };
 struct StartupOptions {
     ApplicationMode mode;
 
-    String build_type;
+    List<String> build_types;
+    List<String> platforms;
     String group;
-    String platform;
 
     String register_name;
     String trace_file_name;
-
+    String remote_cache;
+    String local_cache;
+    String cache_folder;
+    String timings_file;
+
+    List<String> plugins;
+    List<String> workers;
+
+    s32 jobs;
+    s32 link_threads;
+    s32 stats_builds;
+    s32 port;
+    r64 max_load;
+    s64 max_memory;
     b32 verbose;
+    b32 profile;
+    b32 rebuild;
+    b32 watch;
+    b32 remote_cache_read_only;
 };
 
+INTERNAL void split_list_argument(List<String> *list, String arg) {
+    s64 start = 0;
+    for (s64 i = 0; i <= arg.size; i += 1) {
+        if (i == arg.size || arg[i] == ',') {
+            if (i > start) append(list, String(arg.data + start, i - start));
+
+            start = i + 1;
+        }
+    }
+}
+
+INTERNAL b32 parse_positive_integer(String str, s32 *value) {
+    if (str.size == 0 || str.size > 9) return false;
+
+    s32 result = 0;
+    for (s64 i = 0; i < str.size; i += 1) {
+        if (str[i] < '0' || str[i] > '9') return false;
+
+        result = result * 10 + (str[i] - '0');
+    }
+    if (result == 0) return false;
+
+    *value = result;
+    return true;
+}
+
+// NOTE: A positive number with an optional fraction, e.g. 4 or 2.5.
+INTERNAL b32 parse_positive_decimal(String str, r64 *value) {
+    if (str.size == 0 || str.size > 12) return false;
+
+    r64 result = 0;
+    r64 fraction = 0;
+    for (s64 i = 0; i < str.size; i += 1) {
+        if (str[i] == '.' && fraction == 0) {
+            fraction = 1;
+            continue;
+        }
+        if (str[i] < '0' || str[i] > '9') return false;
+
+        if (fraction > 0) {
+            fraction /= 10;
+            result += fraction * (str[i] - '0');
+        } else {
+            result = result * 10 + (str[i] - '0');
+        }
+    }
+    if (result <= 0) return false;
+
+    *value = result;
+    return true;
+}
+
+// NOTE: A number of bytes with an optional K, M or G suffix, e.g. 8G.
+INTERNAL b32 parse_memory_size(String str, s64 *value) {
+    s64 unit = 1;
+    if (str.size) {
+        switch (str[str.size - 1]) {
+        case 'k': case 'K': unit = 1024;               break;
+        case 'm': case 'M': unit = 1024 * 1024;        break;
+        case 'g': case 'G': unit = 1024 * 1024 * 1024; break;
+        }
+    }
+    if (unit != 1) str.size -= 1;
+
+    s32 count = 0;
+    if (!parse_positive_integer(str, &count)) return false;
+
+    *value = count * unit;
+    return true;
+}
+
 INTERNAL StartupOptions process_arguments(Array<String> args) {
     StartupOptions result = {};
 
@@ -336,7 +502,25 @@ INTERNAL StartupOptions process_arguments(Array<String> args) {
         }
     }
 
-    for (s64 i = 1; i < args.size; i += 1) {
+    s64 first_option = 1;
+    if (args.size > 1 && args[1] == "pgo") {
+        result.mode  = APP_MODE_PGO;
+        first_option = 2;
+    }
+    if (args.size > 1 && args[1] == "stats") {
+        result.mode  = APP_MODE_STATS;
+        first_option = 2;
+    }
+    if (args.size > 1 && args[1] == "worker") {
+        result.mode  = APP_MODE_WORKER;
+        first_option = 2;
+    }
+    if (args.size > 1 && args[1] == "cache_server") {
+        result.mode  = APP_MODE_CACHE_SERVER;
+        first_option = 2;
+    }
+
+    for (s64 i = first_option; i < args.size; i += 1) {
         if (args[i] == "--build_type") {
             i += 1;
             if (args.size <= i) {
@@ -345,7 +529,8 @@ INTERNAL StartupOptions process_arguments(Array<String> args) {
                 break;
             }
 
-            result.build_type = args[i];
+            // NOTE: Multiple build types are separated by commas, e.g. debug,release.
+            split_list_argument(&result.build_types, args[i]);
         } else if (args[i] == "--group") {
             i += 1;
             if (args.size <= i) {
@@ -363,7 +548,8 @@ INTERNAL StartupOptions process_arguments(Array<String> args) {
                 break;
             }
 
-            result.platform = args[i];
+            // NOTE: Multiple targets are separated by commas, e.g. linux,mingw.
+            split_list_argument(&result.platforms, args[i]);
         } else if (args[i] == "--trace") {
             i += 1;
             if (args.size <= i) {
@@ -373,8 +559,138 @@ INTERNAL StartupOptions process_arguments(Array<String> args) {
             }
 
             result.trace_file_name = args[i];
+        } else if (args[i] == "--plugin") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'plugin' is missing a shared library and will be ignored.\n");
+
+                break;
+            }
+
+            append(&result.plugins, args[i]);
+        } else if (args[i] == "--jobs" || args[i] == "-j") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'jobs' is missing a count and will be ignored.\n");
+
+                break;
+            }
+
+            if (!parse_positive_integer(args[i], &result.jobs)) {
+                print("NOTE: Argument 'jobs' expects a positive number. %S will be ignored.\n", args[i]);
+            }
+        } else if (args[i] == "--link_threads") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'link_threads' is missing a count and will be ignored.\n");
+
+                break;
+            }
+
+            if (!parse_positive_integer(args[i], &result.link_threads)) {
+                print("NOTE: Argument 'link_threads' expects a positive number. %S will be ignored.\n", args[i]);
+            }
+        } else if (args[i] == "--load_average" || args[i] == "-l") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'load_average' is missing a number and will be ignored.\n");
+
+                break;
+            }
+
+            if (!parse_positive_decimal(args[i], &result.max_load)) {
+                print("NOTE: Argument 'load_average' expects a positive number. %S will be ignored.\n", args[i]);
+            }
+        } else if (args[i] == "--max_memory") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'max_memory' is missing a size and will be ignored.\n");
+
+                break;
+            }
+
+            if (!parse_memory_size(args[i], &result.max_memory)) {
+                print("NOTE: Argument 'max_memory' expects a size like 512M or 8G. %S will be ignored.\n", args[i]);
+            }
+        } else if (args[i] == "--builds") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'builds' is missing a count and will be ignored.\n");
+
+                break;
+            }
+
+            if (!parse_positive_integer(args[i], &result.stats_builds)) {
+                print("NOTE: Argument 'builds' expects a positive number. %S will be ignored.\n", args[i]);
+            }
+        } else if (args[i] == "--worker") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'worker' is missing a host and will be ignored.\n");
+
+                break;
+            }
+
+            // NOTE: Multiple workers are separated by commas, e.g. build-01,build-02:7171/16.
+            split_list_argument(&result.workers, args[i]);
+        } else if (args[i] == "--remote_cache") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'remote_cache' is missing a url and will be ignored.\n");
+
+                break;
+            }
+
+            result.remote_cache = args[i];
+        } else if (args[i] == "--local_cache") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'local_cache' is missing a folder and will be ignored.\n");
+
+                break;
+            }
+
+            result.local_cache = args[i];
+        } else if (args[i] == "--timings") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'timings' is missing a file and will be ignored.\n");
+
+                break;
+            }
+
+            result.timings_file = args[i];
+        } else if (args[i] == "--folder") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'folder' is missing a path and will be ignored.\n");
+
+                break;
+            }
+
+            result.cache_folder = args[i];
+        } else if (args[i] == "--port") {
+            i += 1;
+            if (args.size <= i) {
+                print("NOTE: Argument 'port' is missing a number and will be ignored.\n");
+
+                break;
+            }
+
+            if (!parse_positive_integer(args[i], &result.port) || result.port > 65535) {
+                print("NOTE: Argument 'port' expects a port number. %S will be ignored.\n", args[i]);
+                result.port = 0;
+            }
         } else if (args[i] == "--verbose") {
             result.verbose = true;
+        } else if (args[i] == "--profile") {
+            result.profile = true;
+        } else if (args[i] == "--rebuild") {
+            result.rebuild = true;
+        } else if (args[i] == "--watch") {
+            result.watch = true;
+        } else if (args[i] == "--remote_cache_read_only") {
+            result.remote_cache_read_only = true;
         } else {
             print("NOTE: Unknown argument %S. Will be ignored.\n", args[i]);
         }
@@ -400,20 +716,481 @@ INTERNAL void print_diagnostics() {
 }
 
 
-INTERNAL b32 get_platform_info(String platform, TargetPlatformInfo *info) {
+INTERNAL b32 get_platform_info(String target, TargetPlatformInfo *info) {
     b32 result = false;
 
-    if (platform == "win32") {
-        *info = {"exe", "lib", "dll"};
+    TargetPlatformInfo result_info = {};
+    result_info.name = target;
+
+    if (target == "win32") {
+        result_info.platform   = "win32";
+        result_info.compiler   = "msvc";
+        result_info.linker     = "msvc";
+        result_info.exe        = "exe";
+        result_info.static_lib = "lib";
+        result_info.shared_lib = "dll";
         result = true;
-    } else if (platform == "linux") {
-        *info = {"", ".a", ".so"};
+    } else if (target == "linux") {
+        result_info.platform   = "linux";
+        result_info.compiler   = "gcc";
+        result_info.linker     = "gcc";
+        result_info.exe        = "";
+        result_info.static_lib = "a";
+        result_info.shared_lib = "so";
         result = true;
+    } else if (target == "mingw") {
+        // NOTE: Windows binaries with the gcc toolchain. #win32 fields apply here as well.
+        result_info.platform   = "win32";
+        result_info.compiler   = "gcc";
+        result_info.linker     = "gcc";
+        result_info.exe        = "exe";
+        result_info.static_lib = "a";
+        result_info.shared_lib = "dll";
+#if defined(OS_LINUX)
+        result_info.tool_prefix = "x86_64-w64-mingw32-";
+#endif
+        result = true;
+    }
+
+    if (result) *info = result_info;
+
+    return result;
+}
+
+// NOTE: Prepares the executables of the selected group. Returns false if there is nothing to build.
+INTERNAL b32 prepare_configuration(JobPool *pool, Blueprint *main_blueprint, BuildConfiguration *config) {
+    b32 result = false;
+
+    for (s64 i = 0; i < main_blueprint->entities.alloc; i += 1) {
+        auto *entry = &main_blueprint->entities.entries[i];
+
+        if (entry->hash == 0) continue;
+
+        Entity *entity = entry->value;
+
+        if (entity->kind == ENTITY_EXECUTABLE) {
+            entity = instantiate(entity, config);
+
+            if ((App.group == "" && entity->groups.size == 0) ||
+                (contains((Array<String>)entity->groups, App.group))) {
+                prepare_build(pool, main_blueprint, entity);
+                result = true;
+            }
+        }
     }
 
     return result;
 }
 
+INTERNAL void finish_compilers(JobPool *pool) {
+    FOR (App.compilers, compiler) {
+        if (compiler->finish_build == 0) continue;
+
+        List<Entity*> entities = {};
+        DEFER(destroy(&entities));
+
+        FOR (pool->jobs, job) {
+            if ((*job)->compiler == compiler) append(&entities, (*job)->entity);
+        }
+
+        if (entities.size) compiler->finish_build(entities);
+    }
+}
+
+// NOTE: Runs a command outside of a job and waits for it. The output is only shown on failure.
+INTERNAL b32 run_single_command(String command) {
+    ProcessLauncher launcher = {};
+    DEFER(destroy(&launcher));
+
+    if (!launch_process(&launcher, command, 0)) return false;
+
+    List<FinishedProcess> finished = {};
+    DEFER(destroy(&finished));
+
+    while (finished.size == 0) wait_for_processes(&launcher, &finished);
+
+    FinishedProcess *process = &finished[0];
+    DEFER(destroy(process));
+
+    b32 result = !process->error && process->exit_code == 0;
+    if (!result || be_verbose()) print("%S", process->output);
+
+    return result;
+}
+
+// NOTE: Runs the training commands of the instrumented builds and merges their profiles.
+INTERNAL b32 train_pgo_builds(JobPool *pool) {
+    b32 result = true;
+
+    FOR (pool->jobs, it) {
+        Entity *entity = (*it)->entity;
+
+        if (entity->pgo != PGO_GENERATE || entity->kind != ENTITY_EXECUTABLE) continue;
+
+        if (entity->pgo_train == "") {
+            print("NOTE: %S has no pgo_train command, its profile has to be created by running it.\n", entity->name);
+            continue;
+        }
+
+        print("Training %S ... ", entity->name);
+        if (!run_single_command(entity->pgo_train)) {
+            print("failed\n");
+            add_diagnostic(DIAG_ERROR, t_format("Training command of %S failed: %S", entity->name, entity->pgo_train));
+
+            result = false;
+            continue;
+        }
+        print("done\n");
+    }
+
+    if (!result) return result;
+
+    // NOTE: Libraries write their profiles into their own folder, so every instrumented Entity is merged.
+    FOR (pool->jobs, it) {
+        Entity *entity = (*it)->entity;
+        Compiler *compiler = (*it)->compiler;
+
+        if (entity->pgo != PGO_GENERATE || compiler->merge_profiles == 0) continue;
+
+        String command = compiler->merge_profiles(DefaultAllocator, entity);
+        DEFER(destroy(&command));
+
+        if (command == "") continue;
+
+        if (be_verbose()) print("Merging profiles with command: %S\n", command);
+
+        if (!run_single_command(command)) {
+            add_diagnostic(DIAG_ERROR, t_format("Could not merge the profiles of %S.", entity->name));
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+// NOTE: bricks pgo: builds instrumented, runs the training commands and then builds again with the
+//       profiles. The configurations were doubled on startup, the first half generates.
+INTERNAL b32 build_with_pgo(JobPool *pool, Blueprint *main_blueprint) {
+    s64 count = App.configurations.size / 2;
+
+    JobPool generate_pool = {};
+    generate_pool.max_parallel = pool->max_parallel;
+    generate_pool.max_load     = pool->max_load;
+    generate_pool.max_memory   = pool->max_memory;
+    DEFER(destroy(&generate_pool));
+
+    b32 result = false;
+    for (s64 i = 0; i < count; i += 1) {
+        if (prepare_configuration(&generate_pool, main_blueprint, &App.configurations[i])) result = true;
+    }
+
+    if (!run_jobs(&generate_pool) || App.has_errors) return result;
+    finish_compilers(&generate_pool);
+
+    if (!train_pgo_builds(&generate_pool)) return result;
+
+    // NOTE: The optimized build writes the same files as the instrumented one.
+    destroy(&App.output_files);
+
+    for (s64 i = count; i < App.configurations.size; i += 1) {
+        prepare_configuration(pool, main_blueprint, &App.configurations[i]);
+    }
+
+    run_jobs(pool);
+    finish_compilers(pool);
+
+    return result;
+}
+
+INTERNAL void init_pool(JobPool *pool) {
+    pool->max_parallel = App.max_parallel_jobs;
+    pool->max_load     = App.max_load;
+    pool->max_memory   = App.max_memory;
+    pool->watch        = App.watch;
+
+    pool->executable = App.executable;
+    pool->remote_cache = App.remote_cache;
+    pool->remote_cache_read_only = App.remote_cache_read_only;
+    pool->local_cache = App.local_cache;
+    FOR (App.workers, it) {
+        RemoteWorker worker = {};
+        parse_worker(*it, App.max_parallel_jobs, &worker);
+
+        append(&pool->workers, worker);
+    }
+}
+
+INTERNAL void collect_blueprints(Blueprint *blueprint, List<Blueprint*> *blueprints) {
+    FOR (*blueprints, it) {
+        if (*it == blueprint) return;
+    }
+
+    append(blueprints, blueprint);
+
+    for (s64 i = 0; i < blueprint->local_imports.alloc; i += 1) {
+        auto *entry = &blueprint->local_imports.entries[i];
+        if (entry->hash != 0) collect_blueprints(entry->value, blueprints);
+    }
+
+    for (s64 i = 0; i < blueprint->named_imports.alloc; i += 1) {
+        auto *entry = &blueprint->named_imports.entries[i];
+        if (entry->hash != 0) collect_blueprints(entry->value, blueprints);
+    }
+}
+
+// NOTE: The main blueprint comes first.
+INTERNAL void collect_all_blueprints(Blueprint *main_blueprint, List<Blueprint*> *blueprints) {
+    collect_blueprints(main_blueprint, blueprints);
+
+    for (s64 i = 0; i < App.imports.alloc; i += 1) {
+        auto *entry = &App.imports.entries[i];
+        if (entry->hash != 0) collect_blueprints(entry->value, blueprints);
+    }
+}
+
+// NOTE: Parses a changed blueprint again in place, so the blueprints importing it keep their pointer.
+//       Its imports stay loaded. Blueprints that imported its entities without an alias get the
+//       new ones, entities that were removed stay in them until Bricks is started again.
+INTERNAL void reparse_blueprint(Blueprint *blueprint, Array<Blueprint*> blueprints) {
+    HashTable<String, Entity*> old_entities = blueprint->entities;
+    DEFER(destroy(&old_entities));
+
+    blueprint->entities = {};
+    destroy(&blueprint->named_imports);
+
+    destroy_globs(blueprint);
+
+    blueprint->status       = BLUEPRINT_INIT;
+    blueprint->compiler     = {};
+    blueprint->linker       = {};
+    blueprint->build_folder = {};
+
+    parse_blueprint_file(blueprint, blueprint->file);
+
+    FOR (blueprints, it) {
+        Blueprint *other = *it;
+        if (other == blueprint) continue;
+
+        for (s64 i = 0; i < other->entities.alloc; i += 1) {
+            auto *entry = &other->entities.entries[i];
+            if (entry->hash == 0) continue;
+
+            Entity **old = find(&old_entities, entry->key);
+            if (!old || *old != entry->value) continue;
+
+            Entity **updated = find(&blueprint->entities, entry->key);
+            if (updated) entry->value = *updated;
+        }
+    }
+}
+
+INTERNAL b32 is_glob_folder(Array<Blueprint*> blueprints, String folder) {
+    FOR (blueprints, it) {
+        FOR ((*it)->globs, glob) {
+            if (contains((Array<String>)glob->folders, folder)) return true;
+        }
+    }
+
+    return false;
+}
+
+// NOTE: Whether a glob of the blueprint that listed folder matches other files now. Files that
+//       only an editor creates while saving, like backups or swap files, don't change it.
+INTERNAL b32 globs_changed(Blueprint *blueprint, String folder) {
+    FOR (blueprint->globs, glob) {
+        if (!contains((Array<String>)glob->folders, folder)) continue;
+
+        List<String> files = {};
+        DEFER(destroy(&files));
+        DEFER(FOR (files, file) destroy(file));
+
+        expand_glob(&App.file_cache, glob->pattern, glob->excludes, &files, DefaultAllocator);
+
+        if (hash_glob_files(files) != glob->files_hash) return true;
+    }
+
+    return false;
+}
+
+// NOTE: Sources, headers from depfiles, blueprints and the folders their globs listed. Outputs are
+//       left out, the build writes them. Files that are watched already are skipped, so it is
+//       called before and after every build.
+INTERNAL void watch_build_files(FileWatcher *watcher, JobPool *pool, Array<Blueprint*> blueprints) {
+    FOR (blueprints, it) {
+        if ((*it)->file != "") platform_watch_file(watcher, (*it)->file);
+
+        FOR ((*it)->globs, glob) {
+            FOR (glob->folders, folder) platform_watch_folder(watcher, *folder);
+        }
+    }
+
+    HashTable<String, b32> outputs = {};
+    DEFER(destroy(&outputs));
+
+    FOR (pool->jobs, job) {
+        FOR ((*job)->entity->build_commands, command) {
+            FOR (command->outputs, output) insert(&outputs, *output, (b32)true);
+        }
+    }
+
+    FOR (pool->jobs, job) {
+        FOR ((*job)->entity->build_commands, command) {
+            FOR (command->inputs, input) {
+                if (!find(&outputs, *input)) platform_watch_file(watcher, *input);
+            }
+        }
+
+        // NOTE: Runs only exist once the job was built.
+        FOR ((*job)->runs, run) {
+            FOR (run->discovered, file) {
+                if (!find(&outputs, *file)) platform_watch_file(watcher, *file);
+            }
+        }
+    }
+}
+
+// NOTE: Delay after a change before building, so saving many files at once only builds once.
+#define WATCH_DEBOUNCE_MS 100
+
+INTERNAL void watch_build_files(FileWatcher *watcher, JobPool *pool, Blueprint *main_blueprint) {
+    List<Blueprint*> blueprints = {};
+    DEFER(destroy(&blueprints));
+
+    collect_all_blueprints(main_blueprint, &blueprints);
+
+    watch_build_files(watcher, pool, blueprints);
+}
+
+// NOTE: bricks --watch: keeps the blueprints and jobs after the first build and builds again
+//       whenever a watched file changes. Only commands reading a changed file run, and the ones
+//       depending on their outputs. A changed blueprint is parsed again and its jobs are created anew.
+//       Runs until Bricks is stopped.
+//
+//       The watcher was started before the first build and runs through every build, so files
+//       saved while building are reported by the next wait. Only headers found during a build in
+//       folders that weren't watched yet can change unnoticed before their folder is watched.
+INTERNAL s32 watch_and_rebuild(FileWatcher *watcher, JobPool *pool, Blueprint *main_blueprint) {
+    HashTable<String, b32> changed_files = {};
+    DEFER(destroy(&changed_files));
+
+    // NOTE: Only the first build runs everything.
+    App.rebuild = false;
+
+    b32 built = true;
+
+    while (true) {
+        List<Blueprint*> blueprints = {};
+        DEFER(destroy(&blueprints));
+
+        collect_all_blueprints(main_blueprint, &blueprints);
+
+        // NOTE: Adds the headers the last build found.
+        watch_build_files(watcher, pool, blueprints);
+
+        if (built) {
+            print("\nWatching for changes ...\n");
+            platform_flush_write_buffer(Console.out);
+        }
+
+        List<String> changed = {};
+        DEFER(destroy(&changed));
+
+        if (!platform_wait_for_changes(watcher, WATCH_DEBOUNCE_MS, &changed)) {
+            print("Could not watch the build files.\n");
+            return -1;
+        }
+
+        App.start_time = platform_time_microseconds();
+        App.diagnostics.size = 0;
+        App.has_errors = false;
+        App.build_log.size = 0;
+
+        // NOTE: Globs are expanded again below and must see files that were added or deleted
+        //       since the last build. reset_jobs would do this otherwise.
+        forget_all_files(&App.file_cache);
+
+        b32 file_changed = false;
+        FOR (changed, file) {
+            if (!is_glob_folder(blueprints, *file)) file_changed = true;
+        }
+
+        b32 blueprint_changed = false;
+        FOR (changed, file) {
+            if (be_verbose()) print("%S changed.\n", *file);
+
+            FOR (blueprints, it) {
+                // NOTE: A changed folder is one that a glob listed.
+                if ((*it)->file != *file && !globs_changed(*it, *file)) continue;
+
+                reparse_blueprint(*it, blueprints);
+                blueprint_changed = true;
+            }
+        }
+
+        // NOTE: Only entries of folders globs listed changed and the globs still match the same
+        //       files, e.g. an editor wrote a swap file next to a source. There is nothing to build.
+        built = file_changed || blueprint_changed;
+        if (!built) continue;
+
+        print("\n");
+
+        if (blueprint_changed) {
+            // NOTE: Entities are instantiated again. The old instances stay in persistent memory.
+            destroy(&App.output_files);
+
+            List<Blueprint*> updated = {};
+            DEFER(destroy(&updated));
+
+            collect_all_blueprints(main_blueprint, &updated);
+
+            FOR (updated, it) {
+                for (s64 i = 0; i < (*it)->entities.alloc; i += 1) {
+                    auto *entry = &(*it)->entities.entries[i];
+                    if (entry->hash != 0) entry->value->instances.size = 0;
+                }
+            }
+
+            destroy(pool);
+            *pool = {};
+            init_pool(pool);
+
+            if (!App.has_errors) {
+                FOR (App.configurations, config) prepare_configuration(pool, main_blueprint, config);
+            }
+        } else {
+            reset_jobs(pool);
+
+            destroy(&changed_files);
+            FOR (changed, file) insert(&changed_files, *file, (b32)true);
+
+            pool->changed_files = &changed_files;
+        }
+
+        if (!App.has_errors) {
+            // NOTE: Sources a changed blueprint added.
+            if (blueprint_changed) watch_build_files(watcher, pool, main_blueprint);
+
+            run_jobs(pool);
+            finish_compilers(pool);
+        }
+
+        pool->changed_files = 0;
+
+        print_diagnostics();
+
+        if (App.has_errors) {
+            print("\nBuild aborted.\n");
+        } else {
+            print_job_summary(pool);
+            print("\nBuild finished.\n");
+        }
+
+        write_build_log(platform_time_microseconds() - App.start_time, App.has_errors ? -1 : 0);
+    }
+
+    return 0;
+}
+
 INTERNAL void prepare_trace_file() {
     if (!create_trace()) return;
 
@@ -422,12 +1199,47 @@ INTERNAL void prepare_trace_file() {
 }
 
 
+// NOTE: Microseconds spent in each part of a build, see write_timings.
+struct BuildTimings {
+    s64 parse; // NOTE: Reading the blueprints and their imports.
+    s64 plan;  // NOTE: Instantiating the entities and generating their commands.
+    s64 build; // NOTE: Running the commands, which includes checking if they are up to date.
+};
+
+// NOTE: --timings <file> appends one line of JSON per build, read by bench/bench_build.cpp. The
+//       memory is the peak of Bricks itself, not of the commands it ran.
+INTERNAL void write_timings(String file, BuildTimings *timings, JobStatistics *stats, s32 result) {
+    s32 command_count = 0;
+    for (s32 i = 0; i < COMMAND_KIND_COUNT; i += 1) command_count += stats->command_count[i];
+
+    String line = t_format("{\"parse_us\": %d, \"plan_us\": %d, \"build_us\": %d, \"total_us\": %d, \"peak_memory_kb\": %d, \"commands\": %d, \"skipped\": %d, \"result\": %d}\n",
+                           (s32)timings->parse, (s32)timings->plan, (s32)timings->build,
+                           (s32)(platform_time_microseconds() - App.start_time), (s32)(platform_peak_memory() / 1024),
+                           command_count, stats->skipped_count, result);
+
+    if (!platform_append_to_file(file, line.data, line.size)) print("Could not write the timings to %S.\n", file);
+}
+
+INTERNAL String folder_listings_file() {
+    return t_format("%S/folder_listings", App.build_files_folder);
+}
+
+// NOTE: bench_micro links all of Bricks and has its own entry point, see bench/bench_micro.cpp.
+#if !defined(BRICKS_NO_MAIN)
 s32 application_main(Array<String> args) {
+    App.start_time = platform_time_microseconds();
+
     init(&App.persistent_memory, MEGABYTES(1));
     DEFER(destroy(&App.persistent_memory));
+    DEFER(destroy(&App.file_cache));
 
     App.persistent_alloc = make_pool_allocator(&App.persistent_memory);
 
+    // NOTE: These run for every compile, so they skip everything a build needs.
+    if (args.size > 2 && args[1] == "remote_compile") return run_remote_compile(args[2]);
+    if (args.size > 2 && args[1] == "cache_lookup")   return run_cache_lookup(args[2]);
+    if (args.size > 4 && args[1] == "cache_upload")   return run_cache_upload(args[2], args[3], args[4]);
+
     String config_folder = platform_home_folder();
     if (config_folder == "") {
         add_diagnostic(DIAG_ERROR, "Could not retrieve configuration path.");
@@ -482,43 +1294,189 @@ s32 application_main(Array<String> args) {
         return 0;
     }
 
+    if (options.mode == APP_MODE_STATS) {
+        s32 build_count = options.stats_builds;
+        if (build_count == 0) build_count = 10;
+
+        return print_build_stats(build_count);
+    }
+
+    if (options.mode == APP_MODE_WORKER) {
+        s32 jobs = options.jobs;
+        if (jobs == 0) jobs = platform_processor_count();
+
+        return run_worker(options.port ? (u16)options.port : DEFAULT_WORKER_PORT, jobs);
+    }
+
+    if (options.mode == APP_MODE_CACHE_SERVER) {
+        String folder = options.cache_folder;
+        if (folder == "") folder = format(App.persistent_alloc, "%S/cache", App.build_files_folder);
+
+        return run_cache_server(options.port ? (u16)options.port : DEFAULT_CACHE_SERVER_PORT, folder);
+    }
+
     App.verbose = options.verbose;
+    App.profile = options.profile;
+    App.rebuild = options.rebuild;
+    App.watch   = options.watch;
+
+    if (App.watch && options.mode == APP_MODE_PGO) {
+        print("NOTE: bricks pgo can't watch for changes, --watch will be ignored.\n");
+        App.watch = false;
+    }
     App.group   = options.group;
-    App.build_type      = options.build_type;
     App.trace_file_name = options.trace_file_name;
 
-    platform_create_folder(App.build_files_folder);
+    App.max_parallel_jobs = options.jobs;
+    if (App.max_parallel_jobs == 0) App.max_parallel_jobs = platform_processor_count();
+
+    // NOTE: Links mostly run at the end of a build when little else is left to do.
+    App.link_threads = options.link_threads;
+    if (App.link_threads == 0) App.link_threads = App.max_parallel_jobs;
 
-    if (!get_platform_info(App.target_platform, &App.target_info)) {
-        add_diagnostic(DIAG_ERROR, t_format("Unsupported platform %S.", App.target_platform));
+    App.max_load   = options.max_load;
+    App.max_memory = options.max_memory;
+
+    FOR (options.workers, it) {
+        RemoteWorker worker = {};
+        if (!parse_worker(*it, App.max_parallel_jobs, &worker)) {
+            print("NOTE: Worker %S is not of the form host:port/slots and will be ignored.\n", *it);
+            continue;
+        }
+
+        append(&App.workers, *it);
+    }
+
+    HttpUrl url = {};
+    if (options.remote_cache != "" && !parse_http_url(options.remote_cache, &url)) {
+        print("NOTE: Remote cache %S is not of the form http://host:port/path and will be ignored.\n", options.remote_cache);
+    } else {
+        App.remote_cache = options.remote_cache;
+        App.remote_cache_read_only = options.remote_cache_read_only;
+    }
+
+    App.local_cache = options.local_cache;
+
+    if (App.workers.size || App.remote_cache != "" || App.local_cache != "") {
+        App.executable = platform_executable_path(App.persistent_alloc);
+
+        if (App.executable == "") {
+            print("NOTE: Could not find the Bricks executable, all commands run locally.\n");
+            App.workers.size = 0;
+            App.remote_cache = {};
+            App.local_cache  = {};
+        }
+    }
+
+    if (App.local_cache != "") {
+        create_folders(&App.file_cache, t_format("%S/ac",  App.local_cache));
+        create_folders(&App.file_cache, t_format("%S/cas", App.local_cache));
+        create_folders(&App.file_cache, t_format("%S/mf",  App.local_cache));
+    }
+
+    create_folders(&App.file_cache, App.build_files_folder);
+    load_folder_listings(&App.file_cache, folder_listings_file());
+
+    // NOTE: No build type given still means one configuration with an empty type.
+    if (options.build_types.size == 0) append(&options.build_types, String());
+    if (options.platforms.size   == 0) append(&options.platforms, App.target_platform);
+
+    FOR (options.platforms, platform) {
+        TargetPlatformInfo info = {};
+        if (!get_platform_info(*platform, &info)) {
+            add_diagnostic(DIAG_ERROR, t_format("Unsupported platform %S.", *platform));
+            print_diagnostics();
+
+            return -1;
+        }
+
+        FOR (options.build_types, build_type) {
+            BuildConfiguration config = {};
+            config.index = (s32)App.configurations.size;
+            config.build_type      = *build_type;
+            config.target_platform = info.platform;
+            config.target_info     = info;
+
+            if (options.platforms.size > 1) {
+                config.name = *build_type == "" ? *platform : format(App.persistent_alloc, "%S %S", *build_type, *platform);
+            } else {
+                config.name = *build_type;
+            }
+
+            append(&App.configurations, config);
+        }
+    }
+
+    if (options.mode == APP_MODE_PGO) {
+        s64 count = App.configurations.size;
+
+        for (s64 i = 0; i < count; i += 1) {
+            BuildConfiguration *generate = &App.configurations[i];
+            String name = generate->name;
+
+            generate->pgo  = PGO_GENERATE;
+            generate->name = name == "" ? String("pgo generate") : format(App.persistent_alloc, "%S pgo generate", name);
+
+            BuildConfiguration config = *generate;
+            config.index = (s32)App.configurations.size;
+            config.pgo   = PGO_USE;
+            config.name  = name == "" ? String("pgo use") : format(App.persistent_alloc, "%S pgo use", name);
+
+            append(&App.configurations, config);
+        }
+    }
+
+    FOR (options.plugins, plugin) {
+        load_compiler_plugin(*plugin);
+    }
+
+    if (App.has_errors) {
         print_diagnostics();
 
         return -1;
     }
 
+    BuildTimings timings = {};
+    s64 phase_start = platform_time_microseconds();
+
     Blueprint *main_blueprint = create_blueprint();
     DEFER(destroy(main_blueprint));
 
     parse_blueprint_file(main_blueprint, "blueprint");
 
+    timings.parse = platform_time_microseconds() - phase_start;
+
     prepare_trace_file();
 
+    JobPool pool = {};
+    init_pool(&pool);
+    DEFER(destroy(&pool));
+
+    FileWatcher watcher = {};
+    DEFER(destroy(&watcher));
+
     b32 has_stuff_to_build = false;
     if (!App.has_errors) {
-        for (s64 i = 0; i < main_blueprint->entities.alloc; i += 1) {
-            auto *entry = &main_blueprint->entities.entries[i];
+        if (options.mode == APP_MODE_PGO) {
+            has_stuff_to_build = build_with_pgo(&pool, main_blueprint);
+        } else {
+            phase_start = platform_time_microseconds();
 
-            if (entry->hash == 0) continue;
+            // NOTE: All configurations share the parsed blueprints and the same job pool.
+            FOR (App.configurations, config) {
+                if (prepare_configuration(&pool, main_blueprint, config)) has_stuff_to_build = true;
+            }
 
-            Entity *entity = entry->value;
+            timings.plan = platform_time_microseconds() - phase_start;
+            phase_start  = platform_time_microseconds();
 
-            if (entity->kind == ENTITY_EXECUTABLE) {
-                if ((App.group == "" && entity->groups.size == 0) ||
-                    (contains((Array<String>)entity->groups, App.group))) {
-                    build(main_blueprint, entity);
-                    has_stuff_to_build = true;
-                }
-            }
+            // NOTE: Started before building, so files saved during the first build are seen, see watch_and_rebuild.
+            if (App.watch) watch_build_files(&watcher, &pool, main_blueprint);
+
+            run_jobs(&pool);
+            finish_compilers(&pool);
+
+            timings.build = platform_time_microseconds() - phase_start;
         }
     }
 
@@ -531,6 +1489,8 @@ s32 application_main(Array<String> args) {
     } else {
         print_diagnostics();
         if (has_stuff_to_build) {
+            print_job_summary(&pool);
+
             if (create_trace()) {
                 PlatformFile trace_file = platform_file_open(App.trace_file_name, PlatformFileOverride);
                 if (!trace_file.open) {
@@ -549,6 +1509,21 @@ s32 application_main(Array<String> args) {
         print("\nBuild finished.\n");
     }
 
+    save_folder_listings(&App.file_cache, folder_listings_file());
+
+    if (App.local_cache != "") {
+        s64 saved = 0;
+        s32 compressed = compress_cold_entries(App.local_cache, &saved);
+
+        if (compressed) print("Compressed %d cache entries that weren't used for %d days, saving %d MB.\n", compressed, LOCAL_CACHE_COLD_DAYS, (s32)(saved / (1024 * 1024)));
+    }
+
+    if (has_stuff_to_build) write_build_log(platform_time_microseconds() - App.start_time, result);
+    if (options.timings_file != "") write_timings(options.timings_file, &timings, &pool.statistics, result);
+
+    if (App.watch) result = watch_and_rebuild(&watcher, &pool, main_blueprint);
+
     return result;
 }
+#endif
 
@@ -7,28 +7,97 @@
 #include "pool.h"
 #include "hash_table.h"
 #include "brickyard.h"
+#include "build_log.h"
+#include "file_cache.h"
 
 
 struct Blueprint;
 struct Entity;
+struct BuildCommand;
+
+// NOTE: A compile split up so it can run on a bricks worker. The preprocess command runs locally
+//       and writes source, which is the only file the worker gets. There the compile command runs
+//       in an empty folder, reading the file as source_name and writing object_name, which is
+//       copied back to object.
+struct RemoteCompile {
+    String preprocess;
+    String compile;
+
+    String source;
+    String source_name;
+    String object;
+    String object_name;
+};
 
 typedef void BuildCommandsFunc(Allocator alloc, Blueprint *blueprint, Entity *entity);
 typedef void ProcessCommandDiagFunc(Entity *entity, String output);
+typedef void FinishBuildFunc(Array<Entity*> entities);
+typedef void ParseDepfileFunc(Entity *entity, String content, List<String> *dependencies);
+typedef String JobCommandFunc(Allocator alloc, Entity *entity, String command);
+typedef String ProfileMergeFunc(Allocator alloc, Entity *entity);
+typedef b32 RemoteCompileFunc(Allocator alloc, Entity *entity, BuildCommand *command, RemoteCompile *remote);
 struct Compiler {
     String name;
 
     BuildCommandsFunc *generate_commands;
     ProcessCommandDiagFunc *process_diagnostics;
+
+    // NOTE: Optional. Called once after all jobs ran with every Entity built by this compiler.
+    FinishBuildFunc *finish_build;
+
+    // NOTE: Optional. Reads a dependency file written by the compiler and appends all files the
+    //       build depends on. The files are allocated with DefaultAllocator and owned by the caller.
+    ParseDepfileFunc *parse_depfile;
+
+    // NOTE: Optional. Called right before a generated command is run and returns the command that
+    //       is actually run, e.g. to put it through a wrapper. Return the command itself to keep it.
+    JobCommandFunc *generate_job_command;
+
+    // NOTE: Optional. Returns the command that turns the raw profiles of training runs into
+    //       what pgo: use reads, or an empty string if the compiler reads them directly.
+    ProfileMergeFunc *merge_profiles;
+
+    // NOTE: Optional. Fills remote for a compile command that can be sent to a bricks worker,
+    //       returns false if it has to run locally. The strings are allocated with alloc.
+    RemoteCompileFunc *remote_compile;
 };
 
 
 
 struct TargetPlatformInfo {
+    String name;     // NOTE: The target as given with --platform.
+    String platform; // NOTE: What #platform field specifiers are matched against.
+
+    // NOTE: Used if the blueprint does not specify them.
+    String compiler;
+    String linker;
+    String tool_prefix; // NOTE: Cross toolchains, e.g. x86_64-w64-mingw32-
+
     String exe;
     String static_lib;
     String shared_lib;
 };
 
+enum PgoMode {
+    PGO_NONE,
+    PGO_GENERATE,
+    PGO_USE,
+};
+
+// NOTE: Everything that differs between builds of the same blueprint in one run.
+//       Entities are instantiated once per configuration.
+struct BuildConfiguration {
+    s32 index;
+    String name;
+
+    String build_type;
+    String target_platform;
+    TargetPlatformInfo target_info;
+
+    // NOTE: Set by bricks pgo. Overrides the pgo field of every Entity that has one.
+    PgoMode pgo;
+};
+
 enum DiagnosticKind {
     DIAG_GENERAL,
     DIAG_NOTE,
@@ -59,10 +128,26 @@ struct ApplicationState {
     String brickyard_file;
     Brickyard brickyard;
 
-    String target_platform;
-    TargetPlatformInfo target_info;
+    String target_platform; // NOTE: The host platform, used if no --platform is given.
+
+    List<BuildConfiguration> configurations;
+    s32 max_parallel_jobs;
+    s32 link_threads;
+
+    // NOTE: Limits for starting new commands, 0 means no limit. See JobPool.
+    r64 max_load;
+    s64 max_memory;
+
+    // NOTE: --worker arguments, already checked by parse_worker, and the executable the
+    //       distributed compiles run as bricks remote_compile.
+    List<String> workers;
+    String executable;
+
+    // NOTE: --remote_cache, see remote_cache.h, and --local_cache, see local_cache.h.
+    String remote_cache;
+    b32 remote_cache_read_only;
+    String local_cache;
 
-    String build_type;
     String group;
 
     List<Diagnostic> diagnostics;
@@ -71,11 +156,22 @@ struct ApplicationState {
     List<Compiler> compilers;
 
     b32 verbose;
+    b32 profile;
+    b32 rebuild; // NOTE: Run all commands, even the ones that are up to date.
+    b32 watch;   // NOTE: Build again whenever a source, header or blueprint changes.
 
     String trace_file_name;
     StringBuilder trace_file;
 
+    s64 start_time; // NOTE: platform_time_microseconds when Bricks started.
+    List<BuildLogRecord> build_log; // NOTE: Commands of this build, written at the end.
+
+    FileCache file_cache;
+
     HashTable<String, Blueprint*> imports;
+
+    // NOTE: Used to detect configurations that would overwrite each others files.
+    HashTable<String, Entity*> output_files;
 };
 
 
@@ -83,6 +179,27 @@ void add_diagnostic(DiagnosticKind kind, String msg);
 
 b32 be_verbose();
 b32 create_trace();
+b32 create_profile();
+
+// NOTE: Threads a linker may use, for linkers that can be told.
+s32 link_thread_count();
+
+// NOTE: The workspace is the folder Bricks runs in, its path differs between checkouts. Compilers
+//       map it to . in what they write, and cache keys replace it with map_workspace_paths, so the
+//       same code gives the same objects and cache entries wherever it is checked out.
+String workspace_folder();
+String map_workspace_paths(String text, String workspace, Allocator alloc);
+
+// NOTE: xxHash64 on 8 bytes at a time, continuing from hash. Everything Bricks compares between
+//       builds or machines uses it: file contents, command lines and cache keys.
+#define HASH_SEED 14695981039346656037ull
+
+u64 hash_content(u64 hash, String content);
+u64 hash_content(String content);
+
+// NOTE: Lists used as sets, e.g. for the include folders an Entity gets from its Bricks.
+void append_unique(List<String> *list, String str);
+void merge_arrays(List<String> *dest, Array<String> src);
 
 void load_core_compilers();
 b32  load_compiler_plugin(String shared_lib);
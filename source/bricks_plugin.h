@@ -0,0 +1,107 @@
+#pragma once
+
+// NOTE: The interface between Bricks and compiler plugins.
+//       This header must stay self contained and C compatible. Plugins don't link
+//       against Bricks, they only export BRICKS_PLUGIN_ENTRY and talk to Bricks
+//       through the BricksHost functions.
+//
+//       Rules for changing it:
+//         - Never change or reorder existing members.
+//         - New members are only appended to the end of a struct.
+//         - Appending to BricksCompilerPlugin increases BRICKS_PLUGIN_VERSION.
+
+#include <stdint.h>
+
+
+#define BRICKS_PLUGIN_VERSION     1
+#define BRICKS_PLUGIN_MIN_VERSION 1
+
+#define BRICKS_PLUGIN_ENTRY "bricks_compiler_plugin"
+
+#if defined(_WIN32)
+#define BRICKS_PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define BRICKS_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+
+// NOTE: Strings are not zero terminated and are only valid during a call.
+typedef struct BricksString {
+    char const *data;
+    int64_t size;
+} BricksString;
+
+typedef struct BricksStringArray {
+    BricksString const *data;
+    int64_t size;
+} BricksStringArray;
+
+enum BricksEntityKind {
+    BRICKS_ENTITY_EXECUTABLE = 2,
+    BRICKS_ENTITY_LIBRARY    = 3,
+};
+
+enum BricksLibraryKind {
+    BRICKS_NO_LIBRARY     = 0,
+    BRICKS_STATIC_LIBRARY = 1,
+    BRICKS_SHARED_LIBRARY = 2,
+};
+
+enum BricksDiagnosticKind {
+    BRICKS_DIAG_GENERAL = 0,
+    BRICKS_DIAG_NOTE    = 1,
+    BRICKS_DIAG_WARNING = 2,
+    BRICKS_DIAG_ERROR   = 3,
+};
+
+typedef struct BricksEntity {
+    int32_t kind;
+    int32_t lib_kind;
+
+    BricksString name;
+    BricksString file_path;
+    BricksString intermediate_folder;
+
+    BricksString build_type;
+    BricksString platform;    // NOTE: What #platform specifiers match, e.g. win32.
+    BricksString target;      // NOTE: The target given with --platform, e.g. mingw.
+    BricksString tool_prefix; // NOTE: Prefix of cross toolchains, can be empty.
+
+    BricksStringArray sources;
+    BricksStringArray include_folders;
+    BricksStringArray symbols;
+    BricksStringArray options;
+    BricksStringArray libraries;
+} BricksEntity;
+
+typedef struct BricksHost {
+    uint32_t version;
+    void *context; // NOTE: Pass this to every function below.
+
+    // NOTE: generate_commands: appends a build command. Commands run in order.
+    //       generate_job_command: sets the command that is run instead.
+    void (*add_command)(void *context, BricksString command);
+    void (*add_diagnostic)(void *context, int32_t kind, BricksString message);
+
+    // NOTE: parse_depfile: reports a file the build depends on.
+    void (*add_dependency)(void *context, BricksString file);
+} BricksHost;
+
+typedef struct BricksCompilerPlugin {
+    uint32_t version; // NOTE: BRICKS_PLUGIN_VERSION the plugin was built with.
+    uint32_t size;    // NOTE: sizeof(BricksCompilerPlugin) the plugin was built with.
+
+    char const *name; // NOTE: Used in blueprints with compiler: "name"; and @name.
+
+    void (*generate_commands)(BricksHost const *host, BricksEntity const *entity);
+    void (*process_diagnostics)(BricksHost const *host, BricksEntity const *entity, BricksString output);
+
+    // NOTE: Optional, can be null.
+    void (*parse_depfile)(BricksHost const *host, BricksEntity const *entity, BricksString content);
+    void (*generate_job_command)(BricksHost const *host, BricksEntity const *entity, BricksString command);
+} BricksCompilerPlugin;
+
+// NOTE: The exported function. host_version is BRICKS_PLUGIN_VERSION of Bricks,
+//       return null if the plugin can't work with it.
+typedef BricksCompilerPlugin const *BricksCompilerPluginEntry(uint32_t host_version);
+
@@ -0,0 +1,360 @@
+#include "build_log.h"
+
+#include "bricks.h"
+#include "blueprint.h"
+#include "process.h"
+#include "file_system.h"
+#include "platform.h"
+#include "binary.h"
+#include "io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+extern ApplicationState App;
+
+
+#define BUILD_LOG_VERSION 1
+
+// NOTE: Around 64000 records. When the log grows larger, only the newer half is kept.
+#define BUILD_LOG_MAX_SIZE MEGABYTES(8)
+
+struct BuildLogHeader {
+    char magic[8];
+    u32 version;
+    u32 record_size;
+};
+
+INTERNAL BuildLogHeader make_header() {
+    BuildLogHeader header = {};
+    memcpy(header.magic, "BRICKLOG", 8);
+    header.version     = BUILD_LOG_VERSION;
+    header.record_size = sizeof(BuildLogRecord);
+
+    return header;
+}
+
+INTERNAL String build_log_file() {
+    return t_format("%S/build_log", App.build_files_folder);
+}
+
+// NOTE: Returns the number of records, 0 if the log is missing or was written by another version.
+INTERNAL s64 build_log_record_count(String file) {
+    s64 size = 0;
+    if (!platform_file_size(file, &size) || size < (s64)sizeof(BuildLogHeader)) return 0;
+
+    BuildLogHeader header = {};
+    if (!platform_read_file_part(file, 0, &header, sizeof(header))) return 0;
+
+    BuildLogHeader expected = make_header();
+    if (memcmp(&header, &expected, sizeof(header)) != 0) return 0;
+
+    // NOTE: A record cut off by a crash is ignored.
+    return (size - (s64)sizeof(BuildLogHeader)) / (s64)sizeof(BuildLogRecord);
+}
+
+INTERNAL s64 record_offset(s64 index) {
+    return (s64)sizeof(BuildLogHeader) + index * (s64)sizeof(BuildLogRecord);
+}
+
+void set_name(BuildLogRecord *record, String name) {
+    s64 max_size = sizeof(record->name) - 1;
+    if (name.size > max_size) name = String(name.data + name.size - max_size, max_size);
+
+    memcpy(record->name, name.data, name.size);
+    record->name[name.size] = '\0';
+}
+
+void write_build_log(s64 wall_time, s32 exit_code) {
+    String file = build_log_file();
+    s64 count = build_log_record_count(file);
+
+    u32 build = 1;
+    if (count > 0) {
+        BuildLogRecord last = {};
+        if (platform_read_file_part(file, record_offset(count - 1), &last, sizeof(last))) build = last.build + 1;
+    }
+
+    BuildLogRecord build_record = {};
+    build_record.type      = BUILD_LOG_BUILD;
+    build_record.exit_code = exit_code;
+    build_record.parallel  = App.max_parallel_jobs;
+    build_record.end       = wall_time;
+    build_record.timestamp = (s64)time(0) - wall_time / 1000000;
+    set_name(&build_record, App.group);
+
+    append(&App.build_log, build_record);
+
+    FOR (App.build_log, record) record->build = build;
+
+    s64 new_size = App.build_log.size * (s64)sizeof(BuildLogRecord);
+
+    // NOTE: Appending is the common case. A new or unreadable log and one that grew too large are
+    //       written again, keeping the newer half of the old records.
+    if (count > 0 && record_offset(count) + new_size <= BUILD_LOG_MAX_SIZE) {
+        platform_append_to_file(file, App.build_log.data, new_size);
+        return;
+    }
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    write_binary(&builder, make_header());
+
+    s64 keep = 0;
+    if (count > 0) keep = count / 2;
+
+    if (keep > 0) {
+        BuildLogRecord *kept = ALLOC(DefaultAllocator, BuildLogRecord, keep);
+        DEFER(deallocate(DefaultAllocator, kept, sizeof(BuildLogRecord) * keep));
+
+        if (platform_read_file_part(file, record_offset(count - keep), kept, keep * (s64)sizeof(BuildLogRecord))) {
+            append(&builder, String((u8*)kept, keep * (s64)sizeof(BuildLogRecord)));
+        }
+    }
+
+    append(&builder, String((u8*)App.build_log.data, new_size));
+
+    PlatformFile log_file = platform_file_open(file, PlatformFileOverride);
+    if (!log_file.open) return;
+
+    write_builder_to_file(&builder, &log_file);
+    platform_file_close(&log_file);
+}
+
+
+// NOTE: Reads records from the end until build_count builds are complete. The records stay in file order.
+INTERNAL void read_last_builds(String file, s32 build_count, List<BuildLogRecord> *records) {
+    s64 count = build_log_record_count(file);
+
+    s64 const chunk_size = 1024;
+    BuildLogRecord *chunk = ALLOC(DefaultAllocator, BuildLogRecord, chunk_size);
+    DEFER(deallocate(DefaultAllocator, chunk, sizeof(BuildLogRecord) * chunk_size));
+
+    s32 builds = 0;
+    s64 first  = count;
+
+    s64 end = count;
+    while (end > 0 && builds <= build_count) {
+        s64 start = end - chunk_size;
+        if (start < 0) start = 0;
+
+        if (!platform_read_file_part(file, record_offset(start), chunk, (end - start) * (s64)sizeof(BuildLogRecord))) break;
+
+        for (s64 i = end - start - 1; i >= 0; i -= 1) {
+            if (chunk[i].type == BUILD_LOG_BUILD) builds += 1;
+
+            // NOTE: The build record of an older build ends the search.
+            if (builds > build_count) break;
+
+            first = start + i;
+        }
+
+        end = start;
+    }
+
+    for (s64 start = first; start < count; start += chunk_size) {
+        s64 size = count - start;
+        if (size > chunk_size) size = chunk_size;
+
+        if (!platform_read_file_part(file, record_offset(start), chunk, size * (s64)sizeof(BuildLogRecord))) break;
+
+        for (s64 i = 0; i < size; i += 1) append(records, chunk[i]);
+    }
+}
+
+struct SourceStats {
+    String name;
+
+    s64 total;   // NOTE: Of the builds before the last one it ran in.
+    s32 count;
+    s64 longest;
+
+    s64 last;    // NOTE: Duration in the newest build it ran in.
+    u32 last_build;
+};
+
+INTERNAL s32 to_ms(s64 microseconds) {
+    return (s32)(microseconds / 1000);
+}
+
+INTERNAL int compare_average(void const *a, void const *b) {
+    SourceStats const *stats_a = (SourceStats const*)a;
+    SourceStats const *stats_b = (SourceStats const*)b;
+
+    s64 average_a = (stats_a->total + stats_a->last) / (stats_a->count + 1);
+    s64 average_b = (stats_b->total + stats_b->last) / (stats_b->count + 1);
+
+    if (average_a > average_b) return -1;
+    if (average_a < average_b) return  1;
+
+    return 0;
+}
+
+INTERNAL s64 regression(SourceStats const *stats) {
+    if (stats->count == 0) return 0;
+
+    return stats->last - stats->total / stats->count;
+}
+
+INTERNAL int compare_regression(void const *a, void const *b) {
+    s64 delta_a = regression((SourceStats const*)a);
+    s64 delta_b = regression((SourceStats const*)b);
+
+    if (delta_a > delta_b) return -1;
+    if (delta_a < delta_b) return  1;
+
+    return 0;
+}
+
+INTERNAL String format_timestamp(s64 timestamp) {
+    char buffer[32] = {};
+
+    time_t time = (time_t)timestamp;
+    tm *local = localtime(&time);
+    if (local) strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", local);
+
+    return t_format("%S", String((u8*)buffer, (s64)strlen(buffer)));
+}
+
+#define STATS_LIST_SIZE 10
+
+s32 print_build_stats(s32 build_count) {
+    List<BuildLogRecord> records = {};
+    DEFER(destroy(&records));
+
+    read_last_builds(build_log_file(), build_count, &records);
+
+    // NOTE: Commands of a build come before its build record.
+    s32 builds = 0;
+    FOR (records, record) {
+        if (record->type == BUILD_LOG_BUILD) builds += 1;
+    }
+
+    if (builds == 0) {
+        print("No builds were logged yet.\n");
+        return 0;
+    }
+
+    // NOTE: Passed as a string, so format doesn't read it as the start of a specifier.
+    String percent = "%";
+
+    print("Last %d builds:\n", builds);
+
+    s32 ran_total  = 0;
+    s32 skip_total = 0;
+
+    s32 cached_total = 0;
+
+    s64 busy = 0;
+    s32 ran = 0, skipped = 0, cached = 0, failed = 0;
+    FOR (records, record) {
+        if (record->type == BUILD_LOG_COMMAND) {
+            if      (record->result == BUILD_LOG_UP_TO_DATE) skipped += 1;
+            else if (record->result == BUILD_LOG_CACHE_HIT)  cached  += 1;
+            else if (record->result == BUILD_LOG_FAILED)     failed  += 1;
+            else                                             ran     += 1;
+
+            if (record->result != BUILD_LOG_UP_TO_DATE) busy += record->end - record->start;
+            continue;
+        }
+
+        // NOTE: How much of the available parallelism was used while the build ran.
+        s32 utilization = 0;
+        if (record->end > 0 && record->parallel > 0) {
+            utilization = (s32)(busy * 100 / (record->end * record->parallel));
+        }
+
+        print("  Build %d at %S: %d ms, ran %d, up to date %d, from cache %d, failed %d, used %d%S of %d parallel commands%S\n",
+              (s32)record->build, format_timestamp(record->timestamp), to_ms(record->end),
+              ran, skipped, cached, failed, utilization, percent, record->parallel, record->exit_code ? String(", aborted") : String());
+
+        ran_total    += ran + failed;
+        skip_total   += skipped;
+        cached_total += cached;
+
+        busy = 0;
+        ran = skipped = cached = failed = 0;
+    }
+
+    s32 command_total = ran_total + skip_total + cached_total;
+    if (command_total > 0) {
+        print("\nUp to date: %d of %d commands (%d%S).\n", skip_total, command_total, skip_total * 100 / command_total, percent);
+    }
+
+    if (cached_total > 0) {
+        print("From cache: %d of %d commands (%d%S).\n", cached_total, command_total, cached_total * 100 / command_total, percent);
+    }
+
+    // NOTE: Per source, the last time it was compiled is compared against the runs before. Cache
+    //       hits didn't compile, they would make the source look fast.
+    List<SourceStats> sources = {};
+    DEFER(destroy(&sources));
+
+    HashTable<String, s64> source_index = {};
+    DEFER(destroy(&source_index));
+
+    FOR (records, record) {
+        if (record->type != BUILD_LOG_COMMAND || record->kind != COMMAND_COMPILE || record->result != BUILD_LOG_RAN) continue;
+
+        String name = String((u8*)record->name, (s64)strlen(record->name));
+        s64 duration = record->end - record->start;
+
+        s64 *index = find(&source_index, name);
+        if (!index) {
+            SourceStats stats = {};
+            stats.name = name;
+
+            append(&sources, stats);
+            insert(&source_index, name, sources.size - 1);
+
+            index = find(&source_index, name);
+        }
+
+        SourceStats *stats = &sources[*index];
+        if (stats->last_build != 0) {
+            stats->total += stats->last;
+            stats->count += 1;
+        }
+
+        stats->last       = duration;
+        stats->last_build = record->build;
+
+        if (duration > stats->longest) stats->longest = duration;
+    }
+
+    if (sources.size == 0) return 0;
+
+    qsort(sources.data, sources.size, sizeof(SourceStats), compare_average);
+
+    print("\nSlowest compiles:\n");
+    for (s64 i = 0; i < sources.size && i < STATS_LIST_SIZE; i += 1) {
+        SourceStats *stats = &sources[i];
+
+        s64 average = (stats->total + stats->last) / (stats->count + 1);
+        print("  %S: %d ms on average, longest %d ms in %d runs\n", stats->name, to_ms(average), to_ms(stats->longest), stats->count + 1);
+    }
+
+    qsort(sources.data, sources.size, sizeof(SourceStats), compare_regression);
+
+    // NOTE: Only changes above 10% and 50 ms are worth showing.
+    b32 has_regressions = false;
+    for (s64 i = 0; i < sources.size && i < STATS_LIST_SIZE; i += 1) {
+        SourceStats *stats = &sources[i];
+        if (stats->count == 0) continue;
+
+        s64 average = stats->total / stats->count;
+        s64 delta   = regression(stats);
+        if (delta < 50000 || delta * 10 < average) continue;
+
+        if (!has_regressions) print("\nSlower than before:\n");
+        has_regressions = true;
+
+        print("  %S: %d ms in build %d, %d ms (%d%S) slower than before\n", stats->name, to_ms(stats->last), (s32)stats->last_build, to_ms(delta), (s32)(delta * 100 / (average ? average : 1)), percent);
+    }
+
+    return 0;
+}
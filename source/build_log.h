@@ -0,0 +1,55 @@
+#pragma once
+
+#include "definitions.h"
+#include "list.h"
+
+
+// NOTE: History of all builds in .bricks/build_log, used by bricks stats.
+//       The file is a header followed by records of a fixed size, so it can be read from the end
+//       without parsing everything before. Every build appends the records of its commands and then
+//       one build record. Once the file gets too large the older half is dropped.
+
+enum BuildLogRecordType : u8 {
+    BUILD_LOG_COMMAND = 1,
+    BUILD_LOG_BUILD   = 2,
+};
+enum BuildLogResult : u8 {
+    BUILD_LOG_RAN        = 0,
+    BUILD_LOG_UP_TO_DATE = 1, // NOTE: Counts as a cache hit.
+    BUILD_LOG_FAILED     = 2,
+    BUILD_LOG_CACHE_HIT  = 3, // NOTE: Restored from the cache, the duration is the lookup and not a compile.
+};
+
+struct BuildLogRecord {
+    u32 build; // NOTE: Counts up by one every build, set when the log is written.
+
+    BuildLogRecordType type;
+    u8 kind; // NOTE: CommandKind.
+    BuildLogResult result;
+    u8 unused;
+
+    s32 exit_code;
+    s32 parallel; // NOTE: Build records: the maximum number of parallel commands.
+
+    u64 hash;
+
+    // NOTE: Microseconds since the build started. Build records end after the whole build.
+    s64 start;
+    s64 end;
+
+    s64 peak_memory; // NOTE: Bytes, 0 if unknown.
+    s64 timestamp;   // NOTE: Build records: unix time in seconds when the build started.
+
+    char name[72]; // NOTE: The source or output of a command, zero terminated. Long paths keep their end.
+};
+
+static_assert(sizeof(BuildLogRecord) == 128, "Changing BuildLogRecord changes the file format.");
+
+
+void set_name(BuildLogRecord *record, String name);
+
+// NOTE: Appends the command records collected in App.build_log and a build record.
+void write_build_log(s64 wall_time, s32 exit_code);
+
+// NOTE: bricks stats. Reports on the last build_count builds.
+s32 print_build_stats(s32 build_count);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "definitions.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// NOTE: Zero terminated copies of strings for the system calls in linux/ and win32/. The result is
+//       allocated with malloc, free it when done. The suffix is appended, e.g. "\\*" for FindFirstFile.
+inline char *to_c_string(String str, char const *suffix = "") {
+    s64 suffix_size = (s64)strlen(suffix);
+
+    char *result = (char*)malloc(str.size + suffix_size + 1);
+    memcpy(result, str.data, str.size);
+    memcpy(result + str.size, suffix, suffix_size);
+    result[str.size + suffix_size] = '\0';
+
+    return result;
+}
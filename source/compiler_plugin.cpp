@@ -0,0 +1,318 @@
+#include "bricks.h"
+
+#include "blueprint.h"
+#include "bricks_plugin.h"
+#include "shared_library.h"
+#include "string_builder.h"
+#include "io.h"
+
+#include <stddef.h>
+
+
+extern ApplicationState App;
+
+
+struct CompilerPlugin {
+    String name;
+    String file;
+
+    SharedLibrary library;
+    BricksCompilerPlugin const *vtable;
+
+    // NOTE: Optional members are only read if the plugin was built with them.
+    b32 has_parse_depfile;
+    b32 has_job_command;
+};
+
+// NOTE: Pointers, so the Compiler functions can find their plugin by name.
+INTERNAL List<CompilerPlugin*> Plugins;
+
+
+INTERNAL CompilerPlugin *find_plugin(String name) {
+    FOR (Plugins, plugin) {
+        if ((*plugin)->name == name) return *plugin;
+    }
+
+    return 0;
+}
+
+INTERNAL BricksString to_plugin_string(String str) {
+    BricksString result = {};
+    result.data = (char const*)str.data;
+    result.size = str.size;
+
+    return result;
+}
+
+INTERNAL String from_plugin_string(BricksString str) {
+    if (str.data == 0 || str.size <= 0) return {};
+
+    return String((u8*)str.data, str.size);
+}
+
+// NOTE: Keeps the converted string arrays alive during a plugin call.
+struct PluginEntity {
+    BricksEntity entity;
+
+    List<BricksString> arrays[5];
+};
+
+INTERNAL BricksStringArray to_plugin_array(List<BricksString> *storage, List<String> *list) {
+    FOR (*list, str) {
+        append(storage, to_plugin_string(*str));
+    }
+
+    BricksStringArray result = {};
+    result.data = storage->data;
+    result.size = storage->size;
+
+    return result;
+}
+
+INTERNAL void init(PluginEntity *plugin_entity, Entity *entity) {
+    BricksEntity *result = &plugin_entity->entity;
+    BuildConfiguration *config = entity->config;
+
+    result->kind     = entity->kind;
+    result->lib_kind = entity->lib_kind;
+
+    result->name                = to_plugin_string(entity->name);
+    result->file_path           = to_plugin_string(entity->file_path);
+    result->intermediate_folder = to_plugin_string(entity->intermediate_folder);
+
+    result->build_type  = to_plugin_string(config->build_type);
+    result->platform    = to_plugin_string(config->target_platform);
+    result->target      = to_plugin_string(config->target_info.name);
+    result->tool_prefix = to_plugin_string(config->target_info.tool_prefix);
+
+    result->sources         = to_plugin_array(&plugin_entity->arrays[0], &entity->sources);
+    result->include_folders = to_plugin_array(&plugin_entity->arrays[1], &entity->include_folders);
+    result->symbols         = to_plugin_array(&plugin_entity->arrays[2], &entity->symbols);
+    result->options         = to_plugin_array(&plugin_entity->arrays[3], &entity->options);
+    result->libraries       = to_plugin_array(&plugin_entity->arrays[4], &entity->libraries);
+}
+
+INTERNAL void destroy(PluginEntity *plugin_entity) {
+    for (s32 i = 0; i < 5; i += 1) {
+        destroy(&plugin_entity->arrays[i]);
+    }
+}
+
+
+// NOTE: Everything a host function needs to know. Passed to the plugin as BricksHost::context.
+struct PluginCall {
+    Entity *entity;
+
+    Allocator alloc;
+    String command;
+    b32 has_command;
+
+    List<String> *dependencies;
+};
+
+INTERNAL void host_add_build_command(void *context, BricksString command) {
+    PluginCall *call = (PluginCall*)context;
+
+    // NOTE: Plugin commands keep running one after the other, Bricks doesn't know what they do.
+    //       Without outputs they are never skipped.
+    s32 index = add_build_command(call->entity, COMMAND_CUSTOM, from_plugin_string(command), {}, "");
+    if (index > 0) add_command_dependency(call->entity, index, index - 1);
+}
+
+INTERNAL void host_set_job_command(void *context, BricksString command) {
+    PluginCall *call = (PluginCall*)context;
+
+    if (call->has_command) destroy(&call->command);
+
+    call->command = allocate_string(from_plugin_string(command), call->alloc);
+    call->has_command = true;
+}
+
+INTERNAL void host_add_diagnostic(void *context, s32 kind, BricksString message) {
+    PluginCall *call = (PluginCall*)context;
+
+    DiagnosticKind diag_kind = DIAG_GENERAL;
+    switch (kind) {
+    case BRICKS_DIAG_NOTE:    diag_kind = DIAG_NOTE;    break;
+    case BRICKS_DIAG_WARNING: diag_kind = DIAG_WARNING; break;
+    case BRICKS_DIAG_ERROR:   diag_kind = DIAG_ERROR;   break;
+    }
+
+    add_diagnostic(call->entity, diag_kind, from_plugin_string(message));
+}
+
+INTERNAL void host_add_dependency(void *context, BricksString file) {
+    PluginCall *call = (PluginCall*)context;
+
+    if (call->dependencies) {
+        append(call->dependencies, allocate_string(from_plugin_string(file), DefaultAllocator));
+    }
+}
+
+INTERNAL BricksHost make_host(PluginCall *call) {
+    BricksHost host = {};
+    host.version = BRICKS_PLUGIN_VERSION;
+    host.context = call;
+    host.add_command    = host_add_build_command;
+    host.add_diagnostic = host_add_diagnostic;
+    host.add_dependency = host_add_dependency;
+
+    return host;
+}
+
+
+INTERNAL void plugin_build_command(Allocator alloc, Blueprint *blueprint, Entity *entity) {
+    if (entity->status == ENTITY_STATUS_READY) return;
+    if (entity->status == ENTITY_STATUS_ERROR) return;
+
+    CompilerPlugin *plugin = find_plugin(entity->compiler);
+    assert(plugin);
+
+    PluginEntity plugin_entity = {};
+    init(&plugin_entity, entity);
+    DEFER(destroy(&plugin_entity));
+
+    PluginCall call = {};
+    call.entity = entity;
+    call.alloc  = alloc;
+
+    BricksHost host = make_host(&call);
+    plugin->vtable->generate_commands(&host, &plugin_entity.entity);
+}
+
+INTERNAL void plugin_process_diagnostics(Entity *entity, String output) {
+    CompilerPlugin *plugin = find_plugin(entity->compiler);
+    assert(plugin);
+
+    PluginEntity plugin_entity = {};
+    init(&plugin_entity, entity);
+    DEFER(destroy(&plugin_entity));
+
+    PluginCall call = {};
+    call.entity = entity;
+
+    BricksHost host = make_host(&call);
+    plugin->vtable->process_diagnostics(&host, &plugin_entity.entity, to_plugin_string(output));
+}
+
+INTERNAL void plugin_parse_depfile(Entity *entity, String content, List<String> *dependencies) {
+    CompilerPlugin *plugin = find_plugin(entity->compiler);
+    assert(plugin && plugin->has_parse_depfile);
+
+    PluginEntity plugin_entity = {};
+    init(&plugin_entity, entity);
+    DEFER(destroy(&plugin_entity));
+
+    PluginCall call = {};
+    call.entity = entity;
+    call.dependencies = dependencies;
+
+    BricksHost host = make_host(&call);
+    plugin->vtable->parse_depfile(&host, &plugin_entity.entity, to_plugin_string(content));
+}
+
+INTERNAL String plugin_job_command(Allocator alloc, Entity *entity, String command) {
+    CompilerPlugin *plugin = find_plugin(entity->compiler);
+    assert(plugin && plugin->has_job_command);
+
+    PluginEntity plugin_entity = {};
+    init(&plugin_entity, entity);
+    DEFER(destroy(&plugin_entity));
+
+    PluginCall call = {};
+    call.entity = entity;
+    call.alloc  = alloc;
+
+    BricksHost host = make_host(&call);
+    host.add_command = host_set_job_command;
+
+    plugin->vtable->generate_job_command(&host, &plugin_entity.entity, to_plugin_string(command));
+
+    if (!call.has_command) return command;
+
+    return call.command;
+}
+
+
+// NOTE: True if the plugin was built with a header that already had the member.
+#define PLUGIN_HAS_MEMBER(vtable, member) ((vtable)->size >= offsetof(BricksCompilerPlugin, member) + sizeof((vtable)->member))
+
+b32 load_compiler_plugin(String shared_lib) {
+    // NOTE: Multiple blueprints can use the same plugin.
+    FOR (Plugins, plugin) {
+        if ((*plugin)->file == shared_lib) return true;
+    }
+
+    SharedLibrary library = {};
+    if (!platform_load_library(&library, shared_lib)) {
+        add_diagnostic(DIAG_ERROR, t_format("Could not load compiler plugin %S.", shared_lib));
+        return false;
+    }
+
+    auto entry = (BricksCompilerPluginEntry*)platform_find_symbol(&library, BRICKS_PLUGIN_ENTRY);
+    if (!entry) {
+        add_diagnostic(DIAG_ERROR, t_format("Compiler plugin %S does not export %S.", shared_lib, String(BRICKS_PLUGIN_ENTRY)));
+        platform_unload_library(&library);
+
+        return false;
+    }
+
+    BricksCompilerPlugin const *vtable = entry(BRICKS_PLUGIN_VERSION);
+
+    String error = {};
+    if (!vtable) {
+        error = "does not support this version of Bricks";
+    } else if (vtable->version < BRICKS_PLUGIN_MIN_VERSION || vtable->version > BRICKS_PLUGIN_VERSION) {
+        error = t_format("was built for plugin version %d but Bricks supports %d to %d", (s32)vtable->version, BRICKS_PLUGIN_MIN_VERSION, BRICKS_PLUGIN_VERSION);
+    } else if (!PLUGIN_HAS_MEMBER(vtable, process_diagnostics)) {
+        error = "has an invalid size";
+    } else if (!vtable->name || !vtable->name[0]) {
+        error = "has no name";
+    } else if (!vtable->generate_commands || !vtable->process_diagnostics) {
+        error = "is missing generate_commands or process_diagnostics";
+    }
+
+    if (error != "") {
+        add_diagnostic(DIAG_ERROR, t_format("Compiler plugin %S %S.", shared_lib, error));
+        platform_unload_library(&library);
+
+        return false;
+    }
+
+    String name = {};
+    name.data = (u8*)vtable->name;
+    while (vtable->name[name.size]) name.size += 1;
+
+    FOR (App.compilers, compiler) {
+        if (compiler->name == name) {
+            add_diagnostic(DIAG_ERROR, t_format("Compiler plugin %S uses the name %S which is already taken.", shared_lib, name));
+            platform_unload_library(&library);
+
+            return false;
+        }
+    }
+
+    CompilerPlugin *plugin = ALLOC(App.persistent_alloc, CompilerPlugin, 1);
+    plugin->name    = allocate_string(name, App.persistent_alloc);
+    plugin->file    = allocate_string(shared_lib, App.persistent_alloc);
+    plugin->library = library;
+    plugin->vtable  = vtable;
+    plugin->has_parse_depfile = PLUGIN_HAS_MEMBER(vtable, parse_depfile)        && vtable->parse_depfile;
+    plugin->has_job_command   = PLUGIN_HAS_MEMBER(vtable, generate_job_command) && vtable->generate_job_command;
+
+    append(&Plugins, plugin);
+
+    Compiler compiler = {};
+    compiler.name = plugin->name;
+    compiler.generate_commands   = plugin_build_command;
+    compiler.process_diagnostics = plugin_process_diagnostics;
+    if (plugin->has_parse_depfile) compiler.parse_depfile        = plugin_parse_depfile;
+    if (plugin->has_job_command)   compiler.generate_job_command = plugin_job_command;
+
+    append(&App.compilers, compiler);
+
+    if (be_verbose()) print("Loaded compiler plugin %S from %S.\n", plugin->name, plugin->file);
+
+    return true;
+}
+
@@ -0,0 +1,169 @@
+#include "compression.h"
+
+#include <string.h>
+
+
+// NOTE: The format needs the last 5 bytes to be literals and the last match to start 12 bytes
+//       before the end.
+#define MIN_MATCH      4
+#define LAST_LITERALS  5
+#define MATCH_LIMIT    12
+#define MAX_OFFSET     65535
+
+#define HASH_BITS 16
+
+
+INTERNAL u32 read_u32(u8 const *p) {
+    u32 value = 0;
+    memcpy(&value, p, 4);
+
+    return value;
+}
+
+INTERNAL u32 hash_sequence(u32 sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// NOTE: Lengths of 15 and more continue in bytes of 255 until a smaller one.
+INTERNAL u8 *write_length(u8 *out, s64 length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (u8)length;
+
+    return out;
+}
+
+s64 compress_bound(s64 size) {
+    return size + size / 255 + 16;
+}
+
+INTERNAL u8 *write_sequence(u8 *out, u8 const *literals, s64 literal_count, s64 offset, s64 match_length) {
+    u8 *token = out++;
+
+    s64 literal_code = literal_count < 15 ? literal_count : 15;
+    if (literal_count >= 15) out = write_length(out, literal_count - 15);
+
+    // NOTE: Empty inputs have no data at all.
+    if (literal_count) memcpy(out, literals, literal_count);
+    out += literal_count;
+
+    // NOTE: The last sequence only has literals.
+    if (match_length == 0) {
+        *token = (u8)(literal_code << 4);
+        return out;
+    }
+
+    *out++ = (u8)(offset & 0xff);
+    *out++ = (u8)(offset >> 8);
+
+    s64 match_code = match_length - MIN_MATCH;
+    if (match_code >= 15) out = write_length(out, match_code - 15);
+
+    *token = (u8)((literal_code << 4) | (match_code < 15 ? match_code : 15));
+
+    return out;
+}
+
+s64 compress(String input, u8 *output) {
+    u8 const *start = input.data;
+    u8 const *end   = input.data + input.size;
+    u8 *out = output;
+
+    if (input.size < MATCH_LIMIT + 1) {
+        out = write_sequence(out, start, input.size, 0, 0);
+        return out - output;
+    }
+
+    // NOTE: Positions of the last 4 byte sequences with each hash, +1 so 0 means none.
+    static s32 table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    u8 const *match_limit = end - MATCH_LIMIT;
+    u8 const *literals = start;
+    u8 const *p = start;
+
+    while (p < match_limit) {
+        u32 sequence = read_u32(p);
+        u32 hash = hash_sequence(sequence);
+
+        s32 candidate = table[hash] - 1;
+        table[hash] = (s32)(p - start) + 1;
+
+        u8 const *match = start + candidate;
+        if (candidate < 0 || p - match > MAX_OFFSET || read_u32(match) != sequence) {
+            p += 1;
+            continue;
+        }
+
+        // NOTE: Extends the match, it has to stop before the last literals.
+        u8 const *match_end = p + MIN_MATCH;
+        u8 const *reference = match + MIN_MATCH;
+        while (match_end < end - LAST_LITERALS && *match_end == *reference) {
+            match_end += 1;
+            reference += 1;
+        }
+
+        out = write_sequence(out, literals, p - literals, p - match, match_end - p);
+
+        p = match_end;
+        literals = p;
+    }
+
+    out = write_sequence(out, literals, end - literals, 0, 0);
+
+    return out - output;
+}
+
+INTERNAL b32 read_length(u8 const **in, u8 const *end, s64 *length) {
+    while (true) {
+        if (*in >= end) return false;
+
+        u8 byte = *(*in)++;
+        *length += byte;
+
+        if (byte != 255) return true;
+    }
+}
+
+b32 decompress(String input, u8 *output, s64 output_size) {
+    u8 const *in  = input.data;
+    u8 const *end = input.data + input.size;
+    u8 *out = output;
+    u8 *out_end = output + output_size;
+
+    while (in < end) {
+        u8 token = *in++;
+
+        s64 literal_count = token >> 4;
+        if (literal_count == 15 && !read_length(&in, end, &literal_count)) return false;
+
+        if (literal_count > end - in || literal_count > out_end - out) return false;
+
+        memcpy(out, in, literal_count);
+        in  += literal_count;
+        out += literal_count;
+
+        // NOTE: The last sequence ends after its literals.
+        if (in == end) break;
+
+        if (end - in < 2) return false;
+
+        s64 offset = in[0] | (in[1] << 8);
+        in += 2;
+
+        s64 match_length = token & 15;
+        if (match_length == 15 && !read_length(&in, end, &match_length)) return false;
+        match_length += MIN_MATCH;
+
+        if (offset == 0 || offset > out - output || match_length > out_end - out) return false;
+
+        // NOTE: Byte by byte, the match can overlap what it writes.
+        u8 const *match = out - offset;
+        for (s64 i = 0; i < match_length; i += 1) out[i] = match[i];
+        out += match_length;
+    }
+
+    return out == out_end;
+}
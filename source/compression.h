@@ -0,0 +1,18 @@
+#pragma once
+
+#include "definitions.h"
+#include "string2.h"
+
+
+// NOTE: LZ4 block format. Fast enough in both directions that reading a compressed cache entry
+//       costs less than reading the uncompressed one from disk. Nothing is framed, the caller keeps
+//       the uncompressed size.
+
+// NOTE: The largest size compress can write for size bytes.
+s64 compress_bound(s64 size);
+
+// NOTE: Returns the size written to output, which must have compress_bound(input.size) bytes.
+s64 compress(String input, u8 *output);
+
+// NOTE: Fails on anything that doesn't decompress to exactly output_size bytes.
+b32 decompress(String input, u8 *output, s64 output_size);
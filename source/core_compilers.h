@@ -4,5 +4,19 @@
 
 
 Compiler load_msvc(); 
-Compiler load_gcc(); 
+Compiler load_gcc();
+Compiler load_clang(); 
+
+// NOTE: Make style dependency files as written by gcc and clang with -MMD or -MD.
+void parse_make_depfile(Entity *entity, String content, List<String> *dependencies);
+
+// NOTE: The debug_info field for gcc and clang, which take the same flags. Split debug info goes to
+//       a .dwo file next to each object. Only ELF targets get it and not with lto, where the
+//       compiles write no DWARF. Those fall back to plain -g.
+b32    uses_split_dwarf(Entity *entity);
+String split_dwarf_file(String object, Allocator alloc);
+void   append_debug_info_flags(StringBuilder *builder, Entity *entity, b32 link);
+
+// NOTE: For debug_info: split dwp; packs the .dwo files into <file>.dwp once the link is done.
+void add_debug_package_command(Allocator alloc, Entity *entity, s32 link_command, String dwp, Array<String> object_files);
 
@@ -0,0 +1,722 @@
+#include "blueprint.h"
+#include "bricks.h"
+#include "core_compilers.h"
+#include "string_builder.h"
+#include "hash_table.h"
+#include "platform.h"
+#include "file_system.h"
+#include "io.h"
+
+#include <stdlib.h>
+
+
+extern ApplicationState App;
+
+
+INTERNAL String remove_line(String *str) {
+    String result;
+    result.data = str->data;
+
+    u32 const multi_char_line_end = '\n' + '\r';
+    for (s64 i = 0; i < str->size; i += 1) {
+        if (str->data[i] == '\n' || str->data[i] == '\r') {
+            result.size = i;
+            if (i + 1 < str->size && str->data[i] + str->data[i + 1] == multi_char_line_end) i += 1;
+
+            str->data += i + 1;
+            str->size -= i + 1;
+
+            return result;
+        }
+    }
+
+    result = *str;
+    *str = {};
+
+    return result;
+}
+
+INTERNAL void process_diagnostics(Entity *entity, String output) {
+    while (output.size) {
+        String line = remove_line(&output);
+
+        if (contains(line, ": error:")) {
+            add_diagnostic(entity, DIAG_ERROR, line);
+        } else if (contains(line, ": fatal error:")) {
+            add_diagnostic(entity, DIAG_ERROR, line);
+        } else if (contains(line, ": warning:")) {
+            add_diagnostic(entity, DIAG_WARNING, line);
+        } else if (contains(line, ": note:")) {
+            add_diagnostic(entity, DIAG_NOTE, line);
+        } else if (contains(line, ": undefined reference to ")) {
+            add_diagnostic(entity, DIAG_NOTE, line);
+        } else {
+            continue;
+        }
+
+        // NOTE: Add following lines if they are indented. But only if a diagnostic was encountered.
+        while (output.size > 0 && output[0] == ' ') {
+            line = remove_line(&output);
+            add_diagnostic(entity, DIAG_GENERAL, line);
+        }
+    }
+}
+
+INTERNAL b32 is_time_trace(String file) {
+    return file.size > 5 && String(file.data + file.size - 5, 5) == ".json";
+}
+
+// NOTE: clang writes the trace of each object next to it, main.cpp.o gets main.cpp.json. Traces
+//       of sources that were removed from the entity would end up in the report otherwise.
+//       The others are kept, sources that are up to date don't write a new one.
+INTERNAL void delete_stale_time_traces(Entity *entity, Array<String> traces) {
+    List<FolderEntry> entries = {};
+    DEFER(destroy(&entries));
+
+    if (!platform_list_folder(entity->intermediate_folder, &entries, DefaultAllocator)) return;
+
+    FOR (entries, entry) {
+        String file = t_format("%S%S", entity->intermediate_folder, entry->name);
+        if (!entry->is_folder && is_time_trace(file) && !contains(traces, file)) platform_delete_file(file);
+
+        destroy(entry);
+    }
+}
+
+// NOTE: The default linker is used if the blueprint doesn't name one. Targets default
+//       to the gcc linker, which is what clang uses as well.
+INTERNAL b32 append_linker(StringBuilder *builder, Entity *entity) {
+    String linker = entity->linker;
+    s32 threads = link_thread_count();
+
+    if (linker == "" || linker == "gcc" || linker == "clang") return true;
+
+    if (linker == "mold") {
+        format(builder, " -fuse-ld=mold -Wl,--thread-count=%d", threads);
+    } else if (linker == "lld") {
+        format(builder, " -fuse-ld=lld -Wl,--threads=%d", threads);
+    } else if (linker == "gold") {
+        format(builder, " -fuse-ld=gold -Wl,--threads -Wl,--thread-count=%d", threads);
+    } else if (linker == "bfd") {
+        append(builder, " -fuse-ld=bfd");
+    } else {
+        add_diagnostic(entity, DIAG_ERROR, t_format("Unknown linker %S for %S. Supported are mold, lld, gold and bfd.", linker, entity->name));
+        entity->status = ENTITY_STATUS_ERROR;
+
+        return false;
+    }
+
+    return true;
+}
+
+INTERNAL void append_target(StringBuilder *builder, Entity *entity) {
+    // NOTE: Clang is a cross compiler already, it only needs the triple.
+    String prefix = entity->config->target_info.tool_prefix;
+    if (prefix.size) {
+        format(builder, " --target=%S", shrink_back(prefix, 1));
+    }
+}
+
+INTERNAL String profile_data_file(Entity *entity) {
+    return t_format("%S/default.profdata", entity->pgo_folder);
+}
+
+// NOTE: Profile flags are needed by compile and link commands, the link pulls in the profile runtime.
+INTERNAL void append_pgo_flags(StringBuilder *builder, Entity *entity) {
+    if (entity->pgo == PGO_GENERATE) {
+        format(builder, " -fprofile-generate=\"%S\"", entity->pgo_folder);
+    } else if (entity->pgo == PGO_USE) {
+        format(builder, " -fprofile-use=\"%S\" -Wno-profile-instr-unprofiled", profile_data_file(entity));
+    }
+}
+
+INTERNAL void append_lto_flags(StringBuilder *builder, Entity *entity) {
+    if (entity->lto == LTO_THIN) {
+        append(builder, " -flto=thin");
+    } else if (entity->lto == LTO_FULL) {
+        append(builder, " -flto=full");
+    }
+}
+
+// NOTE: Only thin lto runs its backend in parallel.
+INTERNAL void append_link_lto_flags(StringBuilder *builder, Entity *entity) {
+    append_lto_flags(builder, entity);
+
+    if (entity->lto != LTO_THIN) return;
+
+    if (entity->linker == "lld") {
+        format(builder, " -Wl,--thinlto-jobs=%d", link_thread_count());
+    } else {
+        format(builder, " -Wl,-plugin-opt,jobs=%d", link_thread_count());
+    }
+}
+
+// NOTE: The training runs write one .profraw per process. They are listed here instead of using
+//       a glob, cmd doesn't expand those. With many of them they go into a response file, cmd only
+//       takes 8 KB. Without any llvm-profdata fails, which is reported like a failed merge.
+INTERNAL String clang_merge_profiles(Allocator alloc, Entity *entity) {
+    if (entity->pgo != PGO_GENERATE) return {};
+
+    List<FolderEntry> entries = {};
+    DEFER(destroy(&entries));
+    DEFER(FOR (entries, entry) destroy(entry));
+
+    platform_list_folder(entity->pgo_folder, &entries, DefaultAllocator);
+
+    String extension = ".profraw";
+
+    StringBuilder inputs = {};
+    DEFER(destroy(&inputs));
+
+    FOR (entries, entry) {
+        String name = entry->name;
+        if (entry->is_folder || name.size <= extension.size) continue;
+
+        if (String(name.data + name.size - extension.size, extension.size) == extension) {
+            format(&inputs, " \"%S/%S\"", entity->pgo_folder, name);
+        }
+    }
+
+    if (inputs.total_size > 8000) {
+        String response_file = t_format("%S/profraw.rsp", entity->pgo_folder);
+
+        PlatformFile rsp = platform_file_open(response_file, PlatformFileOverride);
+        if (rsp.open) {
+            b32 written = write_builder_to_file(&inputs, &rsp);
+            platform_file_close(&rsp);
+
+            if (written) return format(alloc, "llvm-profdata merge -output=\"%S\" @\"%S\"", profile_data_file(entity), response_file);
+        }
+    }
+
+    String files = to_allocated_string(&inputs, DefaultAllocator);
+    DEFER(destroy(&files));
+
+    return format(alloc, "llvm-profdata merge -output=\"%S\"%S", profile_data_file(entity), files);
+}
+
+// NOTE: Without the preprocessor flags for compiling an already preprocessed source.
+INTERNAL void append_compile_flags(StringBuilder *builder, Entity *entity, b32 preprocess) {
+    append_target(builder, entity);
+    append_arguments(builder, entity->options, "", false);
+
+    if (preprocess) {
+        append_arguments(builder, entity->symbols, "-D", false);
+        append_arguments(builder, entity->include_folders, "-I", true);
+    }
+
+    // NOTE: Debug info and __FILE__ name the files in the workspace relative to it, so objects are
+    //       the same in every checkout.
+    format(builder, " -ffile-prefix-map=\"%S\"=.", workspace_folder());
+
+    if (entity->kind == ENTITY_LIBRARY && entity->lib_kind == SHARED_LIBRARY) append(builder, " -fPIC");
+    append_debug_info_flags(builder, entity, false);
+    append_lto_flags(builder, entity);
+    append_pgo_flags(builder, entity);
+}
+
+INTERNAL void clang_build_command(Allocator alloc, Blueprint *blueprint, Entity *entity) {
+    SCOPE_TEMP_STORAGE();
+
+    if (entity->status == ENTITY_STATUS_READY) return;
+    if (entity->status == ENTITY_STATUS_ERROR) return;
+
+    if (entity->kind != ENTITY_EXECUTABLE && entity->kind != ENTITY_LIBRARY) {
+        add_diagnostic(entity, DIAG_ERROR, t_format("Can only build Executables and Libraries. (entity: %S)\n", entity->name));
+        return;
+    }
+
+    if (entity->sources.size == 0) {
+        add_diagnostic(entity, DIAG_ERROR, t_format("%S has no source file(s) to build.", entity->name));
+        // TODO: Maybe don't error and just report it?
+        //       So the build can finish if this entity is unused.
+        entity->status = ENTITY_STATUS_ERROR;
+        return;
+    }
+
+    b32 is_shared = entity->kind == ENTITY_LIBRARY && entity->lib_kind == SHARED_LIBRARY;
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    List<String> object_files = {};
+    DEFER(destroy(&object_files));
+
+    get_object_files(entity, "o", &object_files);
+
+    List<String> time_traces = {};
+    DEFER(destroy(&time_traces));
+
+    // NOTE: Everything but the files is the same for all sources, so it is only built once.
+    append(&builder, " -c");
+    append_compile_flags(&builder, entity, true);
+
+    if (create_profile()) {
+        get_object_files(entity, "json", &time_traces);
+        delete_stale_time_traces(entity, time_traces);
+
+        append(&builder, " -ftime-trace");
+    }
+
+    String compile_flags = to_allocated_string(&builder, alloc);
+    DEFER(destroy(&compile_flags));
+
+    // NOTE: One command per source, so they can be compiled in parallel.
+    for (s64 i = 0; i < entity->sources.size; i += 1) {
+        String depfile = format(alloc, "%S.d", object_files[i]);
+
+        String arguments[] = {
+            compile_flags,
+            t_format(" -MMD -MF \"%S\" -o\"%S\" \"%S\"", depfile, object_files[i], entity->sources[i]),
+        };
+
+        s32 command = add_build_command(entity, COMMAND_COMPILE, "clang", {arguments, 2}, t_format("%S.rsp", object_files[i]));
+        add_command_input  (entity, command, entity->sources[i]);
+        add_command_output (entity, command, object_files[i]);
+        set_command_depfile(entity, command, depfile);
+
+        if (uses_split_dwarf(entity)) add_command_output(entity, command, split_dwarf_file(object_files[i], alloc));
+
+        // NOTE: A missing trace runs the compile again, so the report covers every source.
+        if (time_traces.size) add_command_output(entity, command, time_traces[i]);
+    }
+
+    String objects = quoted_files(object_files, alloc);
+    DEFER(destroy(&objects));
+
+    String response_file = t_format("%S%S.rsp", entity->intermediate_folder, entity->name);
+
+    if (entity->kind == ENTITY_LIBRARY && !is_shared) {
+        // NOTE: ar replaces the members of an existing archive. Bitcode objects of lto builds
+        //       need llvm-ar for the archive index.
+        String archiver = "llvm-ar";
+        if (entity->lto == LTO_NONE) archiver = t_format("%Sar", entity->config->target_info.tool_prefix);
+
+        // NOTE: D leaves out timestamps, so an archive of the same objects is the same file.
+        String arguments[] = {t_format(" rcsD \"%S\"", entity->file_path), objects};
+
+        s32 command = add_build_command(entity, COMMAND_ARCHIVE, archiver, {arguments, 2}, response_file);
+        add_link_command_files(entity, command, object_files);
+        return;
+    }
+
+    reset(&builder);
+
+    append_target(&builder, entity);
+    append_arguments(&builder, entity->options, "", false);
+
+    if (!append_linker(&builder, entity)) return;
+
+    append_link_lto_flags(&builder, entity);
+    append_pgo_flags(&builder, entity);
+    append_debug_info_flags(&builder, entity, true);
+
+    if (is_shared) append(&builder, " -shared");
+
+    format(&builder, " -o\"%S\"", entity->file_path);
+
+    String link_flags = to_allocated_string(&builder, alloc);
+    DEFER(destroy(&link_flags));
+
+    String libraries = quoted_files(entity->libraries, alloc);
+    DEFER(destroy(&libraries));
+
+    String arguments[] = {link_flags, objects, libraries};
+
+    s32 command = add_build_command(entity, COMMAND_LINK, "clang", {arguments, 3}, response_file);
+    add_link_command_files(entity, command, object_files);
+
+    add_debug_package_command(alloc, entity, command, "llvm-dwp", object_files);
+}
+
+
+// NOTE: Just enough JSON to read the trace events written by -ftime-trace.
+struct JsonReader {
+    String text;
+    s64 pos;
+    b32 error;
+};
+
+INTERNAL void skip_json_whitespace(JsonReader *reader) {
+    while (reader->pos < reader->text.size) {
+        u8 c = reader->text[reader->pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+
+        reader->pos += 1;
+    }
+}
+
+INTERNAL b32 match_json_char(JsonReader *reader, u8 c) {
+    skip_json_whitespace(reader);
+
+    if (reader->pos < reader->text.size && reader->text[reader->pos] == c) {
+        reader->pos += 1;
+        return true;
+    }
+
+    return false;
+}
+
+// NOTE: Escape sequences are kept as they are. Paths on windows will have double backslashes.
+INTERNAL String read_json_string(JsonReader *reader) {
+    if (!match_json_char(reader, '"')) {
+        reader->error = true;
+        return {};
+    }
+
+    s64 start = reader->pos;
+    while (reader->pos < reader->text.size) {
+        u8 c = reader->text[reader->pos];
+        if (c == '\\') {
+            reader->pos += 2;
+            continue;
+        }
+        if (c == '"') break;
+
+        reader->pos += 1;
+    }
+
+    if (reader->pos >= reader->text.size) {
+        reader->error = true;
+        return {};
+    }
+
+    String result = String(reader->text.data + start, reader->pos - start);
+    reader->pos += 1;
+
+    return result;
+}
+
+INTERNAL s64 read_json_integer(JsonReader *reader) {
+    skip_json_whitespace(reader);
+
+    s64 result = 0;
+    b32 negative = match_json_char(reader, '-');
+    while (reader->pos < reader->text.size) {
+        u8 c = reader->text[reader->pos];
+        if (c < '0' || c > '9') break;
+
+        result = result * 10 + (c - '0');
+        reader->pos += 1;
+    }
+
+    // NOTE: Fractions are not needed, durations are whole microseconds.
+    while (reader->pos < reader->text.size) {
+        u8 c = reader->text[reader->pos];
+        if (c != '.' && c != 'e' && c != 'E' && c != '+' && c != '-' && (c < '0' || c > '9')) break;
+
+        reader->pos += 1;
+    }
+
+    return negative ? -result : result;
+}
+
+INTERNAL void skip_json_value(JsonReader *reader) {
+    skip_json_whitespace(reader);
+    if (reader->pos >= reader->text.size) {
+        reader->error = true;
+        return;
+    }
+
+    u8 c = reader->text[reader->pos];
+    if (c == '"') {
+        read_json_string(reader);
+    } else if (c == '{' || c == '[') {
+        u8 close = c == '{' ? '}' : ']';
+        reader->pos += 1;
+
+        if (match_json_char(reader, close)) return;
+
+        do {
+            if (close == '}') {
+                read_json_string(reader);
+                if (!match_json_char(reader, ':')) reader->error = true;
+            }
+            skip_json_value(reader);
+        } while (!reader->error && match_json_char(reader, ','));
+
+        if (!match_json_char(reader, close)) reader->error = true;
+    } else {
+        // NOTE: Numbers, true, false and null.
+        while (reader->pos < reader->text.size) {
+            c = reader->text[reader->pos];
+            if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t') break;
+
+            reader->pos += 1;
+        }
+    }
+}
+
+struct TraceEvent {
+    String name;
+    String detail;
+    s64 duration;
+};
+
+INTERNAL b32 read_trace_event(JsonReader *reader, TraceEvent *event) {
+    *event = {};
+
+    if (!match_json_char(reader, '{')) return false;
+    if (match_json_char(reader, '}')) return true;
+
+    do {
+        String key = read_json_string(reader);
+        if (!match_json_char(reader, ':')) reader->error = true;
+        if (reader->error) return false;
+
+        if (key == "name") {
+            event->name = read_json_string(reader);
+        } else if (key == "dur") {
+            event->duration = read_json_integer(reader);
+        } else if (key == "args") {
+            if (!match_json_char(reader, '{')) return false;
+            if (match_json_char(reader, '}')) continue;
+
+            do {
+                String arg = read_json_string(reader);
+                if (!match_json_char(reader, ':')) reader->error = true;
+                if (reader->error) return false;
+
+                if (arg == "detail") {
+                    event->detail = read_json_string(reader);
+                } else {
+                    skip_json_value(reader);
+                }
+            } while (!reader->error && match_json_char(reader, ','));
+
+            if (!match_json_char(reader, '}')) reader->error = true;
+        } else {
+            skip_json_value(reader);
+        }
+    } while (!reader->error && match_json_char(reader, ','));
+
+    if (!match_json_char(reader, '}')) reader->error = true;
+
+    return !reader->error;
+}
+
+
+enum TraceCategory {
+    TRACE_HEADERS,
+    TRACE_TEMPLATES,
+    TRACE_FUNCTIONS,
+
+    TRACE_CATEGORY_COUNT,
+};
+
+struct TraceTotal {
+    String detail;
+    s64 duration;
+    s32 count;
+};
+
+struct TraceReport {
+    HashTable<String, TraceTotal> totals[TRACE_CATEGORY_COUNT];
+    s32 file_count;
+};
+
+INTERNAL void add_trace_event(TraceReport *report, TraceCategory category, TraceEvent *event) {
+    if (event->detail.size == 0) return;
+
+    TraceTotal *total = find(&report->totals[category], event->detail);
+    if (!total) {
+        TraceTotal empty = {};
+        empty.detail = allocate_string(event->detail, DefaultAllocator);
+
+        insert(&report->totals[category], empty.detail, empty);
+        total = find(&report->totals[category], empty.detail);
+    }
+
+    total->duration += event->duration;
+    total->count    += 1;
+}
+
+INTERNAL void read_trace_file(TraceReport *report, String file) {
+    auto read_result = platform_read_entire_file(file);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return;
+
+    JsonReader reader = {};
+    reader.text = read_result.content;
+
+    if (!match_json_char(&reader, '{')) return;
+
+    do {
+        String key = read_json_string(&reader);
+        if (!match_json_char(&reader, ':')) return;
+
+        if (key != "traceEvents") {
+            skip_json_value(&reader);
+            continue;
+        }
+
+        if (!match_json_char(&reader, '[')) return;
+        if (match_json_char(&reader, ']')) continue;
+
+        do {
+            TraceEvent event;
+            if (!read_trace_event(&reader, &event)) return;
+
+            if (event.name == "Source") {
+                add_trace_event(report, TRACE_HEADERS, &event);
+            } else if (event.name == "InstantiateClass" || event.name == "InstantiateFunction") {
+                add_trace_event(report, TRACE_TEMPLATES, &event);
+            } else if (event.name == "CodeGen Function" || event.name == "OptFunction") {
+                add_trace_event(report, TRACE_FUNCTIONS, &event);
+            }
+        } while (match_json_char(&reader, ','));
+
+        if (!match_json_char(&reader, ']')) return;
+    } while (!reader.error && match_json_char(&reader, ','));
+
+    report->file_count += 1;
+}
+
+INTERNAL void destroy(TraceReport *report) {
+    for (s32 i = 0; i < TRACE_CATEGORY_COUNT; i += 1) {
+        auto *table = &report->totals[i];
+
+        for (s64 j = 0; j < table->alloc; j += 1) {
+            if (table->entries[j].hash) destroy(&table->entries[j].value.detail);
+        }
+
+        destroy(table);
+    }
+}
+
+INTERNAL int compare_trace_totals(void const *a, void const *b) {
+    s64 lhs = ((TraceTotal const*)a)->duration;
+    s64 rhs = ((TraceTotal const*)b)->duration;
+
+    if (lhs < rhs) return  1;
+    if (lhs > rhs) return -1;
+
+    return 0;
+}
+
+INTERNAL void write_trace_category(StringBuilder *builder, TraceReport *report, TraceCategory category, String title, s32 limit) {
+    List<TraceTotal> sorted = {};
+    DEFER(destroy(&sorted));
+
+    auto *table = &report->totals[category];
+    for (s64 i = 0; i < table->alloc; i += 1) {
+        auto *entry = &table->entries[i];
+        if (entry->hash == 0) continue;
+
+        append(&sorted, entry->value);
+    }
+
+    if (sorted.size) qsort(sorted.data, sorted.size, sizeof(TraceTotal), compare_trace_totals);
+
+    format(builder, "%S:\n", title);
+    for (s64 i = 0; i < sorted.size && i < limit; i += 1) {
+        TraceTotal *total = &sorted[i];
+        format(builder, "  %d ms (%d times) %S\n", (s32)(total->duration / 1000), total->count, total->detail);
+    }
+    append(builder, "\n");
+}
+
+// NOTE: Merges the -ftime-trace output of all translation units into one report.
+INTERNAL void clang_finish_build(Array<Entity*> entities) {
+    if (!create_profile()) return;
+
+    TraceReport report = {};
+    DEFER(destroy(&report));
+
+    FOR (entities, it) {
+        Entity *entity = *it;
+        if (entity->status != ENTITY_STATUS_READY) continue;
+
+        FOR (entity->build_commands, command) {
+            if (command->kind != COMMAND_COMPILE) continue;
+
+            FOR (command->outputs, output) {
+                if (is_time_trace(*output)) read_trace_file(&report, *output);
+            }
+        }
+    }
+
+    if (report.file_count == 0) {
+        print("No clang time traces found. -ftime-trace needs clang 9 or later.\n");
+        return;
+    }
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "Clang time trace of %d translation units.\n\n", report.file_count);
+    write_trace_category(&builder, &report, TRACE_HEADERS,   "Slowest headers (including nested ones)", 25);
+    write_trace_category(&builder, &report, TRACE_TEMPLATES, "Slowest template instantiations", 25);
+    write_trace_category(&builder, &report, TRACE_FUNCTIONS, "Slowest functions (code generation and optimization)", 25);
+
+    String report_file = t_format("%S/clang_time_trace.txt", App.build_files_folder);
+    PlatformFile file = platform_file_open(report_file, PlatformFileOverride);
+    if (file.open) {
+        write_builder_to_file(&builder, &file);
+        platform_file_close(&file);
+
+        print("Wrote clang time trace report to %S.\n", report_file);
+    } else {
+        print("Could not write clang time trace report to %S.\n", report_file);
+    }
+}
+
+// NOTE: Like distcc, the source is preprocessed locally, which also writes the depfile, and the
+//       worker compiles the preprocessed source with the same options. The debug info names the
+//       workspace . like local compiles do, not the folder the worker compiled in.
+INTERNAL b32 clang_remote_compile(Allocator alloc, Entity *entity, BuildCommand *command, RemoteCompile *remote) {
+    if (command->kind != COMMAND_COMPILE || command->inputs.size != 1) return false;
+
+    // NOTE: The object and the depfile. The worker and the caches only bring back the object,
+    //       .dwo files of split debug info stay local.
+    if (command->outputs.size != (command->depfile != "" ? 2 : 1)) return false;
+
+    // NOTE: Profiles and time traces are read and written next to the objects, the worker has neither.
+    if (entity->pgo != PGO_NONE || create_profile()) return false;
+
+    String source = command->inputs[0];
+    String object = command->outputs[0];
+
+    b32 is_c = source.size > 2 && source[source.size - 2] == '.' && source[source.size - 1] == 'c';
+    String extension = is_c ? String("i") : String("ii");
+
+    remote->source      = format(alloc, "%S.%S", object, extension);
+    remote->source_name = format(alloc, "source.%S", extension);
+    remote->object      = allocate_string(object, alloc);
+    remote->object_name = allocate_string("object.o", alloc);
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    // NOTE: -MD, the cache manifest has to list system headers too, another version of a library
+    //       changes the object as well.
+    append(&builder, "clang -E");
+    append_compile_flags(&builder, entity, true);
+    format(&builder, " -MD -MF \"%S\" -MT \"%S\" -o\"%S\" \"%S\"", command->depfile, object, remote->source, source);
+
+    remote->preprocess = to_allocated_string(&builder, alloc);
+
+    reset(&builder);
+    append(&builder, "clang -c");
+    append_compile_flags(&builder, entity, false);
+    format(&builder, " -fdebug-compilation-dir=. -o\"%S\" \"%S\"", remote->object_name, remote->source_name);
+
+    remote->compile = to_allocated_string(&builder, alloc);
+
+    return true;
+}
+
+Compiler load_clang() {
+    Compiler result = {};
+    result.name  = "clang";
+    result.generate_commands   = clang_build_command;
+    result.process_diagnostics = process_diagnostics;
+    result.finish_build        = clang_finish_build;
+    result.merge_profiles      = clang_merge_profiles;
+    result.parse_depfile       = parse_make_depfile;
+    result.remote_compile      = clang_remote_compile;
+
+    return result;
+}
+
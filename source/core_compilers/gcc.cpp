@@ -1,5 +1,6 @@
 #include "blueprint.h"
 #include "bricks.h"
+#include "core_compilers.h"
 #include "string_builder.h"
 #include "io.h"
 
@@ -187,56 +188,325 @@ INTERNAL void msvc_build_command(Allocator alloc, Blueprint *blueprint, Entity *
 }
 */
 
+void parse_make_depfile(Entity *entity, String content, List<String> *dependencies) {
+    // NOTE: Skip the target. Drive letters are followed by a slash, not by a space.
+    s64 i = 0;
+    while (i + 1 < content.size) {
+        u8 next = content[i + 1];
+        if (content[i] == ':' && (next == ' ' || next == '\t' || next == '\n' || next == '\r')) break;
+
+        i += 1;
+    }
+    i += 1;
+
+    StringBuilder file = {};
+    DEFER(destroy(&file));
+    s64 file_size = 0;
+
+    for (; i <= content.size; i += 1) {
+        u8 c = i < content.size ? content[i] : ' ';
+
+        if (c == '\\' && i + 1 < content.size) {
+            u8 next = content[i + 1];
+
+            // NOTE: Line continuation.
+            if (next == '\n' || next == '\r') {
+                i += 1;
+                continue;
+            }
+
+            // NOTE: Escaped spaces in file names.
+            if (next == ' ' || next == '#') {
+                append(&file, (char)next);
+                file_size += 1;
+
+                i += 1;
+                continue;
+            }
+        }
+
+        if (c == '$' && i + 1 < content.size && content[i + 1] == '$') {
+            append(&file, '$');
+            file_size += 1;
+
+            i += 1;
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (file_size) append(dependencies, to_allocated_string(&file, DefaultAllocator));
+
+            reset(&file);
+            file_size = 0;
+        } else {
+            append(&file, (char)c);
+            file_size += 1;
+        }
+    }
+}
+
+b32 uses_split_dwarf(Entity *entity) {
+    return entity->debug_info == DEBUG_INFO_SPLIT && entity->lto == LTO_NONE && entity->config->target_info.platform != "win32";
+}
+
+// NOTE: gcc and clang replace the extension of the object.
+String split_dwarf_file(String object, Allocator alloc) {
+    String name = object;
+    if (name.size > 2 && name[name.size - 2] == '.' && name[name.size - 1] == 'o') name = shrink_back(name, 2);
+
+    return format(alloc, "%S.dwo", name);
+}
+
+// NOTE: Comes after the options, so a -g there is overridden by -g1.
+void append_debug_info_flags(StringBuilder *builder, Entity *entity, b32 link) {
+    if (link) {
+        // NOTE: The linker compresses the debug sections again, also the ones of uncompressed libraries.
+        if (entity->debug_info == DEBUG_INFO_COMPRESSED) append(builder, " -gz");
+        return;
+    }
+
+    switch (entity->debug_info) {
+    case DEBUG_INFO_DEFAULT: break;
+
+    case DEBUG_INFO_SPLIT: {
+        append(builder, uses_split_dwarf(entity) ? " -g -gsplit-dwarf" : " -g");
+    } break;
+
+    case DEBUG_INFO_COMPRESSED: append(builder, " -g -gz"); break;
+    case DEBUG_INFO_MINIMAL:    append(builder, " -g1");    break;
+    }
+}
+
+void add_debug_package_command(Allocator alloc, Entity *entity, s32 link_command, String dwp, Array<String> object_files) {
+    if (!entity->debug_package || !uses_split_dwarf(entity)) return;
+
+    String file_path = entity->file_path;
+    String package   = format(alloc, "%S.dwp", file_path);
+
+    // NOTE: -e reads the names of the .dwo files from the skeleton units in the file.
+    String arguments[] = {t_format(" -e \"%S\" -o \"%S\"", file_path, package)};
+
+    s32 command = add_build_command(entity, COMMAND_CUSTOM, dwp, {arguments, 1}, "");
+    add_command_dependency(entity, command, link_command);
+
+    add_command_input(entity, command, file_path);
+    FOR (object_files, object) {
+        add_command_input(entity, command, split_dwarf_file(*object, alloc));
+    }
+
+    add_command_output(entity, command, package);
+}
+
+// NOTE: The default linker is used if the blueprint doesn't name one.
+INTERNAL b32 append_linker(StringBuilder *builder, Entity *entity) {
+    String linker = entity->linker;
+    s32 threads = link_thread_count();
+
+    if (linker == "" || linker == "gcc") return true;
+
+    if (linker == "mold") {
+        format(builder, " -fuse-ld=mold -Wl,--thread-count=%d", threads);
+    } else if (linker == "lld") {
+        format(builder, " -fuse-ld=lld -Wl,--threads=%d", threads);
+    } else if (linker == "gold") {
+        format(builder, " -fuse-ld=gold -Wl,--threads -Wl,--thread-count=%d", threads);
+    } else if (linker == "bfd") {
+        append(builder, " -fuse-ld=bfd");
+    } else {
+        add_diagnostic(entity, DIAG_ERROR, t_format("Unknown linker %S for %S. Supported are mold, lld, gold and bfd.", linker, entity->name));
+        entity->status = ENTITY_STATUS_ERROR;
+
+        return false;
+    }
+
+    return true;
+}
+
+// NOTE: Profile flags are needed by compile and link commands, the link pulls in gcov.
+INTERNAL void append_pgo_flags(StringBuilder *builder, Entity *entity) {
+    if (entity->pgo == PGO_GENERATE) {
+        format(builder, " -fprofile-generate=\"%S\"", entity->pgo_folder);
+    } else if (entity->pgo == PGO_USE) {
+        // NOTE: Sources the training did not reach have no profile.
+        format(builder, " -fprofile-use=\"%S\" -Wno-missing-profile", entity->pgo_folder);
+    }
+}
+
+// NOTE: gcc has no thin lto. Thin uses the default partitioning and optimizes the partitions
+//       in parallel, full puts the whole program into one partition.
+INTERNAL void append_link_lto_flags(StringBuilder *builder, Entity *entity) {
+    if (entity->lto == LTO_THIN) {
+        format(builder, " -flto=%d", link_thread_count());
+    } else if (entity->lto == LTO_FULL) {
+        append(builder, " -flto -flto-partition=one");
+    }
+}
+
+// NOTE: Without the preprocessor flags for compiling an already preprocessed source.
+INTERNAL void append_compile_flags(StringBuilder *builder, Entity *entity, b32 preprocess) {
+    append_arguments(builder, entity->options, "", false);
+
+    if (preprocess) {
+        append_arguments(builder, entity->symbols, "-D", false);
+        append_arguments(builder, entity->include_folders, "-I", true);
+    }
+
+    // NOTE: Debug info and __FILE__ name the files in the workspace relative to it, so objects are
+    //       the same in every checkout.
+    format(builder, " -ffile-prefix-map=\"%S\"=.", workspace_folder());
+
+    if (entity->kind == ENTITY_LIBRARY && entity->lib_kind == SHARED_LIBRARY) append(builder, " -fPIC");
+    append_debug_info_flags(builder, entity, false);
+    if (entity->lto != LTO_NONE) append(builder, " -flto");
+    append_pgo_flags(builder, entity);
+}
+
 INTERNAL void gcc_build_command(Allocator alloc, Blueprint *blueprint, Entity *entity) {
     SCOPE_TEMP_STORAGE();
 
     if (entity->status == ENTITY_STATUS_READY) return;
     if (entity->status == ENTITY_STATUS_ERROR) return;
 
+    if (entity->kind != ENTITY_EXECUTABLE && entity->kind != ENTITY_LIBRARY) {
+        add_diagnostic(entity, DIAG_ERROR, t_format("Can only build Executables and Libraries. (entity: %S)\n", entity->name));
+        return;
+    }
+
+    if (entity->sources.size == 0) {
+        add_diagnostic(entity, DIAG_ERROR, t_format("%S has no source file(s) to build.", entity->name));
+        // TODO: Maybe don't error and just report it?
+        //       So the build can finish if this entity is unused.
+        entity->status = ENTITY_STATUS_ERROR;
+        return;
+    }
+
+    String prefix = entity->config->target_info.tool_prefix;
+    String gcc    = t_format("%Sgcc", prefix);
+    b32 is_shared = entity->kind == ENTITY_LIBRARY && entity->lib_kind == SHARED_LIBRARY;
+
     StringBuilder builder = {};
     DEFER(destroy(&builder));
 
-    if (entity->kind == ENTITY_EXECUTABLE) {
-        if (entity->sources.size == 0) {
-            add_diagnostic(entity, DIAG_ERROR, t_format("Executable %S has no source file(s) to build.", entity->name));
-            // TODO: Maybe don't error and just report it?
-            //       So the build can finish if this entity is unused.
-            entity->status = ENTITY_STATUS_ERROR;
-            return;
-        }
+    List<String> object_files = {};
+    DEFER(destroy(&object_files));
 
-        append(&builder, "gcc");
+    get_object_files(entity, "o", &object_files);
 
-        FOR (entity->options, option) {
-            append(&builder, ' ');
-            append(&builder, *option);
-        }
+    // NOTE: Everything but the files is the same for all sources, so it is only built once.
+    append(&builder, " -c");
+    append_compile_flags(&builder, entity, true);
 
-        FOR (entity->symbols, symbol) {
-            format(&builder, " -D%S", *symbol);
-        }
+    String compile_flags = to_allocated_string(&builder, alloc);
+    DEFER(destroy(&compile_flags));
 
-        FOR (entity->include_folders, dir) {
-            format(&builder, " -I%S", *dir);
-        }
+    // NOTE: One command per source, so they can be compiled in parallel.
+    for (s64 i = 0; i < entity->sources.size; i += 1) {
+        String depfile = format(alloc, "%S.d", object_files[i]);
 
-        format(&builder, " -o%S", entity->file_path); // NOTE: /Fe -> executable name
-        // TODO: Intermediate folder for objects if necessary.
+        String arguments[] = {
+            compile_flags,
+            t_format(" -MMD -MF \"%S\" -o\"%S\" \"%S\"", depfile, object_files[i], entity->sources[i]),
+        };
 
-        FOR (entity->sources, source) {
-            format(&builder, " \"%S\"", *source);
-        }
+        s32 command = add_build_command(entity, COMMAND_COMPILE, gcc, {arguments, 2}, t_format("%S.rsp", object_files[i]));
+        add_command_input  (entity, command, entity->sources[i]);
+        add_command_output (entity, command, object_files[i]);
+        set_command_depfile(entity, command, depfile);
 
-        FOR (entity->libraries, lib) {
-            format(&builder, " \"%S\"", *lib);
-        }
+        if (uses_split_dwarf(entity)) add_command_output(entity, command, split_dwarf_file(object_files[i], alloc));
+    }
 
-        add_build_command(entity, &builder);
-    } else if (entity->kind == ENTITY_LIBRARY) {
-        add_diagnostic(entity, DIAG_ERROR, "Can't build libs.");
-    } else {
-        add_diagnostic(entity, DIAG_ERROR, t_format("Can only build Executables and Libraries. (entity: %S)\n", entity->name));
+    String objects = quoted_files(object_files, alloc);
+    DEFER(destroy(&objects));
+
+    String response_file = t_format("%S%S.rsp", entity->intermediate_folder, entity->name);
+
+    if (entity->kind == ENTITY_LIBRARY && !is_shared) {
+        // NOTE: ar replaces the members of an existing archive. gcc-ar loads the lto plugin
+        //       so the archive gets an index of the lto objects.
+        String archiver = t_format("%S%S", prefix, entity->lto != LTO_NONE ? String("gcc-ar") : String("ar"));
+
+        // NOTE: D leaves out timestamps, so an archive of the same objects is the same file.
+        String arguments[] = {t_format(" rcsD \"%S\"", entity->file_path), objects};
+
+        s32 command = add_build_command(entity, COMMAND_ARCHIVE, archiver, {arguments, 2}, response_file);
+        add_link_command_files(entity, command, object_files);
+        return;
     }
+
+    reset(&builder);
+
+    append_arguments(&builder, entity->options, "", false);
+
+    if (!append_linker(&builder, entity)) return;
+
+    append_link_lto_flags(&builder, entity);
+    append_pgo_flags(&builder, entity);
+    append_debug_info_flags(&builder, entity, true);
+
+    if (is_shared) append(&builder, " -shared");
+
+    format(&builder, " -o\"%S\"", entity->file_path);
+
+    String link_flags = to_allocated_string(&builder, alloc);
+    DEFER(destroy(&link_flags));
+
+    String libraries = quoted_files(entity->libraries, alloc);
+    DEFER(destroy(&libraries));
+
+    String arguments[] = {link_flags, objects, libraries};
+
+    s32 command = add_build_command(entity, COMMAND_LINK, gcc, {arguments, 3}, response_file);
+    add_link_command_files(entity, command, object_files);
+
+    add_debug_package_command(alloc, entity, command, t_format("%Sdwp", prefix), object_files);
+}
+
+// NOTE: Like distcc, the source is preprocessed locally, which also writes the depfile, and the
+//       worker compiles the preprocessed source with the same options. The worker maps the folder
+//       it compiles in to . in the debug info, see run_worker.
+INTERNAL b32 gcc_remote_compile(Allocator alloc, Entity *entity, BuildCommand *command, RemoteCompile *remote) {
+    if (command->kind != COMMAND_COMPILE || command->inputs.size != 1) return false;
+
+    // NOTE: The object and the depfile. The worker and the caches only bring back the object,
+    //       .dwo files of split debug info stay local.
+    if (command->outputs.size != (command->depfile != "" ? 2 : 1)) return false;
+
+    // NOTE: Profiles are read and written next to the objects, the worker has neither.
+    if (entity->pgo != PGO_NONE) return false;
+
+    String source = command->inputs[0];
+    String object = command->outputs[0];
+
+    b32 is_c = source.size > 2 && source[source.size - 2] == '.' && source[source.size - 1] == 'c';
+    String extension = is_c ? String("i") : String("ii");
+
+    String gcc = t_format("%Sgcc", entity->config->target_info.tool_prefix);
+
+    remote->source      = format(alloc, "%S.%S", object, extension);
+    remote->source_name = format(alloc, "source.%S", extension);
+    remote->object      = allocate_string(object, alloc);
+    remote->object_name = allocate_string("object.o", alloc);
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    // NOTE: -MD, the cache manifest has to list system headers too, another version of a library
+    //       changes the object as well.
+    format(&builder, "%S -E", gcc);
+    append_compile_flags(&builder, entity, true);
+    format(&builder, " -MD -MF \"%S\" -MT \"%S\" -o\"%S\" \"%S\"", command->depfile, object, remote->source, source);
+
+    remote->preprocess = to_allocated_string(&builder, alloc);
+
+    reset(&builder);
+    format(&builder, "%S -c", gcc);
+    append_compile_flags(&builder, entity, false);
+    format(&builder, " -o\"%S\" \"%S\"", remote->object_name, remote->source_name);
+
+    remote->compile = to_allocated_string(&builder, alloc);
+
+    return true;
 }
 
 Compiler load_gcc() {
@@ -244,6 +514,8 @@ Compiler load_gcc() {
     result.name  = "gcc";
     result.generate_commands   = gcc_build_command;
     result.process_diagnostics = process_diagnostics;
+    result.parse_depfile       = parse_make_depfile;
+    result.remote_compile      = gcc_remote_compile;
 
     return result;
 }
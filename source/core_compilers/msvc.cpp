@@ -71,108 +71,223 @@ INTERNAL void process_diagnostics(Entity *entity, String output) {
     }
 }
 
+// NOTE: Reads the Includes of the json written by /sourceDependencies.
+INTERNAL void msvc_parse_depfile(Entity *entity, String content, List<String> *dependencies) {
+    String key = "\"Includes\"";
+
+    s64 pos = -1;
+    for (s64 i = 0; i + key.size <= content.size; i += 1) {
+        if (String(content.data + i, key.size) == key) {
+            pos = i + key.size;
+            break;
+        }
+    }
+    if (pos == -1) return;
+
+    while (pos < content.size && content[pos] != '[') pos += 1;
+
+    StringBuilder file = {};
+    DEFER(destroy(&file));
+
+    b32 in_string = false;
+    for (pos += 1; pos < content.size; pos += 1) {
+        u8 c = content[pos];
+
+        if (!in_string) {
+            if (c == ']') break;
+            if (c == '"') in_string = true;
+
+            continue;
+        }
+
+        if (c == '\\' && pos + 1 < content.size) {
+            pos += 1;
+            append(&file, (char)content[pos]);
+        } else if (c == '"') {
+            append(dependencies, to_allocated_string(&file, DefaultAllocator));
+            reset(&file);
+
+            in_string = false;
+        } else {
+            append(&file, (char)c);
+        }
+    }
+}
+
+// NOTE: Debug information is only linked if the sources were compiled with it.
+INTERNAL b32 has_debug_info(Entity *entity) {
+    if (entity->debug_info != DEBUG_INFO_DEFAULT) return true;
+
+    FOR (entity->options, option) {
+        if (*option == "/Zi" || *option == "-Zi" || *option == "/Z7" || *option == "-Z7" || *option == "/ZI" || *option == "-ZI") return true;
+    }
+
+    return false;
+}
+
+// NOTE: Profile guided optimization needs link time code generation as well.
+INTERNAL b32 uses_ltcg(Entity *entity) {
+    return entity->lto != LTO_NONE || entity->pgo != PGO_NONE;
+}
+
+// NOTE: Sets the linker program and appends the options that depend on it.
+INTERNAL b32 append_linker(StringBuilder *builder, Entity *entity, String *program) {
+    String linker = entity->linker;
+
+    if (linker == "" || linker == "msvc" || linker == "link") {
+        *program = "link";
+        append(builder, " /NOLOGO");
+
+        if (uses_ltcg(entity)) {
+            // NOTE: Thin lto maps to incremental code generation, full lto and pgo to the full one.
+            if (entity->lto == LTO_THIN && entity->pgo == PGO_NONE) {
+                append(builder, " /LTCG:INCREMENTAL");
+            } else {
+                append(builder, " /LTCG");
+            }
+
+            // NOTE: link does not use more than 8 code generation threads.
+            s32 threads = link_thread_count();
+            if (threads > 8) threads = 8;
+            format(builder, " /CGTHREADS:%d", threads);
+        }
+
+        // NOTE: The pgd name defaults to the executable name, so it is given explicitly.
+        String pgd = t_format("%S/%S.pgd", entity->pgo_folder, entity->name);
+        if (entity->pgo == PGO_GENERATE) format(builder, " /GENPROFILE:PGD=\"%S\"", pgd);
+        if (entity->pgo == PGO_USE)      format(builder, " /USEPROFILE:PGD=\"%S\"", pgd);
+    } else if (linker == "lld") {
+        // NOTE: Objects compiled with /GL can only be read by link.
+        if (uses_ltcg(entity)) {
+            add_diagnostic(entity, DIAG_ERROR, t_format("%S uses lto or pgo, which lld-link does not support with msvc objects.", entity->name));
+            entity->status = ENTITY_STATUS_ERROR;
+
+            return false;
+        }
+
+        *program = "lld-link";
+        format(builder, " /NOLOGO /threads:%d", link_thread_count());
+    } else {
+        add_diagnostic(entity, DIAG_ERROR, t_format("Unknown linker %S for %S. Supported are msvc and lld.", linker, entity->name));
+        entity->status = ENTITY_STATUS_ERROR;
+
+        return false;
+    }
+
+    return true;
+}
+
 INTERNAL void msvc_build_command(Allocator alloc, Blueprint *blueprint, Entity *entity) {
     SCOPE_TEMP_STORAGE();
 
     if (entity->status == ENTITY_STATUS_READY) return;
     if (entity->status == ENTITY_STATUS_ERROR) return;
 
+    if (entity->kind != ENTITY_EXECUTABLE && entity->kind != ENTITY_LIBRARY) {
+        add_diagnostic(entity, DIAG_ERROR, t_format("Can only build Executables and Libraries. (entity: %S)\n", entity->name));
+        return;
+    }
+
+    if (entity->sources.size == 0) {
+        add_diagnostic(entity, DIAG_ERROR, t_format("%S has no source file(s) to build.", entity->name));
+        // TODO: Maybe don't error and just report it?
+        //       So the build can finish if this entity is unused.
+        entity->status = ENTITY_STATUS_ERROR;
+        return;
+    }
+
     StringBuilder builder = {};
     DEFER(destroy(&builder));
 
-    if (entity->kind == ENTITY_EXECUTABLE) {
-        if (entity->sources.size == 0) {
-            add_diagnostic(entity, DIAG_ERROR, t_format("Executable %S has no source file(s) to build.", entity->name));
-            // TODO: Maybe don't error and just report it?
-            //       So the build can finish if this entity is unused.
-            entity->status = ENTITY_STATUS_ERROR;
-            return;
-        }
+    List<String> object_files = {};
+    DEFER(destroy(&object_files));
 
-        append(&builder, "cl /nologo /permissive- /W2");
+    get_object_files(entity, "obj", &object_files);
 
-        FOR (entity->options, option) {
-            append(&builder, ' ');
-            append(&builder, *option);
-        }
+    b32 is_static = entity->kind == ENTITY_LIBRARY && entity->lib_kind != SHARED_LIBRARY;
 
-        FOR (entity->symbols, symbol) {
-            format(&builder, " /D\"%S\"", *symbol);
-        }
+    // NOTE: Everything but the files is the same for all sources, so it is only built once.
+    //       /FS is needed because all of them write to the same pdb.
+    //       /Brepro leaves the timestamp out of the object, so the same source gives the same object,
+    //       and /pathmap writes paths in the workspace relative to it, wherever it is checked out.
+    append(&builder, " /nologo /permissive- /W2 /c /FS /Brepro");
+    format(&builder, " /pathmap:\"%S\"=.", workspace_folder());
+    append_arguments(&builder, entity->options, "", false);
+    append_arguments(&builder, entity->symbols, "/D", true);
+    append_arguments(&builder, entity->include_folders, "/I", true);
 
-        FOR (entity->include_folders, dir) {
-            format(&builder, " /I\"%S\"", *dir);
-        }
-
-        format(&builder, " /Fe\"%S\"", entity->file_path); // NOTE: /Fe -> executable name
-        format(&builder, " /Fo\"%S\"", entity->intermediate_folder); // NOTE: /Fo -> object file location, / means a folder for all files
+    if (uses_ltcg(entity)) append(&builder, " /GL");
 
-        {
-            String folder = path_without_filename(entity->file_path);
-            if (folder != "") format(&builder, " /Fd\"%S/\"", folder);
-        }
+    // NOTE: The debug_info field always gets a pdb, cl can't compress debug info or write only line
+    //       tables. For split the link references the debug info in the objects with /DEBUG:FASTLINK
+    //       instead of copying it, which is what split DWARF does for gcc and clang.
+    if (entity->debug_info != DEBUG_INFO_DEFAULT) append(&builder, " /Zi");
 
-        FOR (entity->sources, source) {
-            format(&builder, " \"%S\"", *source);
-        }
+    format(&builder, " /Fd\"%S\"", entity->intermediate_folder); // NOTE: / at the end means a folder for the pdb
 
-        append(&builder, " /link /SUBSYSTEM:CONSOLE /INCREMENTAL:NO");
+    String compile_flags = to_allocated_string(&builder, alloc);
+    DEFER(destroy(&compile_flags));
 
-        FOR (entity->libraries, lib) {
-            format(&builder, " \"%S\"", *lib);
-        }
+    // NOTE: One command per source, so they can be compiled in parallel.
+    for (s64 i = 0; i < entity->sources.size; i += 1) {
+        // NOTE: Needs Visual Studio 2019 16.7 or later.
+        String depfile = format(alloc, "%S.json", object_files[i]);
 
-        add_build_command(entity, &builder);
-    } else if (entity->kind == ENTITY_LIBRARY) {
-        // NOTE: Compiled object files need to be stored, sadly.
-        List<String> object_files = {};
-        DEFER(destroy(&object_files));
+        String arguments[] = {
+            compile_flags,
+            t_format(" /sourceDependencies \"%S\" /Fo\"%S\" \"%S\"", depfile, object_files[i], entity->sources[i]),
+        };
 
-        append(&builder, "cl /nologo /permissive- /W2 /c");
+        s32 command = add_build_command(entity, COMMAND_COMPILE, "cl", {arguments, 2}, t_format("%S.rsp", object_files[i]));
+        add_command_input  (entity, command, entity->sources[i]);
+        add_command_output (entity, command, object_files[i]);
+        set_command_depfile(entity, command, depfile);
+    }
 
-        FOR (entity->options, option) {
-            append(&builder, ' ');
-            append(&builder, *option);
-        }
+    String objects = quoted_files(object_files, alloc);
+    DEFER(destroy(&objects));
 
-        FOR (entity->symbols, symbol) {
-            format(&builder, " /D\"%S\"", *symbol);
-        }
+    String response_file = t_format("%S%S.rsp", entity->intermediate_folder, entity->name);
 
-        FOR (entity->include_folders, dir) {
-            format(&builder, " /I\"%S\"", *dir);
-        }
+    reset(&builder);
 
-        // TODO: Shared lib needs to be in the build folder.
-        format(&builder, " /Fo\"%S/\"", entity->intermediate_folder); // NOTE: /Fo -> object file location, / means a folder for all files
+    if (is_static) {
+        format(&builder, " /NOLOGO /Brepro /OUT:\"%S\"", entity->file_path);
+        if (uses_ltcg(entity)) append(&builder, " /LTCG");
 
-        {
-            format(&builder, " /Fd\"%S/\"", entity->intermediate_folder);
-        }
+        String lib_flags = to_allocated_string(&builder, alloc);
+        DEFER(destroy(&lib_flags));
 
-        FOR (entity->sources, source) {
-            format(&builder, " \"%S\"", *source);
+        String arguments[] = {lib_flags, objects};
 
-            String obj = format(alloc, "%S/%S.obj", entity->intermediate_folder, filename_without_extension(*source));
-            append(&object_files, obj);
-        }
+        s32 command = add_build_command(entity, COMMAND_ARCHIVE, "LIB", {arguments, 2}, response_file);
+        add_link_command_files(entity, command, object_files);
+        return;
+    }
 
-        add_build_command(entity, &builder);
-        reset(&builder);
+    String linker = {};
+    if (!append_linker(&builder, entity, &linker)) return;
 
-        format(&builder, "LIB /NOLOGO /OUT:\"%S\"", entity->file_path);
+    format(&builder, " /OUT:\"%S\" /SUBSYSTEM:CONSOLE /INCREMENTAL:NO", entity->file_path);
 
-        FOR (object_files, file) {
-            format(&builder, " \"%S\"", *file);
-            destroy(file);
-        }
+    if (entity->kind == ENTITY_LIBRARY) append(&builder, " /DLL");
 
-        add_build_command(entity, &builder);
-    } else {
-        add_diagnostic(entity, DIAG_ERROR, t_format("Can only build Executables and Libraries. (entity: %S)\n", entity->name));
+    if (entity->debug_info == DEBUG_INFO_SPLIT) {
+        append(&builder, " /DEBUG:FASTLINK");
+    } else if (has_debug_info(entity)) {
+        append(&builder, " /DEBUG");
     }
 
-    return;
+    String link_flags = to_allocated_string(&builder, alloc);
+    DEFER(destroy(&link_flags));
+
+    String libraries = quoted_files(entity->libraries, alloc);
+    DEFER(destroy(&libraries));
+
+    String arguments[] = {link_flags, objects, libraries};
+
+    s32 command = add_build_command(entity, COMMAND_LINK, linker, {arguments, 3}, response_file);
+    add_link_command_files(entity, command, object_files);
 }
 
 
@@ -181,6 +296,7 @@ Compiler load_msvc() {
     result.name  = "msvc";
     result.generate_commands   = msvc_build_command;
     result.process_diagnostics = process_diagnostics;
+    result.parse_depfile       = msvc_parse_depfile;
 
     return result;
 }
@@ -0,0 +1,318 @@
+#include "file_cache.h"
+
+#include "bricks.h"
+#include "platform.h"
+#include "binary.h"
+#include "io.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+INTERNAL void remember(FileCache *cache, String file, FileInfo info) {
+    CachedFileInfo cached = {};
+    cached.known = true;
+    cached.info  = info;
+
+    CachedFileInfo *existing = find(&cache->files, file);
+    if (existing) {
+        *existing = cached;
+    } else {
+        insert(&cache->files, allocate_string(file, DefaultAllocator), cached);
+    }
+}
+
+FileInfo get_file_info(FileCache *cache, String file) {
+    CachedFileInfo *cached = find(&cache->files, file);
+    if (cached && cached->known) {
+        cache->stat_hits += 1;
+        return cached->info;
+    }
+
+    FileInfo info = {};
+    platform_file_info(file, &info);
+    cache->stat_calls += 1;
+
+    remember(cache, file, info);
+
+    return info;
+}
+
+void prefetch_file_infos(FileCache *cache, Array<String> files) {
+    List<String> missing = {};
+    DEFER(destroy(&missing));
+
+    FOR (files, file) {
+        CachedFileInfo *cached = find(&cache->files, *file);
+        if (!cached || !cached->known) append(&missing, *file);
+    }
+
+    if (missing.size == 0) return;
+
+    FileInfo *infos = ALLOC(DefaultAllocator, FileInfo, missing.size);
+    DEFER(deallocate(DefaultAllocator, infos, sizeof(FileInfo) * missing.size));
+
+    cache->stat_calls += platform_file_infos(missing, infos);
+
+    for (s64 i = 0; i < missing.size; i += 1) remember(cache, missing[i], infos[i]);
+}
+
+b32 create_folders(FileCache *cache, String folder) {
+    folder = remove_trailing_slashes(folder);
+    if (folder == "") return true;
+
+    if (find(&cache->folders, folder)) {
+        cache->folder_hits += 1;
+        return true;
+    }
+
+    FileInfo info = get_file_info(cache, folder);
+    if (!info.exists) {
+        String parent = path_without_filename(folder);
+        if (parent != "" && !create_folders(cache, parent)) return false;
+
+        cache->folder_calls += 1;
+        if (!platform_create_folder(folder)) return false;
+
+        forget_file(cache, folder);
+    } else if (!info.is_folder) {
+        return false;
+    }
+
+    insert(&cache->folders, allocate_string(folder, DefaultAllocator), (b32)true);
+
+    return true;
+}
+
+INTERNAL int compare_entries(void const *a, void const *b) {
+    String name_a = ((FolderEntry const*)a)->name;
+    String name_b = ((FolderEntry const*)b)->name;
+
+    s64 size = name_a.size < name_b.size ? name_a.size : name_b.size;
+
+    int result = memcmp(name_a.data, name_b.data, size);
+    if (result != 0) return result;
+
+    if (name_a.size < name_b.size) return -1;
+    if (name_a.size > name_b.size) return  1;
+
+    return 0;
+}
+
+INTERNAL void destroy(FolderListing *listing) {
+    FOR (listing->entries, entry) destroy(entry);
+    destroy(&listing->entries);
+}
+
+Array<FolderEntry> list_folder(FileCache *cache, String folder) {
+    folder = remove_trailing_slashes(folder);
+    if (folder == "") folder = ".";
+
+    FolderListing *listing = find(&cache->listings, folder);
+    if (listing && listing->checked) return listing->entries;
+
+    FileInfo info = get_file_info(cache, folder);
+
+    // NOTE: A folder that changed in the same tick the listings were saved might have changed
+    //       after it was listed, file systems with coarse times would hide that.
+    if (listing && info.exists && info.time == listing->time && info.time < cache->listings_time) {
+        listing->checked = true;
+        return listing->entries;
+    }
+
+    if (!listing) {
+        insert(&cache->listings, allocate_string(folder, DefaultAllocator), FolderListing{});
+        listing = find(&cache->listings, folder);
+    }
+
+    destroy(listing);
+    listing->time    = info.time;
+    listing->checked = true;
+
+    cache->listings_changed = true;
+
+    if (!info.exists || !info.is_folder) return listing->entries;
+
+    cache->list_calls += 1;
+    platform_list_folder(folder, &listing->entries, DefaultAllocator);
+
+    if (listing->entries.size > 1) qsort(listing->entries.data, listing->entries.size, sizeof(FolderEntry), compare_entries);
+
+    return listing->entries;
+}
+
+#define FOLDER_LISTINGS_VERSION 1
+
+INTERNAL void write_listing_string(StringBuilder *builder, String str) {
+    write_binary(builder, (u32)str.size);
+    append(builder, str);
+}
+
+INTERNAL b32 read_listing_bytes(String content, s64 *offset, void *result, s64 size) {
+    if (*offset + size > content.size) return false;
+
+    memcpy(result, content.data + *offset, size);
+    *offset += size;
+
+    return true;
+}
+
+INTERNAL b32 read_listing_string(String content, s64 *offset, String *result) {
+    u32 size = 0;
+    if (!read_listing_bytes(content, offset, &size, sizeof(size))) return false;
+    if (*offset + size > content.size) return false;
+
+    *result = String(content.data + *offset, size);
+    *offset += size;
+
+    return true;
+}
+
+void load_folder_listings(FileCache *cache, String file) {
+    FileInfo info = get_file_info(cache, file);
+    if (!info.exists) return;
+
+    auto read_result = platform_read_entire_file(file);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return;
+
+    String content = read_result.content;
+    s64 offset = 0;
+
+    char magic[8] = {};
+    u32 version = 0;
+    if (!read_listing_bytes(content, &offset, magic, sizeof(magic)) || memcmp(magic, "BRICKDIR", 8) != 0) return;
+    if (!read_listing_bytes(content, &offset, &version, sizeof(version)) || version != FOLDER_LISTINGS_VERSION) return;
+
+    cache->listings_time = info.time;
+
+    // NOTE: A listing cut off at the end is dropped, it is listed again.
+    while (offset < content.size) {
+        String folder = {};
+        FolderListing listing = {};
+        u32 count = 0;
+
+        if (!read_listing_string(content, &offset, &folder)) break;
+        if (!read_listing_bytes(content, &offset, &listing.time, sizeof(listing.time))) break;
+        if (!read_listing_bytes(content, &offset, &count, sizeof(count))) break;
+
+        b32 complete = true;
+        for (u32 i = 0; i < count; i += 1) {
+            u8 is_folder = 0;
+            String name  = {};
+
+            if (!read_listing_bytes(content, &offset, &is_folder, sizeof(is_folder)) || !read_listing_string(content, &offset, &name)) {
+                complete = false;
+                break;
+            }
+
+            FolderEntry entry = {};
+            entry.name      = allocate_string(name, DefaultAllocator);
+            entry.is_folder = is_folder;
+
+            append(&listing.entries, entry);
+        }
+
+        if (!complete || find(&cache->listings, folder)) {
+            destroy(&listing);
+            break;
+        }
+
+        insert(&cache->listings, allocate_string(folder, DefaultAllocator), listing);
+    }
+}
+
+// NOTE: Only the folders this run looked at are kept, others belong to globs that are gone.
+void save_folder_listings(FileCache *cache, String file) {
+    b32 has_unused = false;
+    for (s64 i = 0; i < cache->listings.alloc; i += 1) {
+        auto *entry = &cache->listings.entries[i];
+        if (entry->hash && !entry->value.checked) has_unused = true;
+    }
+
+    if (!cache->listings_changed && !has_unused) return;
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    append(&builder, "BRICKDIR");
+    write_binary(&builder, (u32)FOLDER_LISTINGS_VERSION);
+
+    for (s64 i = 0; i < cache->listings.alloc; i += 1) {
+        auto *entry = &cache->listings.entries[i];
+        if (!entry->hash || !entry->value.checked) continue;
+
+        FolderListing *listing = &entry->value;
+
+        write_listing_string(&builder, entry->key);
+        write_binary(&builder, listing->time);
+        write_binary(&builder, (u32)listing->entries.size);
+
+        FOR (listing->entries, it) {
+            write_binary(&builder, (u8)(it->is_folder ? 1 : 0));
+            write_listing_string(&builder, it->name);
+        }
+    }
+
+    PlatformFile listings_file = platform_file_open(file, PlatformFileOverride);
+    if (!listings_file.open) return;
+
+    write_builder_to_file(&builder, &listings_file);
+    platform_file_close(&listings_file);
+
+    cache->listings_changed = false;
+}
+
+void forget_file(FileCache *cache, String file) {
+    CachedFileInfo *cached = find(&cache->files, file);
+    if (cached) cached->known = false;
+}
+
+void forget_all_files(FileCache *cache) {
+    for (s64 i = 0; i < cache->files.alloc; i += 1) {
+        auto *entry = &cache->files.entries[i];
+        if (entry->hash) entry->value.known = false;
+    }
+
+    for (s64 i = 0; i < cache->listings.alloc; i += 1) {
+        auto *entry = &cache->listings.entries[i];
+        if (entry->hash) entry->value.checked = false;
+    }
+
+    // NOTE: Folders are only deleted by hand, a build that fails because of it is fixed by running it again.
+    cache->stat_calls   = 0;
+    cache->stat_hits    = 0;
+    cache->folder_calls = 0;
+    cache->folder_hits  = 0;
+    cache->list_calls   = 0;
+}
+
+void print_file_cache_statistics(FileCache *cache) {
+    print("File system: %d stat calls, %d answered from the cache. Created %d folders, %d were known to exist. Listed %d folders.\n",
+          (s32)cache->stat_calls, (s32)cache->stat_hits, (s32)cache->folder_calls, (s32)cache->folder_hits, (s32)cache->list_calls);
+}
+
+void destroy(FileCache *cache) {
+    for (s64 i = 0; i < cache->files.alloc; i += 1) {
+        auto *entry = &cache->files.entries[i];
+        if (entry->hash) destroy(&entry->key);
+    }
+
+    for (s64 i = 0; i < cache->folders.alloc; i += 1) {
+        auto *entry = &cache->folders.entries[i];
+        if (entry->hash) destroy(&entry->key);
+    }
+
+    for (s64 i = 0; i < cache->listings.alloc; i += 1) {
+        auto *entry = &cache->listings.entries[i];
+        if (!entry->hash) continue;
+
+        destroy(&entry->key);
+        destroy(&entry->value);
+    }
+
+    destroy(&cache->files);
+    destroy(&cache->folders);
+    destroy(&cache->listings);
+}
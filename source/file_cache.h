@@ -0,0 +1,70 @@
+#pragma once
+
+#include "definitions.h"
+#include "hash_table.h"
+#include "string2.h"
+#include "file_system.h"
+
+
+// NOTE: Remembers what the build learned about the file system for the whole run, so the many
+//       commands reading the same headers or writing into the same folders only ask once. On
+//       network mounts every one of these calls is a round trip to the server.
+//       Files a command writes have to be forgotten once it finished, see forget_file.
+
+struct CachedFileInfo {
+    b32 known; // NOTE: Forgotten files keep their key, so it doesn't have to be allocated again.
+    FileInfo info;
+};
+
+struct FolderListing {
+    s64 time;    // NOTE: Modification time of the folder when it was listed.
+    b32 checked; // NOTE: Compared against the folder in this run.
+
+    List<FolderEntry> entries; // NOTE: Sorted by name.
+};
+
+struct FileCache {
+    // NOTE: Keys are allocated with the DefaultAllocator.
+    HashTable<String, CachedFileInfo> files;
+    HashTable<String, b32> folders; // NOTE: Folders that are known to exist.
+
+    // NOTE: Kept in .bricks between runs, see load_folder_listings.
+    HashTable<String, FolderListing> listings;
+    s64  listings_time; // NOTE: Modification time of the file they were loaded from.
+    b32  listings_changed;
+
+    // NOTE: Shown with bricks --profile.
+    s64 stat_calls;
+    s64 stat_hits;
+    s64 folder_calls;
+    s64 folder_hits;
+    s64 list_calls;
+};
+
+
+FileInfo get_file_info(FileCache *cache, String file);
+
+// NOTE: Looks up all files that aren't known yet at once, see platform_file_infos.
+void prefetch_file_infos(FileCache *cache, Array<String> files);
+
+// NOTE: Creates the folder and all folders above it that don't exist yet.
+b32 create_folders(FileCache *cache, String folder);
+
+// NOTE: Missing folders have no entries. The entries stay valid until the folder is listed again,
+//       which only happens after forget_all_files.
+Array<FolderEntry> list_folder(FileCache *cache, String folder);
+
+// NOTE: A folder's modification time changes when files are added to, removed from or renamed
+//       in it, so a loaded listing is only read again when that time changed. Checking costs
+//       one stat per folder instead of listing it.
+void load_folder_listings(FileCache *cache, String file);
+void save_folder_listings(FileCache *cache, String file);
+
+void forget_file(FileCache *cache, String file);
+
+// NOTE: Between builds of bricks --watch, files might have been changed by anyone.
+void forget_all_files(FileCache *cache);
+
+void print_file_cache_statistics(FileCache *cache);
+
+void destroy(FileCache *cache);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "definitions.h"
+#include "list.h"
+#include "array.h"
+#include "string2.h"
+
+
+// NOTE: File system functions that are missing from mountain's platform layer.
+//       Implemented in linux/file_system.cpp and win32/file_system.cpp.
+
+struct FolderEntry {
+    String name;
+    b32 is_folder;
+};
+
+struct FileInfo {
+    b32 exists;
+    b32 is_folder;
+
+    s64 time; // NOTE: Same as platform_file_time.
+    s64 size;
+};
+
+// NOTE: How platform_clone_file made the copy.
+enum FileCopyMethod {
+    FILE_COPY_REFLINK,  // NOTE: Shares the data until one of them is written, e.g. on btrfs and XFS.
+    FILE_COPY_HARDLINK, // NOTE: The same file under a second name.
+    FILE_COPY_BYTES,
+
+    FILE_COPY_METHOD_COUNT,
+};
+
+
+// NOTE: Names are allocated with alloc and don't include the folder.
+b32 platform_list_folder(String folder, List<FolderEntry> *entries, Allocator alloc);
+b32 platform_delete_file(String file);
+
+// NOTE: Replaces to if it exists. Readers see either the old or the new file, never a half written one.
+b32 platform_move_file(String from, String to);
+
+// NOTE: Copies from to to, which must not exist. Tries a reflink first, then a hard link if
+//       allow_link is set, and copies the bytes if neither works, e.g. across file systems.
+b32 platform_clone_file(String from, String to, b32 allow_link, FileCopyMethod *method);
+
+// NOTE: Sets the modification time to now. For a hard link that is the time of all its names.
+b32 platform_touch_file(String file);
+
+// NOTE: Writes fail instead of changing the file. Deleting it still works.
+b32 platform_make_read_only(String file);
+
+// NOTE: Seconds since the last modification.
+b32 platform_file_age(String file, s64 *seconds);
+
+// NOTE: Last modification time. Only useful to compare it with other file times.
+//       Returns false if the file does not exist.
+b32 platform_file_time(String file, s64 *time);
+b32 platform_file_size(String file, s64 *size);
+
+// NOTE: Everything above in one call. Doesn't wait for other clients of a network file system
+//       to write back their changes where the platform allows it, the build waits for its own commands.
+void platform_file_info(String file, FileInfo *info);
+
+// NOTE: Fills one FileInfo per file. Files in the same folder as the one before are looked up
+//       relative to it, so the folder is only resolved once. Returns the number of system calls.
+s64 platform_file_infos(Array<String> files, FileInfo *infos);
+
+// NOTE: Reads exactly size bytes starting at offset.
+b32 platform_read_file_part(String file, s64 offset, void *buffer, s64 size);
+
+// NOTE: Creates the file if it doesn't exist.
+b32 platform_append_to_file(String file, void const *data, s64 size);
+
+inline void destroy(FolderEntry *entry) {
+    destroy(&entry->name);
+}
+
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "definitions.h"
+#include "list.h"
+#include "string2.h"
+
+
+// NOTE: Used by bricks --watch to wait for changed sources, headers and blueprints.
+//       The platform specific part lives in linux/file_watcher.cpp and win32/file_watcher.cpp.
+
+struct PlatformWatcher;
+struct FileWatcher {
+    PlatformWatcher *platform; // NOTE: Created on the first watched file.
+};
+
+
+// NOTE: Files are watched through their folder, so editors that save by replacing the file are
+//       noticed as well. The name is copied, changes are reported with exactly this name.
+b32 platform_watch_file(FileWatcher *watcher, String file);
+
+// NOTE: Reports the folder itself, with exactly this name, when anything is created in, deleted
+//       from or renamed in it. Used for the folders globs list.
+b32 platform_watch_folder(FileWatcher *watcher, String folder);
+
+// NOTE: Blocks until a watched file changed. Changes that follow within debounce_ms are collected
+//       as well, so saving many files at once only reports them together. The names stay valid
+//       until the watcher is destroyed.
+b32 platform_wait_for_changes(FileWatcher *watcher, s32 debounce_ms, List<String> *changed);
+
+void destroy(FileWatcher *watcher);
@@ -0,0 +1,196 @@
+#include "glob.h"
+
+#include "hash_table.h"
+
+
+INTERNAL b32 is_separator(u8 c) {
+    return c == '/' || c == '\\';
+}
+
+INTERNAL b32 has_wildcard(String name) {
+    for (s64 i = 0; i < name.size; i += 1) {
+        if (name[i] == '*' || name[i] == '?') return true;
+    }
+
+    return false;
+}
+
+INTERNAL String advance(String str, s64 count) {
+    return String(str.data + count, str.size - count);
+}
+
+b32 match_glob(String pattern, String path) {
+    while (pattern.size) {
+        // NOTE: ** as a whole name matches the rest or any number of folders.
+        if (pattern.size >= 2 && pattern[0] == '*' && pattern[1] == '*' && (pattern.size == 2 || is_separator(pattern[2]))) {
+            if (pattern.size == 2) return true;
+
+            String rest = advance(pattern, 3);
+            if (match_glob(rest, path)) return true;
+
+            for (s64 i = 0; i < path.size; i += 1) {
+                if (is_separator(path[i]) && match_glob(rest, advance(path, i + 1))) return true;
+            }
+
+            return false;
+        }
+
+        if (pattern[0] == '*') {
+            String rest = advance(pattern, 1);
+
+            for (s64 i = 0; i <= path.size; i += 1) {
+                if (match_glob(rest, advance(path, i))) return true;
+                if (i < path.size && is_separator(path[i])) break;
+            }
+
+            return false;
+        }
+
+        if (path.size == 0) return false;
+
+        if (pattern[0] == '?') {
+            if (is_separator(path[0])) return false;
+        } else if (is_separator(pattern[0])) {
+            if (!is_separator(path[0])) return false;
+        } else if (pattern[0] != path[0]) {
+            return false;
+        }
+
+        pattern = advance(pattern, 1);
+        path    = advance(path, 1);
+    }
+
+    return path.size == 0;
+}
+
+struct GlobWalk {
+    FileCache *cache;
+
+    List<String> names; // NOTE: The pattern split at every /.
+    Array<String> excludes;
+
+    List<String> *files;
+    List<String> *folders; // NOTE: Optional.
+    Allocator alloc;
+
+    // NOTE: Patterns like **/**/a.cpp reach the same file more than once. Keys are the added files.
+    HashTable<String, b32> added;
+};
+
+// NOTE: Allocated with the DefaultAllocator.
+INTERNAL String join_path(String folder, String name) {
+    if (folder == "") return allocate_string(name, DefaultAllocator);
+    if (is_separator(folder[folder.size - 1])) return format(DefaultAllocator, "%S%S", folder, name);
+
+    return format(DefaultAllocator, "%S/%S", folder, name);
+}
+
+INTERNAL void add_file(GlobWalk *walk, String folder, String name) {
+    String file = join_path(folder, name);
+    DEFER(destroy(&file));
+
+    FOR (walk->excludes, exclude) {
+        if (match_glob(*exclude, file)) return;
+    }
+
+    if (find(&walk->added, file)) return;
+
+    String added = allocate_string(file, walk->alloc);
+    append(walk->files, added);
+    insert(&walk->added, added, (b32)true);
+}
+
+INTERNAL void walk_folder(GlobWalk *walk, String folder, s64 index) {
+    String name = walk->names[index];
+    b32 is_last = index == walk->names.size - 1;
+
+    String listed = folder == "" ? String(".") : folder;
+    Array<FolderEntry> entries = list_folder(walk->cache, listed);
+
+    if (walk->folders && !contains((Array<String>)*walk->folders, listed)) {
+        append(walk->folders, allocate_string(listed, walk->alloc));
+    }
+
+    if (name == "**") {
+        if (is_last) {
+            // NOTE: A trailing ** takes every file below.
+            FOR (entries, entry) {
+                if (!entry->is_folder) add_file(walk, folder, entry->name);
+            }
+        } else {
+            walk_folder(walk, folder, index + 1);
+        }
+
+        FOR (entries, entry) {
+            if (!entry->is_folder || entry->name[0] == '.') continue;
+
+            String sub_folder = join_path(folder, entry->name);
+            DEFER(destroy(&sub_folder));
+
+            walk_folder(walk, sub_folder, index);
+        }
+
+        return;
+    }
+
+    FOR (entries, entry) {
+        if (!match_glob(name, entry->name)) continue;
+
+        if (is_last) {
+            if (!entry->is_folder) add_file(walk, folder, entry->name);
+        } else if (entry->is_folder) {
+            String sub_folder = join_path(folder, entry->name);
+            DEFER(destroy(&sub_folder));
+
+            walk_folder(walk, sub_folder, index + 1);
+        }
+    }
+}
+
+void expand_glob(FileCache *cache, String pattern, Array<String> excludes, List<String> *files, Allocator alloc, List<String> *folders) {
+    GlobWalk walk = {};
+    walk.cache    = cache;
+    walk.excludes = excludes;
+    walk.files    = files;
+    walk.folders  = folders;
+    walk.alloc    = alloc;
+    DEFER(destroy(&walk.names));
+    DEFER(destroy(&walk.added));
+
+    s64 start = 0;
+    for (s64 i = 0; i <= pattern.size; i += 1) {
+        if (i < pattern.size && !is_separator(pattern[i])) continue;
+
+        append(&walk.names, String(pattern.data + start, i - start));
+        start = i + 1;
+    }
+
+    // NOTE: The names before the first wildcard are the folder the walk starts in.
+    s64 first_wildcard = 0;
+    while (first_wildcard < walk.names.size && !has_wildcard(walk.names[first_wildcard])) first_wildcard += 1;
+
+    if (first_wildcard == walk.names.size) {
+        FileInfo info = get_file_info(cache, pattern);
+        if (info.exists && !info.is_folder) add_file(&walk, "", pattern);
+
+        return;
+    }
+
+    String folder = {};
+    if (first_wildcard > 0) {
+        String last = walk.names[first_wildcard - 1];
+        folder = String(pattern.data, last.data + last.size - pattern.data);
+
+        // NOTE: Absolute paths keep their leading /.
+        if (folder == "") folder = String(pattern.data, 1);
+    }
+
+    // NOTE: Only the names from the first wildcard on are matched.
+    List<String> names = walk.names;
+    walk.names = {};
+    DEFER(destroy(&names));
+
+    for (s64 i = first_wildcard; i < names.size; i += 1) append(&walk.names, names[i]);
+
+    walk_folder(&walk, folder, 0);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "definitions.h"
+#include "list.h"
+#include "string2.h"
+#include "file_cache.h"
+
+
+// NOTE: Patterns for sources: glob "src/**/*.cpp"; Folders are separated by /, * and ? match
+//       within one name and ** matches any number of folders, including none.
+
+b32 match_glob(String pattern, String path);
+
+// NOTE: Appends the files matching pattern that match none of the excludes, allocated with alloc.
+//       Files come in the order of their names, folder by folder. ** skips folders starting
+//       with a . like .git or .bricks. Folders are listed through the cache, see list_folder.
+//       The listed folders are appended to folders if it is given, bricks --watch watches them.
+void expand_glob(FileCache *cache, String pattern, Array<String> excludes, List<String> *files, Allocator alloc, List<String> *folders = 0);
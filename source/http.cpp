@@ -0,0 +1,253 @@
+#include "http.h"
+
+#include "string_builder.h"
+
+#include <string.h>
+
+
+#define HTTP_MAX_HEADER_SIZE KILOBYTES(16)
+
+
+b32 parse_http_url(String url, HttpUrl *result) {
+    *result = {};
+    result->port = 80;
+
+    String scheme = "http://";
+    if (url.size <= scheme.size || !equal(String(url.data, scheme.size), scheme)) return false;
+    url = shrink_front(url, scheme.size);
+
+    s64 host_end = 0;
+    while (host_end < url.size && url[host_end] != '/') host_end += 1;
+
+    String host = String(url.data, host_end);
+    result->path = String(url.data + host_end, url.size - host_end);
+    if (result->path.size && result->path[result->path.size - 1] == '/') result->path.size -= 1;
+
+    s64 colon = find_last(host, ':');
+    if (colon != -1 && host[host.size - 1] != ']') {
+        String port = shrink_front(host, colon + 1);
+        if (port.size == 0 || port.size > 5) return false;
+
+        s32 number = 0;
+        for (s64 i = 0; i < port.size; i += 1) {
+            if (port[i] < '0' || port[i] > '9') return false;
+
+            number = number * 10 + (port[i] - '0');
+        }
+        if (number == 0 || number > 65535) return false;
+
+        result->port = (u16)number;
+        host.size = colon;
+    }
+
+    if (host.size > 2 && host[0] == '[' && host[host.size - 1] == ']') host = String(host.data + 1, host.size - 2);
+    if (host.size == 0) return false;
+
+    result->host = host;
+
+    return true;
+}
+
+INTERNAL u8 to_lower(u8 c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+// NOTE: Header names are case insensitive.
+INTERNAL b32 is_header(String line, String name) {
+    if (line.size <= name.size || line[name.size] != ':') return false;
+
+    for (s64 i = 0; i < name.size; i += 1) {
+        if (to_lower(line[i]) != to_lower(name[i])) return false;
+    }
+
+    return true;
+}
+
+// NOTE: Returns -1 if there is no Content-Length.
+INTERNAL s64 content_length(String header) {
+    s64 start = 0;
+    for (s64 i = 0; i + 1 < header.size; i += 1) {
+        if (header[i] != '\r' || header[i + 1] != '\n') continue;
+
+        String line = String(header.data + start, i - start);
+        start = i + 2;
+
+        if (!is_header(line, "Content-Length")) continue;
+
+        s64 length = 0;
+        for (s64 c = 15; c < line.size; c += 1) {
+            if (line[c] == ' ') continue;
+            if (line[c] < '0' || line[c] > '9' || length > GIGABYTES(64)) return -1;
+
+            length = length * 10 + (line[c] - '0');
+        }
+
+        return length;
+    }
+
+    return -1;
+}
+
+// NOTE: Reads the header up to the empty line and the body after it. Without a Content-Length
+//       the body goes until the connection closes if read_to_close is set, otherwise it is empty.
+INTERNAL b32 receive_message(Connection *connection, s64 max_body_size, b32 read_to_close, s32 timeout_ms, String *header, String *body) {
+    *header = {};
+    *body   = {};
+
+    String buffer = allocate_string(HTTP_MAX_HEADER_SIZE, DefaultAllocator);
+    DEFER(destroy(&buffer));
+
+    s64 received = 0;
+    s64 header_size = 0;
+    while (header_size == 0) {
+        s64 bytes = platform_receive_some(connection, buffer.data + received, buffer.size - received, timeout_ms);
+        if (bytes == 0) return false;
+
+        for (s64 i = received > 3 ? received - 3 : 0; i + 3 < received + bytes; i += 1) {
+            if (memcmp(buffer.data + i, "\r\n\r\n", 4) == 0) {
+                header_size = i + 4;
+                break;
+            }
+        }
+
+        received += bytes;
+        if (header_size == 0 && received == buffer.size) return false;
+    }
+
+    *header = allocate_string(String(buffer.data, header_size), DefaultAllocator);
+
+    // NOTE: Whatever arrived after the header is the start of the body.
+    String extra = String(buffer.data + header_size, received - header_size);
+
+    s64 length = content_length(*header);
+
+    if (length == -1 && read_to_close) {
+        StringBuilder builder = {};
+        DEFER(destroy(&builder));
+
+        append(&builder, extra);
+
+        u8 chunk[KILOBYTES(16)];
+        while (s64 bytes = platform_receive_some(connection, chunk, sizeof(chunk), timeout_ms)) {
+            if (builder.total_size + bytes > max_body_size) return false;
+
+            append(&builder, chunk, bytes);
+        }
+
+        *body = to_allocated_string(&builder, DefaultAllocator);
+        return true;
+    }
+
+    if (length == -1) length = 0;
+    if (length > max_body_size || extra.size > length) return false;
+
+    *body = allocate_string(length, DefaultAllocator);
+    if (extra.size) memcpy(body->data, extra.data, extra.size);
+
+    return platform_receive(connection, body->data + extra.size, length - extra.size, timeout_ms);
+}
+
+INTERNAL b32 send_message(Connection *connection, StringBuilder *builder, String body, s32 timeout_ms) {
+    String header = to_allocated_string(builder, DefaultAllocator);
+    DEFER(destroy(&header));
+
+    if (!platform_send(connection, header.data, header.size, timeout_ms)) return false;
+
+    return platform_send(connection, body.data, body.size, timeout_ms);
+}
+
+b32 http_request(HttpUrl *url, String method, String path, String body, s32 timeout_ms, HttpResponse *response) {
+    *response = {};
+
+    Connection connection = {};
+    if (!platform_connect(url->host, url->port, timeout_ms, &connection)) return false;
+    DEFER(platform_close(&connection));
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "%S %S%S HTTP/1.1\r\n", method, url->path, path);
+    format(&builder, "Host: %S\r\n", url->host);
+    append(&builder, "Connection: close\r\n");
+    if (body.size || method == "PUT") format(&builder, "Content-Length: %d\r\n", (s32)body.size);
+    append(&builder, "\r\n");
+
+    if (!send_message(&connection, &builder, body, timeout_ms)) return false;
+
+    String header = {};
+    DEFER(destroy(&header));
+
+    // NOTE: Nothing the cache stores is close to this large.
+    if (!receive_message(&connection, GIGABYTES(1), true, timeout_ms, &header, &response->body)) {
+        destroy(&response->body);
+        return false;
+    }
+
+    // NOTE: HTTP/1.1 200 OK
+    s64 space = 0;
+    while (space < header.size && header[space] != ' ') space += 1;
+
+    s32 status = 0;
+    for (s64 i = space + 1; i < header.size && i < space + 4; i += 1) {
+        if (header[i] < '0' || header[i] > '9') break;
+
+        status = status * 10 + (header[i] - '0');
+    }
+    response->status = status;
+
+    return status != 0;
+}
+
+b32 receive_http_request(Connection *connection, s64 max_body_size, s32 timeout_ms, HttpRequest *request) {
+    *request = {};
+
+    if (!receive_message(connection, max_body_size, false, timeout_ms, &request->header, &request->body)) return false;
+
+    // NOTE: GET /path HTTP/1.1
+    String line = request->header;
+    s64 first_space = 0;
+    while (first_space < line.size && line[first_space] != ' ') first_space += 1;
+
+    s64 second_space = first_space + 1;
+    while (second_space < line.size && line[second_space] != ' ' && line[second_space] != '\r') second_space += 1;
+
+    if (second_space >= line.size) return false;
+
+    request->method = String(line.data, first_space);
+    request->path   = String(line.data + first_space + 1, second_space - first_space - 1);
+
+    return request->method.size && request->path.size;
+}
+
+INTERNAL String status_text(s32 status) {
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    }
+
+    return "Internal Server Error";
+}
+
+b32 send_http_response(Connection *connection, s32 status, String body, s32 timeout_ms) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "HTTP/1.1 %d %S\r\n", status, status_text(status));
+    format(&builder, "Content-Length: %d\r\n", (s32)body.size);
+    append(&builder, "Connection: close\r\n\r\n");
+
+    return send_message(connection, &builder, body, timeout_ms);
+}
+
+void destroy(HttpRequest *request) {
+    destroy(&request->header);
+    destroy(&request->body);
+}
+
+void destroy(HttpResponse *response) {
+    destroy(&response->body);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "definitions.h"
+#include "string2.h"
+#include "network.h"
+
+
+// NOTE: Just enough HTTP/1.1 for the remote cache: one request per connection and bodies with a
+//       Content-Length. No TLS, a proxy in front of the cache server can add it.
+
+struct HttpUrl {
+    String host;
+    u16 port;
+    String path; // NOTE: Prefix of all requests, without a trailing /. Can be empty.
+};
+
+struct HttpRequest {
+    String method;
+    String path;
+    String body;
+
+    String header; // NOTE: method and path point into it.
+};
+
+struct HttpResponse {
+    s32 status; // NOTE: 0 if the server couldn't be reached or didn't answer.
+    String body;
+};
+
+
+// NOTE: http://host[:port][/path]. Points into url.
+b32 parse_http_url(String url, HttpUrl *result);
+
+// NOTE: Sends the body if it isn't empty. Returns false if there is no response.
+b32 http_request(HttpUrl *url, String method, String path, String body, s32 timeout_ms, HttpResponse *response);
+
+// NOTE: Server side, bodies larger than max_body_size are refused.
+b32 receive_http_request(Connection *connection, s64 max_body_size, s32 timeout_ms, HttpRequest *request);
+b32 send_http_response(Connection *connection, s32 status, String body, s32 timeout_ms);
+
+void destroy(HttpRequest *request);
+void destroy(HttpResponse *response);
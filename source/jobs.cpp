@@ -0,0 +1,1360 @@
+#include "jobs.h"
+
+#include "blueprint.h"
+#include "process.h"
+#include "platform.h"
+#include "file_system.h"
+#include "file_cache.h"
+#include "remote.h"
+#include "remote_cache.h"
+#include "io.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+extern ApplicationState App;
+
+
+INTERNAL String EntityKindLookup[ENTITY_COUNT] = {
+    "None",
+    "Brick",
+    "Executable",
+    "Library",
+};
+
+INTERNAL String enum_string(EntityKind kind) {
+    assert(kind < ENTITY_COUNT);
+    return EntityKindLookup[kind];
+}
+
+
+BuildJob *create_job(JobPool *pool, Blueprint *blueprint, Entity *entity, Compiler *compiler) {
+    BuildJob *job = ALLOC(App.persistent_alloc, BuildJob, 1);
+    job->blueprint = blueprint;
+    job->entity    = entity;
+    job->compiler  = compiler;
+
+    append(&pool->jobs, job);
+
+    return job;
+}
+
+void add_job_dependency(BuildJob *job, BuildJob *dependency) {
+    FOR (job->dependencies, dep) {
+        if (*dep == dependency) return;
+    }
+
+    append(&job->dependencies, dependency);
+    append(&dependency->dependents, job);
+}
+
+INTERNAL String job_description(BuildJob *job) {
+    Entity *entity = job->entity;
+
+    String name = entity->name;
+    if (job->blueprint->name != "") name = t_format("%S.%S", job->blueprint->name, entity->name);
+
+    if (App.configurations.size > 1) {
+        return t_format("%S %S [%S]", enum_string(entity->kind), name, entity->config->name);
+    }
+
+    return t_format("%S %S", enum_string(entity->kind), name);
+}
+
+INTERNAL String command_log_file(Entity *entity) {
+    return t_format("%Scommands", entity->intermediate_folder);
+}
+
+// NOTE: Reads a decimal number followed by a space.
+INTERNAL b32 parse_log_number(String line, s64 *i, s64 *value) {
+    s64 start = *i;
+
+    s64 result = 0;
+    for (; *i < line.size && line[*i] >= '0' && line[*i] <= '9'; *i += 1) {
+        result = result * 10 + (line[*i] - '0');
+    }
+
+    if (*i == start || *i + 1 >= line.size || line[*i] != ' ') return false;
+    *i += 1;
+
+    *value = result;
+    return true;
+}
+
+// NOTE: Reads a hex number followed by a space.
+INTERNAL b32 parse_log_hash(String line, s64 *i, u64 *value) {
+    s64 start = *i;
+
+    u64 result = 0;
+    for (; *i < line.size; *i += 1) {
+        u8 c = line[*i];
+
+        if      (c >= '0' && c <= '9') result = result * 16 + (c - '0');
+        else if (c >= 'a' && c <= 'f') result = result * 16 + (c - 'a' + 10);
+        else break;
+    }
+
+    if (*i == start || *i + 1 >= line.size || line[*i] != ' ') return false;
+    *i += 1;
+
+    *value = result;
+    return true;
+}
+
+INTERNAL void append_hash(StringBuilder *builder, u64 hash) {
+    char digits[16];
+    for (s32 i = 15; i >= 0; i -= 1) {
+        digits[i] = "0123456789abcdef"[hash & 0xf];
+        hash >>= 4;
+    }
+
+    append(builder, String((u8*)digits, 16));
+}
+
+// NOTE: One line per output: the hashes of the command, of the content of the output and of the
+//       outputs it read from other commands in hex, the peak memory of the command in kB, its
+//       duration in ms and the output file.
+INTERNAL void read_command_log(BuildJob *job) {
+    auto read_result = platform_read_entire_file(command_log_file(job->entity));
+    if (read_result.error) return;
+
+    job->command_log = read_result.content;
+
+    String text = job->command_log;
+    while (text.size) {
+        s64 line_end = 0;
+        while (line_end < text.size && text[line_end] != '\n') line_end += 1;
+
+        String line = String(text.data, line_end);
+        text = String(text.data + line_end, text.size - line_end);
+        if (text.size) text = shrink_front(text, 1);
+
+        CommandRecord record = {};
+        s64 memory   = 0;
+        s64 duration = 0;
+
+        s64 i = 0;
+        if (!parse_log_hash(line, &i, &record.hash))    continue;
+        if (!parse_log_hash(line, &i, &record.content)) continue;
+        if (!parse_log_hash(line, &i, &record.inputs))  continue;
+        if (!parse_log_number(line, &i, &memory))       continue;
+        if (!parse_log_number(line, &i, &duration))     continue;
+
+        record.peak_memory = memory   * 1024;
+        record.duration    = duration * 1000;
+
+        insert(&job->command_records, String(line.data + i, line.size - i), record);
+    }
+}
+
+// NOTE: Failed commands are left out, so they run again on the next build.
+INTERNAL void write_command_log(BuildJob *job) {
+    Entity *entity = job->entity;
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    FOR (job->runs, run) {
+        if (run->status != COMMAND_DONE && run->status != COMMAND_SKIPPED) continue;
+
+        BuildCommand *command = &entity->build_commands[run->index];
+        if (command->outputs.size == 0) continue;
+
+        append_hash(&builder, command->hash);
+        append(&builder, ' ');
+        append_hash(&builder, run->content_hash);
+        append(&builder, ' ');
+        append_hash(&builder, run->input_hash);
+
+        // NOTE: Commands that ran count as at least 1 ms, 0 means the duration is unknown.
+        s64 duration = run->duration / 1000;
+        if (duration == 0 && run->duration > 0) duration = 1;
+
+        format(&builder, " %d %d %S\n", (s32)(run->peak_memory / 1024), (s32)duration, command->outputs[0]);
+    }
+
+    PlatformFile file = platform_file_open(command_log_file(entity), PlatformFileOverride);
+    if (!file.open) return;
+
+    write_builder_to_file(&builder, &file);
+    platform_file_close(&file);
+}
+
+INTERNAL void trace_job(BuildJob *job) {
+    Entity *entity = job->entity;
+
+    format(&App.trace_file, "echo Building %S\n", job_description(job));
+    format(&App.trace_file, "IF NOT EXIST %S mkdir \"%S\"\n", path_without_filename(entity->file_path), path_without_filename(entity->file_path));
+    format(&App.trace_file, "IF NOT EXIST %S mkdir \"%S\"\n", entity->intermediate_folder, entity->intermediate_folder);
+
+    FOR (entity->build_commands, command) {
+        format(&App.trace_file, "%S\n", command->command);
+    }
+}
+
+INTERNAL void finish_job(BuildJob *job) {
+    Entity *entity = job->entity;
+
+    if (entity->status == ENTITY_STATUS_ERROR) {
+        job->status = JOB_FAILED;
+        App.has_errors = true;
+
+        print("Building %S ... failed\n", job_description(job));
+    } else {
+        job->status = JOB_DONE;
+        entity->status = ENTITY_STATUS_READY;
+
+        if (job->runs.size && job->skipped_commands == job->runs.size) {
+            print("Building %S ... up to date\n", job_description(job));
+        } else {
+            print("Building %S ... done\n", job_description(job));
+        }
+
+        // NOTE: Jobs only finish after their dependencies, so the trace stays in a valid order.
+        if (create_trace()) trace_job(job);
+    }
+
+    if (job->runs.size) write_command_log(job);
+
+    // NOTE: Always print all diagnostics on failure or success.
+    print_diagnostics(entity);
+
+    // TODO: Print might be not a great option. Maybe do something like a DIAG_MESSAGE?
+    if (be_verbose()) {
+        FOR (entity->build_commands, command) {
+            print("with command: %S\n", command->command);
+        }
+    }
+
+    platform_flush_write_buffer(Console.out);
+}
+
+// NOTE: Missing files count as newer, so the command runs and reports them.
+INTERNAL b32 is_newer_than(String file, s64 time) {
+    FileInfo info = get_file_info(&App.file_cache, file);
+    if (!info.exists) return true;
+
+    return info.time > time;
+}
+
+INTERNAL void destroy_discovered(CommandRun *run) {
+    FOR (run->discovered, file) destroy(file);
+    destroy(&run->discovered);
+}
+
+// NOTE: Replaces run->discovered with the files in the depfile.
+INTERNAL b32 read_depfile(CommandRun *run, String depfile) {
+    BuildJob *job = run->job;
+    if (job->compiler->parse_depfile == 0) return false;
+
+    auto read_result = platform_read_entire_file(depfile);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return false;
+
+    destroy_discovered(run);
+    job->compiler->parse_depfile(job->entity, read_result.content, &run->discovered);
+
+    return true;
+}
+
+// NOTE: Watch mode keeps the files, so they can be watched and checked against the changed ones.
+INTERNAL b32 depfile_is_newer_than(JobPool *pool, CommandRun *run, String depfile, s64 time) {
+    if (!read_depfile(run, depfile)) return true;
+    DEFER(if (!pool->watch) destroy_discovered(run));
+
+    // NOTE: Most headers are shared with other sources, the others are looked up together.
+    prefetch_file_infos(&App.file_cache, run->discovered);
+
+    FOR (run->discovered, file) {
+        if (is_newer_than(*file, time)) return true;
+    }
+
+    return false;
+}
+
+INTERNAL b32 reads_changed_file(JobPool *pool, CommandRun *run) {
+    BuildCommand *command = &run->job->entity->build_commands[run->index];
+
+    FOR (command->inputs, input) {
+        if (find(pool->changed_files, *input)) return true;
+    }
+
+    FOR (run->discovered, file) {
+        if (find(pool->changed_files, *file)) return true;
+    }
+
+    return false;
+}
+
+INTERNAL b32 has_content_hash(JobPool *pool, String file) {
+    u64 *content = find(&pool->output_hashes, file);
+
+    return content && *content;
+}
+
+// NOTE: Combines the content hashes of the inputs other commands wrote, 0 if there are none.
+INTERNAL u64 input_hash(JobPool *pool, BuildCommand *command) {
+    u64 hash = 0;
+
+    FOR (command->inputs, input) {
+        u64 *content = find(&pool->output_hashes, *input);
+        if (!content || *content == 0) continue;
+
+        hash = (hash ^ *content) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// NOTE: 0 means the content is unknown.
+INTERNAL u64 hash_file_content(String file) {
+    auto read_result = platform_read_entire_file(file);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return 0;
+
+    u64 hash = hash_content(read_result.content);
+
+    return hash ? hash : 1;
+}
+
+// NOTE: A command that differs from the one that wrote the outputs, e.g. because options
+//       changed, always runs. Inputs written by other commands are compared by their content,
+//       so a compile that wrote the same object as before doesn't make the link run.
+INTERNAL b32 is_up_to_date(JobPool *pool, CommandRun *run) {
+    BuildJob *job = run->job;
+    BuildCommand *command = &job->entity->build_commands[run->index];
+
+    if (App.rebuild) return false;
+    if (command->outputs.size == 0) return false;
+
+    // NOTE: Outputs of commands that ran are added to changed_files, so the commands reading them run as well.
+    if (pool->changed_files && (run->previous_status == COMMAND_DONE || run->previous_status == COMMAND_SKIPPED)) {
+        return !reads_changed_file(pool, run);
+    }
+
+    CommandRecord *record = find(&job->command_records, command->outputs[0]);
+    if (!record || record->hash != command->hash) return false;
+
+    if (record->inputs != input_hash(pool, command)) return false;
+
+    s64 oldest_output = 0;
+    FOR (command->outputs, output) {
+        FileInfo info = get_file_info(&App.file_cache, *output);
+        if (!info.exists) return false;
+
+        if (oldest_output == 0 || info.time < oldest_output) oldest_output = info.time;
+    }
+
+    FOR (command->inputs, input) {
+        if (has_content_hash(pool, *input)) continue;
+
+        if (is_newer_than(*input, oldest_output)) return false;
+    }
+
+    if (command->depfile != "" && depfile_is_newer_than(pool, run, command->depfile, oldest_output)) return false;
+
+    return true;
+}
+
+// NOTE: Dependencies always come before a command, so there can't be cycles inside a job.
+INTERNAL b32 command_dependencies_done(BuildJob *job, BuildCommand *command) {
+    FOR (command->dependencies, dep) {
+        CommandStatus status = job->runs[*dep].status;
+
+        if (status != COMMAND_DONE && status != COMMAND_SKIPPED) return false;
+    }
+
+    return true;
+}
+
+INTERNAL void start_command(ProcessLauncher *launcher, CommandRun *run) {
+    BuildJob *job  = run->job;
+    Entity *entity = job->entity;
+
+    String command = entity->build_commands[run->index].command;
+
+    String job_command = command;
+    if (job->compiler->generate_job_command) {
+        job_command = job->compiler->generate_job_command(DefaultAllocator, entity, command);
+    }
+    DEFER(if (job_command.data != command.data) destroy(&job_command));
+
+    if (launch_process(launcher, job_command, run)) {
+        run->status = COMMAND_RUNNING;
+        job->running_commands += 1;
+    } else {
+        log_error("Could not run command %S.", job_command);
+
+        run->status = COMMAND_FAILED;
+        job->finished_commands += 1;
+        entity->status = ENTITY_STATUS_ERROR;
+    }
+}
+
+// NOTE: The worker with the most free slots, 0 if the command has to run locally.
+INTERNAL RemoteWorker *pick_worker(JobPool *pool, CommandRun *run) {
+    BuildJob *job = run->job;
+
+    if (run->local_only || !job->compiler->remote_compile) return 0;
+    if (job->entity->build_commands[run->index].kind != COMMAND_COMPILE) return 0;
+
+    RemoteWorker *result = 0;
+    FOR (pool->workers, worker) {
+        if (worker->unavailable || worker->running >= worker->slots) continue;
+
+        if (!result || worker->slots - worker->running > result->slots - result->running) result = worker;
+    }
+
+    return result;
+}
+
+// NOTE: Returns false if the command has to run locally, e.g. because the compiler can't split it.
+INTERNAL b32 start_remote_command(JobPool *pool, ProcessLauncher *launcher, CommandRun *run, RemoteWorker *worker) {
+    BuildJob *job = run->job;
+    BuildCommand *command = &job->entity->build_commands[run->index];
+
+    RemoteCompile remote = {};
+    DEFER(destroy(&remote));
+
+    run->local_only = true;
+    if (!job->compiler->remote_compile(DefaultAllocator, job->entity, command, &remote)) return false;
+
+    // NOTE: The worker would refuse it and get no more commands in this build.
+    if (!is_worker_command(remote.compile, remote.object_name)) return false;
+
+    String job_file = t_format("%S.remote", command->outputs[0]);
+    if (!write_remote_job(job_file, worker, REMOTE_COMPILE_TIMEOUT_MS, &remote)) return false;
+
+    String wrapper = t_format("\"%S\" remote_compile \"%S\"", pool->executable, job_file);
+    if (!launch_process(launcher, wrapper, run)) return false;
+
+    run->local_only = false;
+    run->worker = worker;
+    run->status = COMMAND_RUNNING;
+
+    worker->running      += 1;
+    pool->remote_running += 1;
+    job->running_commands += 1;
+
+    return true;
+}
+
+INTERNAL b32 is_cacheable(CommandRun *run) {
+    BuildJob *job = run->job;
+
+    return job->compiler->remote_compile && job->entity->build_commands[run->index].kind == COMMAND_COMPILE;
+}
+
+INTERNAL b32 needs_cache_lookup(JobPool *pool, CommandRun *run) {
+    if ((pool->remote_cache == "" && pool->local_cache == "") || run->cache_checked) return false;
+
+    return is_cacheable(run);
+}
+
+// NOTE: Returns false if the command can't be looked up, it runs as usual then.
+INTERNAL b32 start_cache_lookup(JobPool *pool, ProcessLauncher *launcher, CommandRun *run) {
+    BuildJob *job = run->job;
+    BuildCommand *command = &job->entity->build_commands[run->index];
+
+    run->cache_checked = true;
+
+    RemoteCompile remote = {};
+    DEFER(destroy(&remote));
+
+    if (!job->compiler->remote_compile(DefaultAllocator, job->entity, command, &remote)) return false;
+
+    // NOTE: Only the first lookup of a build runs the compiler for it.
+    u64 compiler = compiler_identity(&pool->compiler_identities, remote.compile);
+    if (compiler == 0) return false;
+
+    String job_file = t_format("%S.lookup", command->outputs[0]);
+    if (!write_cache_lookup(job_file, pool->remote_cache, pool->local_cache, compiler, command, &remote)) return false;
+
+    String wrapper = t_format("\"%S\" cache_lookup \"%S\"", pool->executable, job_file);
+    if (!launch_process(launcher, wrapper, run)) return false;
+
+    run->cache_lookup = true;
+    run->status = COMMAND_RUNNING;
+
+    pool->lookups_running += 1;
+    job->running_commands += 1;
+
+    return true;
+}
+
+// NOTE: Writing the object to the cache doesn't hold up anything, the uploads run on their own.
+INTERNAL void start_cache_upload(JobPool *pool, ProcessLauncher *uploads, CommandRun *run) {
+    BuildCommand *command = &run->job->entity->build_commands[run->index];
+
+    String url = pool->remote_cache_read_only ? String() : pool->remote_cache;
+
+    if (url == "" && pool->local_cache == "") {
+        platform_delete_file(t_format("%S.cache_key", command->outputs[0]));
+        return;
+    }
+
+    String upload = t_format("\"%S\" cache_upload \"%S\" \"%S\" \"%S\"", pool->executable, url, pool->local_cache, command->outputs[0]);
+    if (launch_process(uploads, upload, 0)) pool->statistics.cache_uploads += 1;
+}
+
+// NOTE: Lookups and commands on workers mostly wait for the network, they have their own limits.
+INTERNAL s32 local_process_count(JobPool *pool, ProcessLauncher *launcher) {
+    return running_process_count(launcher) - pool->remote_running - pool->lookups_running;
+}
+
+INTERNAL s64 expected_memory(JobPool *pool, CommandRun *run) {
+    if (run->peak_memory) return run->peak_memory;
+    if (pool->known_memory_count) return pool->known_memory / pool->known_memory_count;
+
+    return 0;
+}
+
+// NOTE: Checks the limits of the pool against the load sampled in run_jobs. Commands that are
+//       started in the same pass don't show up in the load yet, the reserved memory covers that.
+INTERNAL b32 can_start_command(JobPool *pool, ProcessLauncher *launcher, CommandRun *run) {
+    s32 running = local_process_count(pool, launcher);
+    if (running == 0) return true;
+    if (running >= pool->max_parallel) return false;
+
+    if (pool->max_load > 0 && pool->load.load_average >= pool->max_load) return false;
+
+    s64 memory = expected_memory(pool, run);
+    if (pool->max_memory > 0 && pool->reserved_memory + memory > pool->max_memory) return false;
+
+    // NOTE: Running commands may not have reached their peak yet.
+    if (pool->load.available_memory > 0 && pool->reserved_memory + memory > pool->load.available_memory) return false;
+
+    return true;
+}
+
+// NOTE: hash_content of text without any of the strings in skip, the parts between them are
+//       hashed one after the other.
+INTERNAL u64 hash_without(u64 hash, String text, Array<String> skip) {
+    s64 start = 0;
+
+    for (s64 i = 0; i < text.size; ) {
+        s64 skipped = 0;
+        FOR (skip, it) {
+            if (it->size && it->size <= text.size - i && (*it)[0] == text[i] && memcmp(it->data, text.data + i, it->size) == 0) {
+                skipped = it->size;
+                break;
+            }
+        }
+
+        if (skipped) {
+            hash = hash_content(hash, String(text.data + start, i - start));
+
+            i += skipped;
+            start = i;
+            continue;
+        }
+
+        i += 1;
+    }
+
+    return hash_content(hash, String(text.data + start, text.size - start));
+}
+
+// NOTE: The command without its outputs, depfile and response file, they are in the intermediate
+//       folder of the entity. Everything else, e.g. a pdb or profile folder, keeps them apart.
+//       Only the object and the depfile are copied, so compiles writing more, like the .dwo of
+//       split debug info or a time trace, are never shared.
+INTERNAL String compile_fingerprint(BuildCommand *command) {
+    if (command->outputs.size == 0) return {};
+
+    FOR (command->outputs, output) {
+        if (output != &command->outputs[0] && *output != command->depfile) return {};
+    }
+
+    List<String> skip = {};
+    DEFER(destroy(&skip));
+
+    FOR (command->outputs, output) append(&skip, *output);
+    if (command->depfile != "")       append(&skip, command->depfile);
+    if (command->response_file != "") append(&skip, command->response_file);
+
+    u64 hash = hash_without(HASH_SEED, command->command, skip);
+
+    if (command->response_file != "") {
+        auto read_result = platform_read_entire_file(command->response_file);
+        DEFER(destroy(&read_result.content));
+
+        if (read_result.error) return {};
+
+        hash = hash_without(hash, read_result.content, skip);
+    }
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    append_hash(&builder, hash);
+
+    return to_allocated_string(&builder, App.persistent_alloc);
+}
+
+// NOTE: The peak memory and duration are used even if the command changed, they are still the best guess.
+INTERNAL void init_runs(JobPool *pool, BuildJob *job) {
+    Entity *entity = job->entity;
+
+    // NOTE: Jobs that are built again keep what they know from the last time.
+    if (job->runs.size) return;
+
+    for (s64 i = 0; i < entity->build_commands.size; i += 1) {
+        CommandRun run = {job, (s32)i};
+        append(&job->runs, run);
+    }
+
+    read_command_log(job);
+
+    FOR (job->runs, run) {
+        BuildCommand *command = &entity->build_commands[run->index];
+        if (command->outputs.size == 0) continue;
+
+        if (command->kind == COMMAND_COMPILE) run->fingerprint = compile_fingerprint(command);
+
+        CommandRecord *record = find(&job->command_records, command->outputs[0]);
+        insert(&pool->output_hashes, command->outputs[0], record ? record->content : 0);
+
+        if (!record) continue;
+
+        run->duration     = record->duration;
+        run->content_hash = record->content;
+        run->input_hash   = record->inputs;
+
+        if (record->peak_memory) {
+            run->peak_memory = record->peak_memory;
+
+            pool->known_memory       += record->peak_memory;
+            pool->known_memory_count += 1;
+        }
+    }
+}
+
+// NOTE: Without a recorded duration a command is expected to take this long per byte of its inputs.
+//       Once some commands of a kind have a duration, their ratio is used instead.
+#define MICROSECONDS_PER_INPUT_BYTE 20
+
+INTERNAL s64 input_size(BuildCommand *command) {
+    s64 result = 0;
+
+    FOR (command->inputs, input) {
+        result += get_file_info(&App.file_cache, *input).size;
+    }
+
+    return result;
+}
+
+// NOTE: Critical path of the commands of every job through the job graph. Commands that turn out
+//       to be up to date still count, whether they are is only known once their dependencies are done.
+INTERNAL void compute_critical_path(BuildJob *job) {
+    if (job->critical_path_done) return;
+
+    // NOTE: Cycles are reported when the jobs run, here they just end the path.
+    if (job->critical_path_visiting) return;
+    job->critical_path_visiting = true;
+
+    // NOTE: Dependents wait for all commands of the job.
+    s64 downstream = 0;
+    FOR (job->dependents, it) {
+        BuildJob *dependent = *it;
+
+        compute_critical_path(dependent);
+        if (dependent->critical_path > downstream) downstream = dependent->critical_path;
+    }
+
+    job->critical_path = downstream;
+
+    // NOTE: Commands only depend on earlier ones, so the ones depending on a command are already done.
+    //       Until then critical_path holds the longest path of the commands depending on it.
+    for (s64 i = job->runs.size - 1; i >= 0; i -= 1) {
+        CommandRun *run = &job->runs[i];
+        BuildCommand *command = &job->entity->build_commands[run->index];
+
+        if (run->critical_path < downstream) run->critical_path = downstream;
+        run->critical_path += run->estimated_duration;
+
+        FOR (command->dependencies, dep) {
+            CommandRun *before = &job->runs[*dep];
+            if (before->critical_path < run->critical_path) before->critical_path = run->critical_path;
+        }
+
+        if (run->critical_path > job->critical_path) job->critical_path = run->critical_path;
+    }
+
+    job->critical_path_visiting = false;
+    job->critical_path_done = true;
+}
+
+INTERNAL void compute_critical_paths(JobPool *pool) {
+    s64 known_time[COMMAND_KIND_COUNT] = {};
+    s64 known_size[COMMAND_KIND_COUNT] = {};
+
+    // NOTE: Holds the input size until the rates are known.
+    FOR (pool->jobs, it) {
+        if ((*it)->critical_path_done) continue;
+
+        FOR ((*it)->runs, run) {
+            BuildCommand *command = &(*it)->entity->build_commands[run->index];
+
+            run->estimated_duration = input_size(command);
+
+            if (run->duration) {
+                known_time[command->kind] += run->duration;
+                known_size[command->kind] += run->estimated_duration;
+            }
+        }
+    }
+
+    FOR (pool->jobs, it) {
+        if ((*it)->critical_path_done) continue;
+
+        FOR ((*it)->runs, run) {
+            if (run->duration) {
+                run->estimated_duration = run->duration;
+                continue;
+            }
+
+            CommandKind kind = (*it)->entity->build_commands[run->index].kind;
+
+            r64 rate = MICROSECONDS_PER_INPUT_BYTE;
+            if (known_size[kind] > 0) rate = (r64)known_time[kind] / (r64)known_size[kind];
+
+            run->estimated_duration = (s64)(run->estimated_duration * rate);
+        }
+    }
+
+    FOR (pool->jobs, it) compute_critical_path(*it);
+}
+
+// NOTE: Returns true if the first output is the same as before. Executables are not read by other
+//       commands, so they are not hashed.
+INTERNAL b32 update_content_hash(JobPool *pool, CommandRun *run) {
+    Entity *entity = run->job->entity;
+    BuildCommand *command = &entity->build_commands[run->index];
+
+    run->input_hash = input_hash(pool, command);
+
+    if (command->outputs.size == 0) return false;
+    if (entity->kind == ENTITY_EXECUTABLE && command->outputs[0] == entity->file_path) return false;
+
+    u64 content = hash_file_content(command->outputs[0]);
+    run->content_hash = content;
+
+    u64 *known = find(&pool->output_hashes, command->outputs[0]);
+    if (!known) {
+        insert(&pool->output_hashes, command->outputs[0], content);
+        return false;
+    }
+
+    b32 unchanged = *known != 0 && *known == content;
+    *known = content;
+
+    return unchanged;
+}
+
+// NOTE: Compiles are logged with their source, so bricks stats can report them per file.
+INTERNAL void log_command(BuildJob *job, CommandRun *run, s64 duration, s32 exit_code, b32 cache_hit) {
+    BuildCommand *command = &job->entity->build_commands[run->index];
+
+    BuildLogRecord record = {};
+    record.type      = BUILD_LOG_COMMAND;
+    record.kind      = (u8)command->kind;
+    record.exit_code = exit_code;
+    record.hash      = command->hash;
+    record.end       = platform_time_microseconds() - App.start_time;
+    record.start     = record.end - duration;
+
+    if (run->status == COMMAND_SKIPPED) {
+        record.result = BUILD_LOG_UP_TO_DATE;
+    } else if (cache_hit && run->status == COMMAND_DONE) {
+        record.result = BUILD_LOG_CACHE_HIT;
+    } else {
+        record.result      = run->status == COMMAND_FAILED ? BUILD_LOG_FAILED : BUILD_LOG_RAN;
+        record.peak_memory = run->peak_memory;
+    }
+
+    if (command->kind == COMMAND_COMPILE && command->inputs.size) {
+        set_name(&record, command->inputs[0]);
+    } else if (command->outputs.size) {
+        set_name(&record, command->outputs[0]);
+    } else {
+        set_name(&record, job->entity->name);
+    }
+
+    append(&App.build_log, record);
+}
+
+// NOTE: After the outputs of a command were written.
+INTERNAL void finish_outputs(JobPool *pool, CommandRun *run) {
+    BuildCommand *command = &run->job->entity->build_commands[run->index];
+
+    if (pool->watch && command->depfile != "") read_depfile(run, command->depfile);
+
+    b32 unchanged = update_content_hash(pool, run);
+    if (unchanged) pool->statistics.unchanged_count += 1;
+
+    // NOTE: Early cutoff, the commands reading an unchanged output don't have to run.
+    if (pool->changed_files && !unchanged) {
+        FOR (command->outputs, output) insert(pool->changed_files, *output, (b32)true);
+    }
+}
+
+// NOTE: Copies the outputs and the depfile of the same compile in another entity. The depfile names
+//       the other object, only the files it lists are read.
+INTERNAL b32 copy_outputs(CommandRun *from_run, CommandRun *to_run) {
+    BuildCommand *from = &from_run->job->entity->build_commands[from_run->index];
+    BuildCommand *to   = &to_run->job->entity->build_commands[to_run->index];
+
+    if (from->outputs.size != to->outputs.size) return false;
+
+    FileCopyMethod method = FILE_COPY_BYTES;
+
+    for (s64 i = 0; i < to->outputs.size; i += 1) {
+        platform_delete_file(to->outputs[i]);
+        if (!platform_clone_file(from->outputs[i], to->outputs[i], false, &method)) return false;
+    }
+
+    if (to->depfile != "") {
+        platform_delete_file(to->depfile);
+        if (from->depfile == "" || !platform_clone_file(from->depfile, to->depfile, false, &method)) return false;
+    }
+
+    return true;
+}
+
+// NOTE: Returns true if the run is done or has to wait for the same compile in another entity.
+//       Otherwise it becomes the one the others wait for.
+INTERNAL b32 share_compile(JobPool *pool, CommandRun *run) {
+    if (run->fingerprint == "") return false;
+
+    CommandRun **other = find(&pool->compiles, run->fingerprint);
+    if (!other) {
+        insert(&pool->compiles, run->fingerprint, run);
+        return false;
+    }
+
+    CommandRun *owner = *other;
+    if (owner == run) return false;
+
+    if (owner->status == COMMAND_RUNNING) return true;
+
+    // NOTE: One that didn't start yet or failed doesn't hold this one up, e.g. because its entity
+    //       waits for a library. Compile errors are reported for every entity.
+    if ((owner->status == COMMAND_DONE || owner->status == COMMAND_SKIPPED) && copy_outputs(owner, run)) {
+        BuildJob *job = run->job;
+        BuildCommand *command = &job->entity->build_commands[run->index];
+
+        run->status = COMMAND_DONE;
+        job->finished_commands += 1;
+        pool->statistics.shared_count += 1;
+
+        FOR (command->outputs, output) forget_file(&App.file_cache, *output);
+
+        finish_outputs(pool, run);
+        log_command(job, run, 0, 0, false);
+
+        return true;
+    }
+
+    *other = run;
+    return false;
+}
+
+// NOTE: Marks the commands whose dependencies are done as skipped or ready and finishes the job if
+//       nothing is left.
+INTERNAL void advance_job(JobPool *pool, BuildJob *job) {
+    Entity *entity = job->entity;
+
+    // NOTE: Skipped commands can make the ones depending on them ready, so this loops until nothing changes.
+    b32 progress = true;
+    while (progress && entity->status != ENTITY_STATUS_ERROR) {
+        progress = false;
+
+        FOR (job->runs, run) {
+            if (run->status != COMMAND_WAITING) continue;
+
+            BuildCommand *command = &entity->build_commands[run->index];
+            if (!command_dependencies_done(job, command)) continue;
+
+            if (is_up_to_date(pool, run)) {
+                run->status = COMMAND_SKIPPED;
+                job->finished_commands += 1;
+                job->skipped_commands  += 1;
+                pool->statistics.skipped_count += 1;
+
+                // NOTE: Its object is as good as a new one for the same compile in another entity.
+                if (run->fingerprint != "" && !find(&pool->compiles, run->fingerprint)) insert(&pool->compiles, run->fingerprint, run);
+
+                log_command(job, run, 0, 0, false);
+
+                progress = true;
+            } else {
+                run->status = COMMAND_READY;
+            }
+        }
+    }
+
+    if (job->running_commands) return;
+
+    if (entity->status == ENTITY_STATUS_ERROR || job->finished_commands == job->runs.size) {
+        finish_job(job);
+    }
+}
+
+// NOTE: Returns true if the job can be started. Jobs with failed dependencies fail as well.
+INTERNAL b32 dependencies_done(BuildJob *job) {
+    FOR (job->dependencies, it) {
+        BuildJob *dep = *it;
+
+        if (dep->status == JOB_FAILED) {
+            String msg = t_format("Could not build library %S.", dep->entity->name);
+            add_diagnostic(job->entity, DIAG_ERROR, msg);
+
+            finish_job(job);
+            return false;
+        }
+
+        if (dep->status != JOB_DONE) return false;
+    }
+
+    return true;
+}
+
+INTERNAL int compare_critical_paths(void const *a, void const *b) {
+    CommandRun *run_a = *(CommandRun**)a;
+    CommandRun *run_b = *(CommandRun**)b;
+
+    if (run_a->critical_path > run_b->critical_path) return -1;
+    if (run_a->critical_path < run_b->critical_path) return  1;
+
+    return 0;
+}
+
+b32 run_jobs(JobPool *pool) {
+    ProcessLauncher launcher = {};
+    DEFER(destroy(&launcher));
+
+    List<FinishedProcess> finished = {};
+    DEFER(destroy(&finished));
+
+    List<CommandRun*> ready = {};
+    DEFER(destroy(&ready));
+
+    ProcessLauncher uploads = {};
+    DEFER(destroy(&uploads));
+
+    if (pool->max_parallel < 1) pool->max_parallel = 1;
+
+    FOR (pool->jobs, it) init_runs(pool, *it);
+    compute_critical_paths(pool);
+
+    s64 start_time = platform_time_microseconds();
+
+    while (true) {
+        platform_system_load(&pool->load);
+
+        // NOTE: Finished jobs can make other jobs ready, so this loops until nothing changes.
+        b32 progress = true;
+        while (progress) {
+            progress = false;
+
+            FOR (pool->jobs, it) {
+                BuildJob *job = *it;
+                if (job->status == JOB_DONE || job->status == JOB_FAILED) continue;
+
+                if (job->status == JOB_WAITING) {
+                    if (!dependencies_done(job)) {
+                        if (job->status == JOB_FAILED) progress = true;
+                        continue;
+                    }
+
+                    job->status = JOB_RUNNING;
+                }
+
+                advance_job(pool, job);
+
+                if (job->status != JOB_RUNNING) progress = true;
+            }
+        }
+
+        // NOTE: Longest processing time first: the commands with the longest estimated path to the
+        //       end of the build start first, so a slow command doesn't start last and stretch the build.
+        ready.size = 0;
+        FOR (pool->jobs, it) {
+            BuildJob *job = *it;
+            if (job->status != JOB_RUNNING || job->entity->status == ENTITY_STATUS_ERROR) continue;
+
+            FOR (job->runs, run) {
+                if (run->status == COMMAND_READY) append(&ready, run);
+            }
+        }
+
+        if (ready.size > 1) qsort(ready.data, ready.size, sizeof(CommandRun*), compare_critical_paths);
+
+        b32 launch_failed = false;
+        b32 shared = false;
+        FOR (ready, it) {
+            CommandRun *run = *it;
+
+            // NOTE: An earlier command of the same job may have failed to launch.
+            if (run->job->entity->status == ENTITY_STATUS_ERROR) continue;
+
+            if (share_compile(pool, run)) {
+                if (run->status == COMMAND_DONE) shared = true;
+                continue;
+            }
+
+            // NOTE: Sources are looked up as soon as they are ready, while others still compile.
+            if (needs_cache_lookup(pool, run)) {
+                if (pool->lookups_running >= pool->max_parallel) continue;
+                if (start_cache_lookup(pool, &launcher, run)) continue;
+            }
+
+            RemoteWorker *worker = pick_worker(pool, run);
+            if (worker && start_remote_command(pool, &launcher, run, worker)) continue;
+
+            // NOTE: Compiles later on might still go to a worker.
+            if (local_process_count(pool, &launcher) >= pool->max_parallel) {
+                if (pool->workers.size || pool->remote_cache != "" || pool->local_cache != "") continue;
+                break;
+            }
+
+            // NOTE: A smaller command later on might still fit.
+            if (!can_start_command(pool, &launcher, run)) continue;
+
+            // NOTE: The object may be a hard link into the local cache, also from a build before this one,
+            //       the compiler must not write into it.
+            if (is_cacheable(run)) platform_delete_file(run->job->entity->build_commands[run->index].outputs[0]);
+
+            start_command(&launcher, run);
+
+            if (run->status == COMMAND_RUNNING) {
+                run->reserved_memory = expected_memory(pool, run);
+                pool->reserved_memory += run->reserved_memory;
+            } else {
+                launch_failed = true;
+            }
+        }
+
+        // NOTE: Lets the jobs that failed to launch a command or copied an object finish.
+        if (launch_failed || shared) continue;
+
+        if (running_process_count(&launcher) == 0) break;
+
+        finished.size = 0;
+        wait_for_processes(&launcher, &finished);
+
+        FOR (finished, process) {
+            CommandRun *run = (CommandRun*)process->user_data;
+            BuildJob   *job = run->job;
+            BuildCommand *command = &job->entity->build_commands[run->index];
+
+            b32 cache_hit = run->cache_lookup;
+            if (run->cache_lookup) {
+                run->cache_lookup = false;
+                pool->lookups_running -= 1;
+
+                // NOTE: Runs for real in the next pass.
+                if (process->error || process->exit_code != 0) {
+                    run->cache_missed = !process->error && process->exit_code == CACHE_MISS_EXIT_CODE;
+                    run->status = COMMAND_READY;
+                    job->running_commands -= 1;
+                    pool->statistics.cache_misses += 1;
+
+                    destroy(process);
+                    continue;
+                }
+
+                pool->statistics.cache_hits += 1;
+            }
+
+            RemoteWorker *worker = run->worker;
+            if (worker) {
+                worker->running      -= 1;
+                pool->remote_running -= 1;
+                run->worker = 0;
+
+                // NOTE: The worker gets no more commands in this build, this one runs locally in the next pass.
+                if (!process->error && process->exit_code == REMOTE_UNAVAILABLE_EXIT_CODE) {
+                    if (!worker->unavailable) {
+                        print("NOTE: Worker %S:%d is not available, its compiles run locally.\n", worker->host, (s32)worker->port);
+                        worker->unavailable = true;
+                    }
+
+                    run->local_only = true;
+                    run->status = COMMAND_READY;
+                    job->running_commands -= 1;
+                    pool->statistics.fallback_count += 1;
+
+                    destroy(process);
+                    continue;
+                }
+
+                pool->statistics.remote_count += 1;
+            }
+
+            job->running_commands  -= 1;
+            job->finished_commands += 1;
+
+            pool->statistics.command_time [command->kind] += process->duration;
+            pool->statistics.command_count[command->kind] += 1;
+
+            pool->reserved_memory -= run->reserved_memory;
+            run->reserved_memory = 0;
+
+            // NOTE: A hit says nothing about how long the compile takes when the next build misses.
+            if (!cache_hit) run->duration = process->duration;
+
+            // NOTE: The memory of bricks remote_compile or cache_lookup says nothing about the compiler.
+            if (process->peak_memory > 0 && !worker && !cache_hit) {
+                run->peak_memory = process->peak_memory;
+
+                pool->known_memory       += process->peak_memory;
+                pool->known_memory_count += 1;
+
+                if (process->peak_memory > pool->statistics.peak_memory) pool->statistics.peak_memory = process->peak_memory;
+            }
+
+            run->status = COMMAND_DONE;
+            if (process->error) {
+                log_error("Could not run command %S.", command->command);
+
+                run->status = COMMAND_FAILED;
+            } else {
+                job->compiler->process_diagnostics(job->entity, process->output);
+
+                if (process->exit_code != 0) {
+                    if (job->entity->status != ENTITY_STATUS_ERROR) {
+                        add_diagnostic(job->entity, DIAG_ERROR, t_format("Command exited with code %d.", process->exit_code));
+                    }
+
+                    run->status = COMMAND_FAILED;
+                }
+            }
+
+            FOR (command->outputs, output) forget_file(&App.file_cache, *output);
+
+            // NOTE: Half written outputs would be up to date on the next build.
+            if (run->status == COMMAND_FAILED) {
+                job->entity->status = ENTITY_STATUS_ERROR;
+
+                FOR (command->outputs, output) platform_delete_file(*output);
+
+                if (command->outputs.size) {
+                    u64 *known = find(&pool->output_hashes, command->outputs[0]);
+                    if (known) *known = 0;
+                }
+            }
+
+            if (run->cache_missed) {
+                if (run->status == COMMAND_DONE) start_cache_upload(pool, &uploads, run);
+                else platform_delete_file(t_format("%S.cache_key", command->outputs[0]));
+
+                run->cache_missed = false;
+            }
+
+            if (run->status == COMMAND_DONE) finish_outputs(pool, run);
+
+            log_command(job, run, process->duration, process->error ? -1 : process->exit_code, cache_hit);
+
+            destroy(process);
+        }
+
+        if (running_process_count(&uploads)) {
+            finished.size = 0;
+            wait_for_processes(&uploads, &finished, 0);
+
+            FOR (finished, process) destroy(process);
+        }
+    }
+
+    pool->statistics.wall_time = platform_time_microseconds() - start_time;
+
+    // NOTE: The build is done, only the uploads that are left are waited for. Every upload gives up
+    //       after CACHE_UPLOAD_TIMEOUT_MS, so this is bounded by that after the last compile.
+    while (running_process_count(&uploads)) {
+        finished.size = 0;
+        wait_for_processes(&uploads, &finished);
+
+        FOR (finished, process) destroy(process);
+    }
+
+    if (pool->local_cache != "") read_cache_restores(cache_restore_log(workspace_folder()), &pool->statistics.local_cache);
+
+    b32 result = true;
+    FOR (pool->jobs, it) {
+        BuildJob *job = *it;
+
+        if (job->status == JOB_WAITING || job->status == JOB_RUNNING) {
+            add_diagnostic(job->entity, DIAG_ERROR, t_format("Circular dependency on %S.", job->entity->name));
+            finish_job(job);
+        }
+
+        if (job->status == JOB_FAILED) result = false;
+    }
+
+    return result;
+}
+
+INTERNAL s32 to_milliseconds(s64 microseconds) {
+    return (s32)(microseconds / 1000);
+}
+
+INTERNAL String debug_info_name(DebugInfoMode mode) {
+    switch (mode) {
+    case DEBUG_INFO_DEFAULT:    return "default";
+    case DEBUG_INFO_SPLIT:      return "split";
+    case DEBUG_INFO_COMPRESSED: return "compressed";
+    case DEBUG_INFO_MINIMAL:    return "minimal";
+    }
+
+    return {};
+}
+
+// NOTE: One line per link of an Entity with a debug_info field, to compare the modes by what they
+//       are for: the link time and the size of what is linked.
+INTERNAL void print_debug_info_links(JobPool *pool) {
+    FOR (pool->jobs, it) {
+        BuildJob *job = *it;
+        Entity *entity = job->entity;
+
+        if (entity->debug_info == DEBUG_INFO_DEFAULT) continue;
+
+        FOR (job->runs, run) {
+            BuildCommand *command = &entity->build_commands[run->index];
+            if (command->kind != COMMAND_LINK || run->status != COMMAND_DONE) continue;
+
+            SCOPE_TEMP_STORAGE();
+
+            s64 size = 0;
+            platform_file_size(entity->file_path, &size);
+
+            print("Linked %S with %S debug info in %d ms, %d MB", entity->name, debug_info_name(entity->debug_info), to_milliseconds(run->duration), (s32)(size / (1024 * 1024)));
+
+            s64 package_size = 0;
+            if (entity->debug_package && platform_file_size(t_format("%S.dwp", entity->file_path), &package_size)) {
+                print(" and %d MB in the .dwp", (s32)(package_size / (1024 * 1024)));
+            }
+
+            print(".\n");
+        }
+    }
+}
+
+void print_job_summary(JobPool *pool) {
+    JobStatistics *stats = &pool->statistics;
+
+    s32 command_count = 0;
+    for (s32 i = 0; i < COMMAND_KIND_COUNT; i += 1) command_count += stats->command_count[i];
+
+    if (command_count == 0) {
+        if (stats->skipped_count) print("\nAll %d commands are up to date.\n", stats->skipped_count);
+        if (create_profile())     print_file_cache_statistics(&App.file_cache);
+
+        return;
+    }
+
+    // NOTE: Command times add up over all parallel commands, so they can be larger than the wall time.
+    print("\nRan %d commands in %d ms: compile %d ms (%d), archive %d ms (%d), link %d ms (%d), other %d ms (%d).\n",
+          command_count, to_milliseconds(stats->wall_time),
+          to_milliseconds(stats->command_time[COMMAND_COMPILE]), stats->command_count[COMMAND_COMPILE],
+          to_milliseconds(stats->command_time[COMMAND_ARCHIVE]), stats->command_count[COMMAND_ARCHIVE],
+          to_milliseconds(stats->command_time[COMMAND_LINK]),    stats->command_count[COMMAND_LINK],
+          to_milliseconds(stats->command_time[COMMAND_CUSTOM]),  stats->command_count[COMMAND_CUSTOM]);
+
+    if (stats->skipped_count)   print("Skipped %d commands that were up to date.\n", stats->skipped_count);
+    if (stats->unchanged_count) print("%d commands wrote the same output as before.\n", stats->unchanged_count);
+    if (stats->remote_count)    print("%d compiles ran on workers.\n", stats->remote_count);
+    if (stats->fallback_count)  print("%d compiles ran locally after their worker failed.\n", stats->fallback_count);
+    if (stats->shared_count)    print("%d compiles took the object of the same compile in another entity.\n", stats->shared_count);
+    if (stats->cache_hits || stats->cache_misses) {
+        print("Cache: %d hits, %d misses, %d uploads.\n", stats->cache_hits, stats->cache_misses, stats->cache_uploads);
+    }
+    if (stats->local_cache.count) {
+        CacheRestoreStats *restores = &stats->local_cache;
+
+        // NOTE: Restores that share the data write nothing, their throughput is mostly the file system's metadata.
+        s64 megabytes_per_second = restores->time ? restores->size * 1000000 / restores->time / (1024 * 1024) : 0;
+
+        print("Local cache: restored %d objects, %d MB at %d MB/s: %d reflinked, %d hard linked, %d copied, %d of them compressed.\n",
+              restores->count, (s32)(restores->size / (1024 * 1024)), (s32)megabytes_per_second,
+              restores->method_counts[FILE_COPY_REFLINK], restores->method_counts[FILE_COPY_HARDLINK],
+              restores->method_counts[FILE_COPY_BYTES], restores->cold_count);
+
+        if (restores->shared_size) print("%d MB of objects were restored without copying.\n", (s32)(restores->shared_size / (1024 * 1024)));
+    }
+    if (stats->peak_memory)   print("The largest command used %d MB of memory.\n", (s32)(stats->peak_memory / (1024 * 1024)));
+
+    print_debug_info_links(pool);
+
+    if (create_profile()) print_file_cache_statistics(&App.file_cache);
+}
+
+INTERNAL void destroy_compiler_identities(JobPool *pool) {
+    for (s64 i = 0; i < pool->compiler_identities.alloc; i += 1) {
+        auto *entry = &pool->compiler_identities.entries[i];
+        if (entry->hash != 0) destroy(&entry->key);
+    }
+
+    destroy(&pool->compiler_identities);
+    pool->compiler_identities = {};
+}
+
+void reset_jobs(JobPool *pool) {
+    FOR (pool->jobs, it) {
+        BuildJob *job = *it;
+
+        job->status = JOB_WAITING;
+        job->running_commands  = 0;
+        job->finished_commands = 0;
+        job->skipped_commands  = 0;
+
+        // NOTE: The critical paths stay, they are still the best guess.
+        FOR (job->runs, run) {
+            run->previous_status = run->status;
+            run->status = COMMAND_WAITING;
+            run->local_only = false;
+            run->cache_checked = false;
+        }
+
+        job->entity->status = ENTITY_STATUS_UNBUILD;
+        job->entity->diagnostics.size = 0;
+    }
+
+    pool->statistics = {};
+    pool->reserved_memory = 0;
+
+    destroy(&pool->compiles);
+    pool->compiles = {};
+
+    pool->lookups_running = 0;
+    destroy_compiler_identities(pool);
+
+    // NOTE: Workers that failed get another chance.
+    FOR (pool->workers, worker) worker->unavailable = false;
+
+    forget_all_files(&App.file_cache);
+}
+
+void destroy(JobPool *pool) {
+    FOR (pool->jobs, job) {
+        FOR ((*job)->runs, run) destroy_discovered(run);
+
+        destroy(&(*job)->dependencies);
+        destroy(&(*job)->dependents);
+        destroy(&(*job)->runs);
+        destroy(&(*job)->command_records);
+        destroy(&(*job)->command_log);
+    }
+
+    destroy(&pool->jobs);
+    destroy(&pool->output_hashes);
+    destroy(&pool->compiles);
+    destroy(&pool->workers);
+
+    destroy_compiler_identities(pool);
+}
+
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "bricks.h"
+#include "blueprint.h"
+#include "process.h"
+#include "remote.h"
+#include "local_cache.h"
+#include "list.h"
+
+
+enum JobStatus {
+    JOB_WAITING,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED,
+};
+enum CommandStatus {
+    COMMAND_WAITING,
+    COMMAND_READY,   // NOTE: Dependencies are done and it's not up to date.
+    COMMAND_RUNNING,
+    COMMAND_DONE,
+    COMMAND_SKIPPED, // NOTE: Up to date.
+    COMMAND_FAILED,
+};
+struct BuildJob;
+struct CommandRun {
+    BuildJob *job;
+    s32 index;
+
+    CommandStatus status;
+
+    // NOTE: Peak memory of the last run in bytes, 0 if unknown. Comes from the command log until
+    //       the command ran. reserved_memory is what the pool counts for it while it runs.
+    s64 peak_memory;
+    s64 reserved_memory;
+
+    // NOTE: Microseconds. The duration of the last run, 0 if unknown, the estimate used instead
+    //       and the estimated time from the start of the command to the end of the build,
+    //       which decides what starts first.
+    s64 duration;
+    s64 estimated_duration;
+    s64 critical_path;
+
+    // NOTE: Hash of the content of the first output and of the content hashes of the inputs that
+    //       other commands wrote. Unchanged inputs don't make a command run, even if they are newer.
+    u64 content_hash;
+    u64 input_hash;
+
+    // NOTE: Watch mode: the status in the build before and the files read from the depfile.
+    CommandStatus previous_status;
+    List<String> discovered;
+
+    // NOTE: The worker compiling it, and whether it has to run locally because the worker failed.
+    RemoteWorker *worker;
+    b32 local_only;
+
+    // NOTE: Remote cache: the command runs bricks cache_lookup right now, was looked up already,
+    //       or the lookup missed and the object is uploaded once the command ran.
+    b32 cache_lookup;
+    b32 cache_checked;
+    b32 cache_missed;
+
+    // NOTE: Compiles only, the same for the same source with the same options in another entity,
+    //       see JobPool::compiles. Empty if the command can't be compared.
+    String fingerprint;
+};
+
+struct CommandRecord {
+    u64 hash;
+    u64 content;
+    u64 inputs;
+    s64 peak_memory;
+    s64 duration;
+};
+
+// NOTE: One job per Entity instance. The commands of an Entity run as soon as the
+//       commands they depend on are done. Jobs of different Entities and configurations
+//       share the same pool and run in parallel once their dependencies are done.
+struct BuildJob {
+    JobStatus status;
+
+    Blueprint *blueprint;
+    Entity    *entity;
+    Compiler  *compiler;
+
+    List<BuildJob*> dependencies;
+    List<BuildJob*> dependents;
+
+    List<CommandRun> runs;
+    s32 running_commands;
+    s32 finished_commands;
+    s32 skipped_commands;
+
+    // NOTE: Hashes, peak memory and duration of the command that last wrote an output, keyed by the first output.
+    //       Loaded from the intermediate folder, the keys point into command_log.
+    String command_log;
+    HashTable<String, CommandRecord> command_records;
+
+    s64 critical_path; // NOTE: Longest of the commands, or of the dependents if there are none.
+    b32 critical_path_done;
+    b32 critical_path_visiting;
+};
+
+struct JobStatistics {
+    s64 wall_time;
+
+    s64 command_time [COMMAND_KIND_COUNT];
+    s32 command_count[COMMAND_KIND_COUNT];
+
+    s32 skipped_count;
+    s32 unchanged_count; // NOTE: Commands that wrote the same output as before.
+
+    s64 peak_memory; // NOTE: Of the largest command.
+
+    s32 remote_count;
+    s32 fallback_count; // NOTE: Compiles that ran locally after their worker failed.
+
+    s32 cache_hits;
+    s32 cache_misses;
+    s32 cache_uploads;
+
+    s32 shared_count; // NOTE: Compiles that took the object of the same compile in another entity.
+
+    CacheRestoreStats local_cache;
+};
+
+struct JobPool {
+    List<BuildJob*> jobs;
+    s32 max_parallel;
+
+    // NOTE: Commands only start while the machine has room for them. 0 means no limit.
+    //       One command is always allowed to run, so the build can't stall.
+    r64 max_load;   // NOTE: Load average above which no new commands start.
+    s64 max_memory; // NOTE: Bytes the expected peak memory of all running commands can add up to.
+
+    s64 reserved_memory;
+    SystemLoad load; // NOTE: Sampled before every scheduling pass.
+
+    // NOTE: Commands without a recorded peak memory are expected to use the average of the known ones.
+    s64 known_memory;
+    s32 known_memory_count;
+
+    // NOTE: Watch mode keeps the files from depfiles, so they can be watched. After the first build
+    //       changed_files holds what the watcher reported, then commands that read none of them and
+    //       were fine before are up to date without looking at any file.
+    b32 watch;
+    HashTable<String, b32> *changed_files;
+
+    // NOTE: Content hash of the first output of every command that has one, 0 if unknown.
+    HashTable<String, u64> output_hashes;
+
+    // NOTE: A Brick is compiled into every entity that depends on it, usually with the same options.
+    //       Such compiles run once: the run that started first is kept by its fingerprint, the
+    //       others wait for it and copy its outputs. Keys point into CommandRun::fingerprint.
+    HashTable<String, CommandRun*> compiles;
+
+    // NOTE: Compiles go to the workers while they have free slots, they don't count against max_parallel.
+    //       The commands run executable as bricks remote_compile, which counts in remote_running.
+    List<RemoteWorker> workers;
+    s32 remote_running;
+    String executable;
+
+    // NOTE: Compiles look for their object in the local and remote cache first. The lookups have their own
+    //       limit of max_parallel, so the next sources are looked up while others compile.
+    String remote_cache;
+    b32 remote_cache_read_only;
+    String local_cache;
+    s32 lookups_running;
+
+    // NOTE: See compiler_identity. Cleared after every build, so an updated compiler gets new keys.
+    HashTable<String, u64> compiler_identities;
+
+    JobStatistics statistics;
+};
+
+
+BuildJob *create_job(JobPool *pool, Blueprint *blueprint, Entity *entity, Compiler *compiler);
+void add_job_dependency(BuildJob *job, BuildJob *dependency);
+
+// NOTE: Returns false if any job failed.
+b32 run_jobs(JobPool *pool);
+
+void print_job_summary(JobPool *pool);
+
+// NOTE: Lets run_jobs build the same jobs again, e.g. after files changed in watch mode.
+void reset_jobs(JobPool *pool);
+
+void destroy(JobPool *pool);
+
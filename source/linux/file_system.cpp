@@ -0,0 +1,306 @@
+#include "file_system.h"
+
+#include "c_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+
+
+b32 platform_list_folder(String folder, List<FolderEntry> *entries, Allocator alloc) {
+    char *path = to_c_string(folder);
+    DEFER(free(path));
+
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+    DEFER(closedir(dir));
+
+    while (dirent *entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+        FolderEntry result = {};
+        result.name      = allocate_string(String((u8*)entry->d_name, (s64)strlen(entry->d_name)), alloc);
+        result.is_folder = entry->d_type == DT_DIR;
+
+        // NOTE: Some file systems, e.g. older XFS and many network ones, don't fill in the type.
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat info = {};
+            if (fstatat(dirfd(dir), entry->d_name, &info, 0) == 0) result.is_folder = S_ISDIR(info.st_mode);
+        }
+
+        append(entries, result);
+    }
+
+    return true;
+}
+
+b32 platform_delete_file(String file) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    return unlink(path) == 0;
+}
+
+b32 platform_move_file(String from, String to) {
+    char *from_path = to_c_string(from);
+    char *to_path   = to_c_string(to);
+    DEFER(free(from_path));
+    DEFER(free(to_path));
+
+    return rename(from_path, to_path) == 0;
+}
+
+// NOTE: copy_file_range copies inside the kernel, and itself shares the data on file systems that
+//       can. Older kernels refuse files on different file systems, read and write work everywhere.
+INTERNAL b32 copy_bytes(int source, int target) {
+    while (true) {
+        ssize_t bytes = copy_file_range(source, 0, target, 0, MEGABYTES(64), 0);
+        if (bytes == 0) return true;
+        if (bytes > 0) continue;
+
+        if (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP) return false;
+        break;
+    }
+
+    u8 buffer[65536];
+    while (true) {
+        ssize_t bytes = read(source, buffer, sizeof(buffer));
+        if (bytes == 0) return true;
+        if (bytes < 0) return false;
+
+        for (ssize_t done = 0; done < bytes; ) {
+            ssize_t written = write(target, buffer + done, bytes - done);
+            if (written <= 0) return false;
+
+            done += written;
+        }
+    }
+}
+
+b32 platform_clone_file(String from, String to, b32 allow_link, FileCopyMethod *method) {
+    char *from_path = to_c_string(from);
+    char *to_path   = to_c_string(to);
+    DEFER(free(from_path));
+    DEFER(free(to_path));
+
+    int source = open(from_path, O_RDONLY | O_CLOEXEC);
+    if (source == -1) return false;
+    DEFER(close(source));
+
+    int target = open(to_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (target == -1) return false;
+
+    if (ioctl(target, FICLONE, source) == 0) {
+        close(target);
+
+        *method = FILE_COPY_REFLINK;
+        return true;
+    }
+
+    if (allow_link) {
+        close(target);
+        unlink(to_path);
+
+        if (link(from_path, to_path) == 0) {
+            *method = FILE_COPY_HARDLINK;
+            return true;
+        }
+
+        target = open(to_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (target == -1) return false;
+    }
+
+    b32 copied = copy_bytes(source, target);
+    close(target);
+
+    if (!copied) {
+        unlink(to_path);
+        return false;
+    }
+
+    *method = FILE_COPY_BYTES;
+    return true;
+}
+
+b32 platform_touch_file(String file) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    return utimensat(AT_FDCWD, path, 0, 0) == 0;
+}
+
+b32 platform_make_read_only(String file) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    return chmod(path, 0444) == 0;
+}
+
+b32 platform_file_age(String file, s64 *seconds) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    struct stat info = {};
+    if (stat(path, &info) != 0) return false;
+
+    struct timespec now = {};
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    *seconds = (s64)now.tv_sec - (s64)info.st_mtim.tv_sec;
+
+    return true;
+}
+
+b32 platform_file_time(String file, s64 *time) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    struct stat info = {};
+    if (stat(path, &info) != 0) return false;
+
+    *time = (s64)info.st_mtim.tv_sec * 1000000000 + (s64)info.st_mtim.tv_nsec;
+
+    return true;
+}
+
+b32 platform_file_size(String file, s64 *size) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    struct stat info = {};
+    if (stat(path, &info) != 0) return false;
+
+    *size = (s64)info.st_size;
+
+    return true;
+}
+
+// NOTE: statx is missing on kernels before 4.11, fstatat is used there instead.
+INTERNAL b32 has_statx = true;
+
+INTERNAL void stat_at(int folder, char const *name, FileInfo *info) {
+    *info = {};
+
+    if (has_statx) {
+        struct statx data = {};
+        if (statx(folder, name, AT_STATX_DONT_SYNC, STATX_TYPE | STATX_MTIME | STATX_SIZE, &data) == 0) {
+            info->exists    = true;
+            info->is_folder = S_ISDIR(data.stx_mode);
+            info->time      = (s64)data.stx_mtime.tv_sec * 1000000000 + (s64)data.stx_mtime.tv_nsec;
+            info->size      = (s64)data.stx_size;
+
+            return;
+        }
+
+        if (errno != ENOSYS) return;
+        has_statx = false;
+    }
+
+    struct stat data = {};
+    if (fstatat(folder, name, &data, 0) != 0) return;
+
+    info->exists    = true;
+    info->is_folder = S_ISDIR(data.st_mode);
+    info->time      = (s64)data.st_mtim.tv_sec * 1000000000 + (s64)data.st_mtim.tv_nsec;
+    info->size      = (s64)data.st_size;
+}
+
+void platform_file_info(String file, FileInfo *info) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    stat_at(AT_FDCWD, path, info);
+}
+
+INTERNAL s64 name_start(String file) {
+    for (s64 i = file.size; i > 0; i -= 1) {
+        if (file[i - 1] == '/') return i;
+    }
+
+    return 0;
+}
+
+s64 platform_file_infos(Array<String> files, FileInfo *infos) {
+    s64 calls = 0;
+
+    for (s64 i = 0; i < files.size; ) {
+        String folder = String(files[i].data, name_start(files[i]));
+
+        s64 end = i + 1;
+        while (end < files.size && name_start(files[end]) == folder.size && String(files[end].data, folder.size) == folder) end += 1;
+
+        // NOTE: Opening the folder costs two calls, so it only pays off for a few files.
+        int folder_fd = -1;
+        if (end - i > 2 && folder.size > 0) {
+            char *path = to_c_string(folder);
+            DEFER(free(path));
+
+            folder_fd = open(path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+            calls += 1;
+        }
+
+        for (; i < end; i += 1) {
+            String name = files[i];
+            if (folder_fd != -1) name = String(name.data + folder.size, name.size - folder.size);
+
+            char *path = to_c_string(name);
+            DEFER(free(path));
+
+            stat_at(folder_fd != -1 ? folder_fd : AT_FDCWD, path, &infos[i]);
+            calls += 1;
+        }
+
+        if (folder_fd != -1) {
+            close(folder_fd);
+            calls += 1;
+        }
+    }
+
+    return calls;
+}
+
+b32 platform_read_file_part(String file, s64 offset, void *buffer, s64 size) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    DEFER(close(fd));
+
+    s64 done = 0;
+    while (done < size) {
+        ssize_t bytes = pread(fd, (u8*)buffer + done, size - done, offset + done);
+        if (bytes <= 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
+
+b32 platform_append_to_file(String file, void const *data, s64 size) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) return false;
+    DEFER(close(fd));
+
+    s64 done = 0;
+    while (done < size) {
+        ssize_t bytes = write(fd, (u8 const*)data + done, size - done);
+        if (bytes <= 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
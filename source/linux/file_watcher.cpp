@@ -0,0 +1,191 @@
+#include "file_watcher.h"
+
+#include "c_string.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+
+struct WatchedFolder {
+    int watch;
+    String path;
+
+    List<String> files; // NOTE: Full names as they were given to platform_watch_file.
+    b32 entries;        // NOTE: Added or removed entries report path, see platform_watch_folder.
+};
+
+// NOTE: One inotify instance, one watch per folder.
+struct PlatformWatcher {
+    int inotify;
+
+    List<WatchedFolder> folders;
+};
+
+
+INTERNAL String folder_of(String file) {
+    for (s64 i = file.size; i > 0; i -= 1) {
+        if (file[i - 1] == '/') return String(file.data, i - 1);
+    }
+
+    return ".";
+}
+
+INTERNAL String name_of(String file) {
+    for (s64 i = file.size; i > 0; i -= 1) {
+        if (file[i - 1] == '/') return String(file.data + i, file.size - i);
+    }
+
+    return file;
+}
+
+INTERNAL WatchedFolder *watch_folder(FileWatcher *watcher, String folder) {
+    if (!watcher->platform) {
+        int inotify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        if (inotify == -1) return 0;
+
+        watcher->platform = (PlatformWatcher*)calloc(1, sizeof(PlatformWatcher));
+        watcher->platform->inotify = inotify;
+    }
+
+    PlatformWatcher *platform = watcher->platform;
+
+    WatchedFolder *watched = 0;
+    FOR (platform->folders, it) {
+        if (it->path == folder) {
+            watched = it;
+            break;
+        }
+    }
+
+    if (!watched) {
+        char *path = to_c_string(folder);
+        DEFER(free(path));
+
+        // NOTE: Writes are seen once the file is closed, saves through a temporary file as the rename.
+        u32 mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB;
+
+        int watch = inotify_add_watch(platform->inotify, path, mask);
+        if (watch == -1) return 0;
+
+        WatchedFolder new_folder = {};
+        new_folder.watch = watch;
+        new_folder.path  = allocate_string(folder, DefaultAllocator);
+
+        append(&platform->folders, new_folder);
+        watched = &platform->folders[platform->folders.size - 1];
+    }
+
+    return watched;
+}
+
+b32 platform_watch_file(FileWatcher *watcher, String file) {
+    WatchedFolder *watched = watch_folder(watcher, folder_of(file));
+    if (!watched) return false;
+
+    FOR (watched->files, it) {
+        if (*it == file) return true;
+    }
+
+    append(&watched->files, allocate_string(file, DefaultAllocator));
+
+    return true;
+}
+
+b32 platform_watch_folder(FileWatcher *watcher, String folder) {
+    WatchedFolder *watched = watch_folder(watcher, folder);
+    if (!watched) return false;
+
+    watched->entries = true;
+
+    return true;
+}
+
+INTERNAL void add_changed(List<String> *changed, String *file) {
+    FOR (*changed, other) {
+        if (other->data == file->data) return;
+    }
+
+    append(changed, *file);
+}
+
+// NOTE: Returns false on errors other than having nothing to read.
+INTERNAL b32 read_events(PlatformWatcher *platform, List<String> *changed) {
+    // NOTE: Aligned like the kernel expects it for struct inotify_event.
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (true) {
+        ssize_t bytes = read(platform->inotify, buffer, sizeof(buffer));
+        if (bytes == -1) return errno == EAGAIN || errno == EINTR;
+        if (bytes == 0)  return true;
+
+        for (char *it = buffer; it < buffer + bytes; ) {
+            inotify_event *event = (inotify_event*)it;
+            it += sizeof(inotify_event) + event->len;
+
+            if (event->len == 0) continue;
+
+            String name = String((u8*)event->name, (s64)strlen(event->name));
+
+            u32 entry_changed = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+            FOR (platform->folders, folder) {
+                if (folder->watch != event->wd) continue;
+
+                if (folder->entries && (event->mask & entry_changed)) add_changed(changed, &folder->path);
+
+                FOR (folder->files, file) {
+                    if (name_of(*file) == name) add_changed(changed, file);
+                }
+            }
+        }
+    }
+}
+
+b32 platform_wait_for_changes(FileWatcher *watcher, s32 debounce_ms, List<String> *changed) {
+    PlatformWatcher *platform = watcher->platform;
+    if (!platform) return false;
+
+    pollfd poll_fd = {};
+    poll_fd.fd     = platform->inotify;
+    poll_fd.events = POLLIN;
+
+    // NOTE: Events of files that aren't watched, e.g. objects next to sources, don't end the wait.
+    while (changed->size == 0) {
+        int ready = poll(&poll_fd, 1, -1);
+        if (ready == -1 && errno != EINTR) return false;
+
+        if (!read_events(platform, changed)) return false;
+    }
+
+    while (true) {
+        int ready = poll(&poll_fd, 1, debounce_ms);
+        if (ready == -1 && errno != EINTR) return false;
+        if (ready == 0) break;
+
+        if (!read_events(platform, changed)) return false;
+    }
+
+    return true;
+}
+
+void destroy(FileWatcher *watcher) {
+    PlatformWatcher *platform = watcher->platform;
+    if (!platform) return;
+
+    FOR (platform->folders, folder) {
+        FOR (folder->files, file) destroy(file);
+
+        destroy(&folder->files);
+        destroy(&folder->path);
+    }
+    destroy(&platform->folders);
+
+    close(platform->inotify);
+    free(platform);
+
+    watcher->platform = 0;
+}
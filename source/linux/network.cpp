@@ -0,0 +1,176 @@
+#include "network.h"
+
+#include "c_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+
+// NOTE: Returns 0 on timeout, -1 on errors.
+INTERNAL int wait_for(int fd, short events, s32 timeout_ms) {
+    pollfd poll_fd = {};
+    poll_fd.fd     = fd;
+    poll_fd.events = events;
+
+    while (true) {
+        int ready = poll(&poll_fd, 1, timeout_ms);
+        if (ready == -1 && errno == EINTR) continue;
+
+        return ready;
+    }
+}
+
+// NOTE: Requests and answers are written in one go, Nagle would only delay the last packet.
+INTERNAL void set_no_delay(int fd) {
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+b32 platform_listen(u16 port, Listener *listener) {
+    listener->socket = -1;
+
+    int fd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return false;
+
+    // NOTE: Accepts IPv4 as well, and a restarted worker doesn't have to wait for old connections.
+    int disable = 0, enable = 1;
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr   = in6addr_any;
+    address.sin6_port   = htons(port);
+
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+        close(fd);
+        return false;
+    }
+
+    listener->socket = fd;
+
+    return true;
+}
+
+b32 platform_accept(Listener *listener, s32 timeout_ms, Connection *connection) {
+    connection->socket = -1;
+
+    if (wait_for((int)listener->socket, POLLIN, timeout_ms) <= 0) return false;
+
+    int fd = accept4((int)listener->socket, 0, 0, SOCK_CLOEXEC);
+    if (fd == -1) return false;
+
+    set_no_delay(fd);
+    connection->socket = fd;
+
+    return true;
+}
+
+b32 platform_connect(String host, u16 port, s32 timeout_ms, Connection *connection) {
+    connection->socket = -1;
+
+    char *c_host = to_c_string(host);
+    DEFER(free(c_host));
+
+    char c_port[8] = {};
+    snprintf(c_port, sizeof(c_port), "%u", (u32)port);
+
+    addrinfo hints = {};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *addresses = 0;
+    if (getaddrinfo(c_host, c_port, &hints, &addresses) != 0) return false;
+    DEFER(freeaddrinfo(addresses));
+
+    for (addrinfo *it = addresses; it; it = it->ai_next) {
+        int fd = socket(it->ai_family, it->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, it->ai_protocol);
+        if (fd == -1) continue;
+
+        // NOTE: Non blocking, so an unreachable worker only costs the timeout.
+        b32 connected = connect(fd, it->ai_addr, it->ai_addrlen) == 0;
+        if (!connected && errno == EINPROGRESS && wait_for(fd, POLLOUT, timeout_ms) > 0) {
+            int error = 0;
+            socklen_t size = sizeof(error);
+            connected = getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) == 0 && error == 0;
+        }
+
+        if (!connected) {
+            close(fd);
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        set_no_delay(fd);
+
+        connection->socket = fd;
+        return true;
+    }
+
+    return false;
+}
+
+b32 platform_send(Connection *connection, void const *data, s64 size, s32 timeout_ms) {
+    s64 done = 0;
+    while (done < size) {
+        if (wait_for((int)connection->socket, POLLOUT, timeout_ms) <= 0) return false;
+
+        // NOTE: A closed connection is an error here, not a SIGPIPE.
+        ssize_t bytes = send((int)connection->socket, (u8 const*)data + done, size - done, MSG_NOSIGNAL);
+        if (bytes == -1 && errno == EINTR) continue;
+        if (bytes <= 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
+
+b32 platform_receive(Connection *connection, void *data, s64 size, s32 timeout_ms) {
+    s64 done = 0;
+    while (done < size) {
+        if (wait_for((int)connection->socket, POLLIN, timeout_ms) <= 0) return false;
+
+        ssize_t bytes = recv((int)connection->socket, (u8*)data + done, size - done, 0);
+        if (bytes == -1 && errno == EINTR) continue;
+        if (bytes <= 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
+
+s64 platform_receive_some(Connection *connection, void *data, s64 size, s32 timeout_ms) {
+    while (true) {
+        if (wait_for((int)connection->socket, POLLIN, timeout_ms) <= 0) return 0;
+
+        ssize_t bytes = recv((int)connection->socket, data, size, 0);
+        if (bytes == -1 && errno == EINTR) continue;
+
+        return bytes > 0 ? bytes : 0;
+    }
+}
+
+void platform_close(Connection *connection) {
+    if (connection->socket == -1) return;
+
+    close((int)connection->socket);
+    connection->socket = -1;
+}
+
+void platform_close(Listener *listener) {
+    if (listener->socket == -1) return;
+
+    close((int)listener->socket);
+    listener->socket = -1;
+}
@@ -0,0 +1,281 @@
+#include "process.h"
+
+#include "c_string.h"
+#include "string_builder.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+
+extern char **environ;
+
+
+// NOTE: Processes are started with posix_spawn, which uses vfork like clone in glibc, so
+//       launching doesn't copy the page tables of Bricks. The output of all children is read
+//       from one epoll instance.
+struct PlatformLauncher {
+    int epoll;
+};
+
+struct RunningProcess {
+    pid_t pid;
+    s32 pipe;
+    s64 index; // NOTE: In ProcessLauncher::running.
+
+    StringBuilder output;
+    void *user_data;
+
+    s64 start_time;
+};
+
+
+s32 platform_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count < 1) return 1;
+
+    return (s32)count;
+}
+
+b32 platform_system_load(SystemLoad *load) {
+    *load = {};
+
+    double average = 0;
+    if (getloadavg(&average, 1) == 1) load->load_average = average;
+
+    // NOTE: Files in /proc have no size, so they are read with one read call.
+    int file = open("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+    if (file == -1) return false;
+
+    char buffer[4096];
+    ssize_t bytes = read(file, buffer, sizeof(buffer) - 1);
+    close(file);
+
+    if (bytes <= 0) return false;
+    buffer[bytes] = '\0';
+
+    char const *line = strstr(buffer, "MemAvailable:");
+    if (!line) return false;
+
+    load->available_memory = (s64)strtoll(line + strlen("MemAvailable:"), 0, 10) * 1024; // NOTE: In kB.
+
+    return true;
+}
+
+s64 platform_time_microseconds() {
+    timespec time = {};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (s64)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+s64 platform_peak_memory() {
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    return (s64)usage.ru_maxrss * 1024; // NOTE: ru_maxrss is in kilobytes.
+}
+
+String platform_executable_path(Allocator alloc) {
+    char buffer[4096];
+    ssize_t size = readlink("/proc/self/exe", buffer, sizeof(buffer));
+    if (size <= 0 || size == sizeof(buffer)) return {};
+
+    return allocate_string(String((u8*)buffer, (s64)size), alloc);
+}
+
+s32 platform_process_id() {
+    return (s32)getpid();
+}
+
+INTERNAL b32 init_platform_launcher(ProcessLauncher *launcher) {
+    if (launcher->platform) return true;
+
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll == -1) return false;
+
+    launcher->platform = ALLOC(DefaultAllocator, PlatformLauncher, 1);
+    launcher->platform->epoll = epoll;
+
+    return true;
+}
+
+INTERNAL b32 spawn_shell(String command, int output, pid_t *pid) {
+    char *c_command = to_c_string(command);
+    DEFER(free(c_command));
+
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0) return false;
+    DEFER(posix_spawn_file_actions_destroy(&actions));
+
+    posix_spawn_file_actions_adddup2(&actions, output, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, output, STDERR_FILENO);
+
+    char sh[]   = "sh";
+    char flag[] = "-c";
+    char *argv[] = {sh, flag, c_command, 0};
+
+    return posix_spawn(pid, "/bin/sh", &actions, 0, argv, environ) == 0;
+}
+
+b32 launch_process(ProcessLauncher *launcher, String command, void *user_data) {
+    if (!init_platform_launcher(launcher)) return false;
+
+    // NOTE: Close on exec so other children don't keep the pipes of their siblings alive.
+    //       The read end doesn't block, so a process that writes a lot can't stall the others.
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1) return false;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    pid_t pid = 0;
+    b32 spawned = spawn_shell(command, fds[1], &pid);
+    close(fds[1]);
+
+    if (!spawned) {
+        close(fds[0]);
+        return false;
+    }
+
+    RunningProcess *process = ALLOC(DefaultAllocator, RunningProcess, 1);
+    process->pid   = pid;
+    process->pipe  = fds[0];
+    process->index = launcher->running.size;
+    process->user_data  = user_data;
+    process->start_time = platform_time_microseconds();
+
+    epoll_event event = {};
+    event.events   = EPOLLIN;
+    event.data.ptr = process;
+    epoll_ctl(launcher->platform->epoll, EPOLL_CTL_ADD, process->pipe, &event);
+
+    append(&launcher->running, process);
+
+    return true;
+}
+
+INTERNAL void finish_process(ProcessLauncher *launcher, RunningProcess *process, List<FinishedProcess> *finished) {
+    epoll_ctl(launcher->platform->epoll, EPOLL_CTL_DEL, process->pipe, 0);
+    close(process->pipe);
+
+    // NOTE: The pipe is closed once the process exits, so this doesn't block for long.
+    int status = 0;
+    rusage usage = {};
+    while (wait4(process->pid, &status, 0, &usage) == -1 && errno == EINTR);
+
+    FinishedProcess result = {};
+    result.user_data = process->user_data;
+    result.output    = to_allocated_string(&process->output, DefaultAllocator);
+    result.duration  = platform_time_microseconds() - process->start_time;
+
+    result.cpu_time  = (s64)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec;
+    result.cpu_time += (s64)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+    result.peak_memory = (s64)usage.ru_maxrss * 1024; // NOTE: ru_maxrss is in kilobytes.
+
+    if (WIFEXITED(status)) {
+        result.exit_code = WEXITSTATUS(status);
+        result.error     = result.exit_code == 127;
+    } else if (WIFSIGNALED(status)) {
+        result.exit_code = 128 + WTERMSIG(status);
+    }
+
+    append(finished, result);
+
+    RunningProcess *last = launcher->running[launcher->running.size - 1];
+    launcher->running[process->index] = last;
+    last->index = process->index;
+    launcher->running.size -= 1;
+
+    destroy(&process->output);
+    deallocate(DefaultAllocator, process, sizeof(RunningProcess));
+}
+
+// NOTE: Returns false once the pipe is closed.
+INTERNAL b32 read_output(RunningProcess *process) {
+    u8 buffer[KILOBYTES(16)];
+
+    while (true) {
+        ssize_t bytes = read(process->pipe, buffer, sizeof(buffer));
+
+        if (bytes > 0) {
+            append(&process->output, String(buffer, bytes));
+        } else if (bytes == 0) {
+            return false;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+}
+
+s32 wait_for_processes(ProcessLauncher *launcher, List<FinishedProcess> *finished, s32 timeout_ms) {
+    s32 count = 0;
+    if (launcher->running.size == 0) return count;
+
+    // NOTE: Output of a process that is still running can end the wait early, the timeout
+    //       isn't started again for that.
+    s64 start_time = platform_time_microseconds();
+
+    epoll_event events[64];
+    while (count == 0) {
+        s64 remaining = -1;
+        if (timeout_ms >= 0) {
+            remaining = timeout_ms - (platform_time_microseconds() - start_time) / 1000;
+            if (remaining < 0) remaining = 0;
+        }
+
+        int ready = epoll_wait(launcher->platform->epoll, events, 64, (int)remaining);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+
+            return count;
+        }
+        if (ready == 0) return count;
+
+        for (int i = 0; i < ready; i += 1) {
+            RunningProcess *process = (RunningProcess*)events[i].data.ptr;
+
+            if (!read_output(process)) {
+                finish_process(launcher, process, finished);
+                count += 1;
+            }
+        }
+    }
+
+    return count;
+}
+
+s32 running_process_count(ProcessLauncher *launcher) {
+    return (s32)launcher->running.size;
+}
+
+void destroy(ProcessLauncher *launcher) {
+    FOR (launcher->running, it) {
+        RunningProcess *process = *it;
+
+        close(process->pipe);
+        waitpid(process->pid, 0, 0);
+
+        destroy(&process->output);
+        deallocate(DefaultAllocator, process, sizeof(RunningProcess));
+    }
+
+    if (launcher->platform) {
+        close(launcher->platform->epoll);
+        deallocate(DefaultAllocator, launcher->platform, sizeof(PlatformLauncher));
+    }
+
+    destroy(&launcher->running);
+    destroy(&launcher->finished);
+}
+
+void destroy(FinishedProcess *process) {
+    destroy(&process->output);
+}
@@ -0,0 +1,38 @@
+#include "shared_library.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+
+
+b32 platform_load_library(SharedLibrary *library, String file) {
+    // NOTE: dlopen only looks into the library paths if there is no slash.
+    b32 has_slash = false;
+    for (s64 i = 0; i < file.size; i += 1) {
+        if (file[i] == '/') has_slash = true;
+    }
+
+    s64 offset = has_slash ? 0 : 2;
+    char *path = (char*)malloc(file.size + offset + 1);
+    memcpy(path, "./", offset);
+    memcpy(path + offset, file.data, file.size);
+    path[file.size + offset] = '\0';
+    DEFER(free(path));
+
+    library->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+
+    return library->handle != 0;
+}
+
+void *platform_find_symbol(SharedLibrary *library, char const *name) {
+    if (!library->handle) return 0;
+
+    return dlsym(library->handle, name);
+}
+
+void platform_unload_library(SharedLibrary *library) {
+    if (library->handle) dlclose(library->handle);
+
+    library->handle = 0;
+}
+
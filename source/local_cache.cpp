@@ -0,0 +1,294 @@
+#include "local_cache.h"
+
+#include "compression.h"
+#include "process.h"
+#include "platform.h"
+
+#include <string.h>
+
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+// NOTE: Only a broken entry would claim more, the object is decompressed in memory.
+#define LOCAL_CACHE_MAX_OBJECT_SIZE GIGABYTES(2)
+
+
+INTERNAL String entry_file(String folder, String kind, String key) {
+    return t_format("%S/%S/%S", folder, kind, key);
+}
+
+// NOTE: Lookups and uploads of the same entry can run at the same time, each writes its own file
+//       and moves it into place when it's complete. They are different processes, the counter
+//       keeps the files of one process apart.
+INTERNAL s32 temporary_file_count = 0;
+
+INTERNAL String temporary_file(String file) {
+    temporary_file_count += 1;
+
+    return t_format("%S.%d_%d.tmp", file, platform_process_id(), temporary_file_count);
+}
+
+INTERNAL b32 write_new_file(String file, void const *data, s64 size) {
+    String temporary = temporary_file(file);
+
+    platform_delete_file(temporary);
+    if (!platform_append_to_file(temporary, data, size)) {
+        platform_delete_file(temporary);
+        return false;
+    }
+
+    platform_make_read_only(temporary);
+
+    if (!platform_move_file(temporary, file)) {
+        platform_delete_file(temporary);
+        return false;
+    }
+
+    return true;
+}
+
+b32 local_cache_read(String folder, String kind, String key, String *content) {
+    auto read_result = platform_read_entire_file(entry_file(folder, kind, key));
+    if (read_result.error) return false;
+
+    *content = read_result.content;
+
+    return true;
+}
+
+b32 local_cache_write(String folder, String kind, String key, String content) {
+    return write_new_file(entry_file(folder, kind, key), content.data, content.size);
+}
+
+b32 local_cache_store(String folder, String hash, String file) {
+    String hot  = entry_file(folder, "cas", hash);
+    String cold = t_format("%S.lz4", hot);
+
+    FileInfo info = {};
+    platform_file_info(hot, &info);
+
+    if (info.exists) return platform_touch_file(hot);
+
+    platform_file_info(cold, &info);
+    if (info.exists) return true;
+
+    // NOTE: No hard link, the build may still write to its object.
+    String temporary = temporary_file(hot);
+    FileCopyMethod method = FILE_COPY_BYTES;
+    if (!platform_clone_file(file, temporary, false, &method)) return false;
+
+    platform_make_read_only(temporary);
+
+    if (!platform_move_file(temporary, hot)) {
+        platform_delete_file(temporary);
+        return false;
+    }
+
+    return true;
+}
+
+// NOTE: Makes the cold object hot again.
+INTERNAL b32 decompress_entry(String hot) {
+    String cold = t_format("%S.lz4", hot);
+
+    auto read_result = platform_read_entire_file(cold);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error || read_result.content.size < 8) return false;
+
+    s64 size = 0;
+    memcpy(&size, read_result.content.data, 8);
+
+    if (size < 0 || size > LOCAL_CACHE_MAX_OBJECT_SIZE) {
+        platform_delete_file(cold);
+        return false;
+    }
+
+    u8 *data = ALLOC(DefaultAllocator, u8, size + 1);
+    DEFER(deallocate(DefaultAllocator, data, size + 1));
+
+    if (!decompress(shrink_front(read_result.content, 8), data, size)) {
+        platform_delete_file(cold);
+        return false;
+    }
+
+    if (!write_new_file(hot, data, size)) return false;
+
+    platform_delete_file(cold);
+
+    return true;
+}
+
+b32 local_cache_restore(String folder, String hash, String target, CacheRestore *restore) {
+    *restore = {};
+
+    s64 start_time = platform_time_microseconds();
+
+    String hot = entry_file(folder, "cas", hash);
+
+    FileInfo info = {};
+    platform_file_info(hot, &info);
+
+    if (!info.exists) {
+        if (!decompress_entry(hot)) return false;
+        restore->cold = true;
+
+        platform_file_info(hot, &info);
+        if (!info.exists) return false;
+    }
+
+    platform_delete_file(target);
+    if (!platform_clone_file(hot, target, true, &restore->method)) return false;
+
+    // NOTE: Keeps the entry hot. A hard linked target gets a new time this way as well, the build
+    //       compares it with the times of the sources.
+    platform_touch_file(hot);
+
+    restore->size = info.size;
+    restore->time = platform_time_microseconds() - start_time;
+
+    return true;
+}
+
+String cache_restore_log(String workspace) {
+    return t_format("%S/.bricks/cache_restores", workspace);
+}
+
+// NOTE: One line per restore, short enough that lines of different processes don't mix.
+void log_cache_restore(String log, CacheRestore *restore) {
+    String line = t_format("%d %d %d %d\n", (s32)restore->method, (s32)restore->cold, (s32)restore->size, (s32)restore->time);
+
+    platform_append_to_file(log, line.data, line.size);
+}
+
+INTERNAL b32 read_number(String *text, s64 *value) {
+    while (text->size && (*text)[0] == ' ') *text = shrink_front(*text, 1);
+
+    s64 size = 0;
+    *value = 0;
+
+    while (size < text->size && (*text)[size] >= '0' && (*text)[size] <= '9') {
+        *value = *value * 10 + ((*text)[size] - '0');
+        size += 1;
+    }
+
+    *text = shrink_front(*text, size);
+
+    return size > 0;
+}
+
+void read_cache_restores(String log, CacheRestoreStats *stats) {
+    auto read_result = platform_read_entire_file(log);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return;
+    platform_delete_file(log);
+
+    String text = read_result.content;
+    while (text.size) {
+        s64 end = 0;
+        while (end < text.size && text[end] != '\n') end += 1;
+
+        String line = String(text.data, end);
+        text = shrink_front(text, end < text.size ? end + 1 : end);
+
+        s64 method = 0;
+        s64 cold = 0;
+        s64 size = 0;
+        s64 time = 0;
+        if (!read_number(&line, &method) || !read_number(&line, &cold) || !read_number(&line, &size) || !read_number(&line, &time)) continue;
+        if (method >= FILE_COPY_METHOD_COUNT) continue;
+
+        stats->count += 1;
+        stats->method_counts[method] += 1;
+        if (cold) stats->cold_count += 1;
+
+        stats->size += size;
+        stats->time += time;
+        if (method != FILE_COPY_BYTES) stats->shared_size += size;
+    }
+}
+
+INTERNAL b32 is_hot_entry(String name) {
+    if (name.size != 16) return false;
+
+    for (s64 i = 0; i < name.size; i += 1) {
+        if (!((name[i] >= '0' && name[i] <= '9') || (name[i] >= 'a' && name[i] <= 'f'))) return false;
+    }
+
+    return true;
+}
+
+INTERNAL b32 is_temporary(String name) {
+    return name.size > 4 && equal(shrink_front(name, name.size - 4), ".tmp");
+}
+
+INTERNAL s64 compress_entry(String hot) {
+    auto read_result = platform_read_entire_file(hot);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return 0;
+
+    String content = read_result.content;
+    s64 bound = compress_bound(content.size) + 8;
+
+    u8 *buffer = ALLOC(DefaultAllocator, u8, bound);
+    DEFER(deallocate(DefaultAllocator, buffer, bound));
+
+    memcpy(buffer, &content.size, 8);
+    s64 size = compress(content, buffer + 8) + 8;
+
+    // NOTE: Objects that hardly get smaller stay hot.
+    if (size + size / 8 >= content.size) return 0;
+
+    if (!write_new_file(t_format("%S.lz4", hot), buffer, size)) return 0;
+
+    platform_delete_file(hot);
+
+    return content.size - size;
+}
+
+s32 compress_cold_entries(String folder, s64 *saved) {
+    *saved = 0;
+
+    String stamp = t_format("%S/compressed", folder);
+
+    s64 age = 0;
+    if (platform_file_age(stamp, &age) && age < SECONDS_PER_DAY) return 0;
+
+    if (!platform_touch_file(stamp)) platform_append_to_file(stamp, "", 0);
+
+    String cas = t_format("%S/cas", folder);
+
+    List<FolderEntry> entries = {};
+    DEFER(destroy(&entries));
+    DEFER(FOR (entries, it) destroy(it));
+
+    platform_list_folder(cas, &entries, DefaultAllocator);
+
+    s32 count = 0;
+    FOR (entries, entry) {
+        if (entry->is_folder) continue;
+
+        SCOPE_TEMP_STORAGE();
+
+        String file = t_format("%S/%S", cas, entry->name);
+        if (!platform_file_age(file, &age)) continue;
+
+        // NOTE: Left behind by processes that were killed.
+        if (!is_hot_entry(entry->name)) {
+            if (age >= SECONDS_PER_DAY && is_temporary(entry->name)) platform_delete_file(file);
+            continue;
+        }
+
+        if (age < LOCAL_CACHE_COLD_DAYS * SECONDS_PER_DAY) continue;
+
+        s64 entry_saved = compress_entry(file);
+        if (entry_saved == 0) continue;
+
+        *saved += entry_saved;
+        count  += 1;
+    }
+
+    return count;
+}
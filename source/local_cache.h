@@ -0,0 +1,63 @@
+#pragma once
+
+#include "definitions.h"
+#include "string2.h"
+#include "file_system.h"
+
+
+// NOTE: --local_cache <folder>. The ac, cas and mf entries of the remote cache (see remote_cache.h)
+//       in a folder on this machine. bricks cache_lookup looks there before it asks the server and
+//       keeps what it downloads, bricks cache_upload stores every new object there as well.
+//
+//       Objects are hot or cold. Hot ones are stored as they are and restored with a reflink where
+//       the file system supports it, else a hard link, so a hit doesn't copy the object. The entries
+//       are read only, and a compile deletes its object before it runs, so a hard link is never
+//       written through. Objects nobody restored for LOCAL_CACHE_COLD_DAYS are compressed by
+//       compress_cold_entries (see compression.h) and become hot again when they are restored.
+//
+//       <folder>/ac/<key>, <folder>/mf/<key>  Same content as on the server.
+//       <folder>/cas/<hash>                   A hot object.
+//       <folder>/cas/<hash>.lz4               A cold one: its size as 8 bytes, then the compressed object.
+
+#define LOCAL_CACHE_COLD_DAYS 7
+
+struct CacheRestore {
+    FileCopyMethod method;
+    b32 cold; // NOTE: The object was decompressed first.
+
+    s64 size;
+    s64 time; // NOTE: Microseconds.
+};
+
+// NOTE: All restores of a build, see read_cache_restores.
+struct CacheRestoreStats {
+    s32 count;
+    s32 cold_count;
+    s32 method_counts[FILE_COPY_METHOD_COUNT];
+
+    s64 size;
+    s64 shared_size; // NOTE: Restored with a reflink or a hard link, without writing anything.
+    s64 time;
+};
+
+
+// NOTE: The keys and hashes are hex, like on the server. Content is allocated with the default allocator.
+b32 local_cache_read(String folder, String kind, String key, String *content);
+b32 local_cache_write(String folder, String kind, String key, String content);
+
+// NOTE: Stores file as the object with the hash. Shares the data with a reflink where it can.
+b32 local_cache_store(String folder, String hash, String file);
+
+// NOTE: Replaces target with the object. Returns false if it isn't in the cache.
+b32 local_cache_restore(String folder, String hash, String target, CacheRestore *restore);
+
+// NOTE: bricks cache_lookup runs in its own process, it reports its restores to the build in this file.
+String cache_restore_log(String workspace);
+void log_cache_restore(String log, CacheRestore *restore);
+
+// NOTE: Adds the restores in the log to stats and deletes it.
+void read_cache_restores(String log, CacheRestoreStats *stats);
+
+// NOTE: Looks at the folder at most once a day. Returns the number of entries it compressed and the
+//       bytes that saved.
+s32 compress_cold_entries(String folder, s64 *saved);
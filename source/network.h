@@ -0,0 +1,36 @@
+#pragma once
+
+#include "definitions.h"
+#include "string2.h"
+
+
+// NOTE: Blocking TCP connections for bricks worker and the commands sent to workers.
+//       The platform specific part lives in linux/network.cpp and win32/network.cpp.
+
+struct Connection {
+    s64 socket; // NOTE: -1 if closed.
+};
+
+struct Listener {
+    s64 socket; // NOTE: -1 if closed.
+};
+
+
+// NOTE: Listens on all interfaces.
+b32 platform_listen(u16 port, Listener *listener);
+
+// NOTE: Waits up to timeout_ms for a new connection, -1 waits until one comes.
+b32 platform_accept(Listener *listener, s32 timeout_ms, Connection *connection);
+
+b32 platform_connect(String host, u16 port, s32 timeout_ms, Connection *connection);
+
+// NOTE: Both transfer exactly size bytes. They fail if nothing could be sent or nothing arrived for timeout_ms.
+b32 platform_send(Connection *connection, void const *data, s64 size, s32 timeout_ms);
+b32 platform_receive(Connection *connection, void *data, s64 size, s32 timeout_ms);
+
+// NOTE: Receives whatever arrived, up to size bytes. Returns 0 if the connection was closed,
+//       failed or nothing arrived within timeout_ms.
+s64 platform_receive_some(Connection *connection, void *data, s64 size, s32 timeout_ms);
+
+void platform_close(Connection *connection);
+void platform_close(Listener *listener);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "definitions.h"
+#include "list.h"
+
+
+// NOTE: Launches many build commands at once and collects their output.
+//       The platform specific part lives in linux/process.cpp and win32/process.cpp.
+
+struct FinishedProcess {
+    void *user_data;
+
+    String output;
+    s32 exit_code;
+    b32 error; // NOTE: The command could not be started at all.
+
+    s64 duration; // NOTE: Wall clock time in microseconds.
+
+    // NOTE: 0 if unknown. On windows they are of the job the command ran in, see win32/process.cpp.
+    s64 cpu_time;    // NOTE: User and system time in microseconds.
+    s64 peak_memory; // NOTE: Peak resident set size in bytes.
+};
+
+struct RunningProcess;
+struct PlatformLauncher;
+struct ProcessLauncher {
+    List<RunningProcess*> running;
+    List<FinishedProcess> finished;
+
+    PlatformLauncher *platform; // NOTE: Created on the first launch.
+};
+
+
+// NOTE: Used to throttle new commands on busy machines. Values that are unknown stay 0.
+struct SystemLoad {
+    r64 load_average;     // NOTE: Of the last minute.
+    s64 available_memory; // NOTE: Bytes that can be used without swapping.
+};
+
+
+s32 platform_processor_count();
+b32 platform_system_load(SystemLoad *load);
+
+// NOTE: Monotonic, in microseconds. Only useful for differences.
+s64 platform_time_microseconds();
+
+// NOTE: The running Bricks executable, so it can run itself as a wrapper around commands.
+String platform_executable_path(Allocator alloc);
+
+// NOTE: Of the running Bricks, unique among the processes running at the same time.
+s32 platform_process_id();
+
+// NOTE: Peak resident set size of this process in bytes, the peak working set on windows.
+s64 platform_peak_memory();
+
+b32 launch_process(ProcessLauncher *launcher, String command, void *user_data);
+
+// NOTE: Blocks until at least one process finished and moves all finished ones into the list.
+//       Returns the number of processes added, 0 if none finished within timeout_ms.
+s32 wait_for_processes(ProcessLauncher *launcher, List<FinishedProcess> *finished, s32 timeout_ms = -1);
+
+s32 running_process_count(ProcessLauncher *launcher);
+
+void destroy(ProcessLauncher *launcher);
+void destroy(FinishedProcess *process);
+
@@ -0,0 +1,644 @@
+#include "remote.h"
+
+#include "network.h"
+#include "process.h"
+#include "file_system.h"
+#include "platform.h"
+#include "binary.h"
+#include "io.h"
+
+#include <string.h>
+
+
+extern ApplicationState App;
+
+
+#define REMOTE_PROTOCOL_VERSION 1
+
+#define WORKER_CONNECT_TIMEOUT_MS 1000
+#define WORKER_REQUEST_TIMEOUT_MS 10000
+
+// NOTE: How often a worker with free slots looks for new connections while compiling.
+#define WORKER_POLL_MS 20
+
+// NOTE: Limits for what a worker accepts, preprocessed sources can get large.
+#define REMOTE_MAX_FILES     16
+#define REMOTE_MAX_FILE_SIZE MEGABYTES(512)
+
+// NOTE: Exit code of a command the shell couldn't find.
+#define COMMAND_NOT_FOUND 127
+
+
+INTERNAL b32 parse_number(String text, s32 *value) {
+    if (text.size == 0 || text.size > 9) return false;
+
+    s32 result = 0;
+    for (s64 i = 0; i < text.size; i += 1) {
+        if (text[i] < '0' || text[i] > '9') return false;
+
+        result = result * 10 + (text[i] - '0');
+    }
+
+    *value = result;
+    return true;
+}
+
+b32 parse_worker(String text, s32 default_slots, RemoteWorker *worker) {
+    *worker = {};
+    worker->port  = DEFAULT_WORKER_PORT;
+    worker->slots = default_slots;
+
+    for (s64 i = text.size; i > 0; i -= 1) {
+        if (text[i - 1] == '/') {
+            s32 slots = 0;
+            if (!parse_number(String(text.data + i, text.size - i), &slots) || slots == 0) return false;
+
+            worker->slots = slots;
+            text.size = i - 1;
+            break;
+        }
+    }
+
+    String host = text;
+    String port = {};
+
+    if (text.size && text[0] == '[') {
+        s64 end = 1;
+        while (end < text.size && text[end] != ']') end += 1;
+        if (end == text.size) return false;
+
+        host = String(text.data + 1, end - 1);
+        if (end + 1 < text.size) {
+            if (text[end + 1] != ':') return false;
+            port = String(text.data + end + 2, text.size - end - 2);
+        }
+    } else {
+        for (s64 i = 0; i < text.size; i += 1) {
+            if (text[i] != ':') continue;
+
+            host = String(text.data, i);
+            port = String(text.data + i + 1, text.size - i - 1);
+            break;
+        }
+    }
+
+    if (host.size == 0) return false;
+
+    if (port.data) {
+        s32 number = 0;
+        if (!parse_number(port, &number) || number == 0 || number > 65535) return false;
+
+        worker->port = (u16)number;
+    }
+
+    worker->host = host;
+
+    return true;
+}
+
+
+// NOTE: Messages start with a magic and the version. Numbers are little endian, strings and
+//       files are a u32 size followed by the bytes.
+//       Request:  command, file count, files (name, content), output count, output names.
+//       Response: exit code, output, file count, files (name, exists, content).
+
+INTERNAL void write_message_header(StringBuilder *builder) {
+    append(builder, "BRKW");
+    write_binary(builder, (u32)REMOTE_PROTOCOL_VERSION);
+}
+
+INTERNAL void write_message_string(StringBuilder *builder, String str) {
+    write_binary(builder, (u32)str.size);
+    append(builder, str);
+}
+
+INTERNAL b32 send_message(Connection *connection, StringBuilder *builder, s32 timeout_ms) {
+    String message = to_allocated_string(builder, DefaultAllocator);
+    DEFER(destroy(&message));
+
+    return platform_send(connection, message.data, message.size, timeout_ms);
+}
+
+INTERNAL b32 receive_header(Connection *connection, s32 timeout_ms) {
+    char magic[4] = {};
+    u32 version = 0;
+
+    if (!platform_receive(connection, magic, sizeof(magic), timeout_ms)) return false;
+    if (!platform_receive(connection, &version, sizeof(version), timeout_ms)) return false;
+
+    return memcmp(magic, "BRKW", 4) == 0 && version == REMOTE_PROTOCOL_VERSION;
+}
+
+INTERNAL b32 receive_u32(Connection *connection, u32 *value, s32 timeout_ms) {
+    return platform_receive(connection, value, sizeof(*value), timeout_ms);
+}
+
+// NOTE: Allocated with the DefaultAllocator.
+INTERNAL b32 receive_string(Connection *connection, String *str, s32 timeout_ms) {
+    u32 size = 0;
+    if (!receive_u32(connection, &size, timeout_ms) || size > REMOTE_MAX_FILE_SIZE) return false;
+
+    *str = allocate_string(size, DefaultAllocator);
+    if (size == 0) return true;
+
+    if (!platform_receive(connection, str->data, size, timeout_ms)) {
+        destroy(str);
+        return false;
+    }
+
+    return true;
+}
+
+INTERNAL b32 write_file(String file, String content) {
+    platform_delete_file(file);
+
+    return platform_append_to_file(file, content.data, content.size);
+}
+
+
+// NOTE: Files sent to a worker only get a name, so nothing outside its folder can be written.
+INTERNAL b32 is_plain_name(String name) {
+    if (name.size == 0 || name.size > 255 || name[0] == '.') return false;
+
+    for (s64 i = 0; i < name.size; i += 1) {
+        u8 c = name[i];
+        if (c == '/' || c == '\\' || c == ':' || c == '"' || c < ' ') return false;
+    }
+
+    return true;
+}
+
+INTERNAL b32 starts_with_any(String str, String *prefixes, s64 count) {
+    for (s64 i = 0; i < count; i += 1) {
+        if (str.size >= prefixes[i].size && String(str.data, prefixes[i].size) == prefixes[i]) return true;
+    }
+
+    return false;
+}
+
+// NOTE: Splits a command at spaces outside of double quotes and removes the quotes, like sh and cmd
+//       do for the commands Bricks writes. The arguments are in text, which has the size of command.
+INTERNAL void split_arguments(String command, u8 *text, List<String> *arguments) {
+    b32 quoted = false;
+
+    s64 start = 0;
+    s64 size  = 0;
+
+    for (s64 i = 0; i <= command.size; i += 1) {
+        if (i == command.size || (command[i] == ' ' && !quoted)) {
+            if (size > start || (i > 0 && command[i - 1] == '"')) append(arguments, String(text + start, size - start));
+
+            start = size;
+            continue;
+        }
+
+        if (command[i] == '"') quoted = !quoted;
+        else                   text[size++] = command[i];
+    }
+}
+
+// NOTE: Anyone who can connect to a worker can make it run commands. Only a compile of files in the
+//       slot folder into object_name is run, without anything the shell would treat specially and
+//       without options that run other programs, load plugins, read options from files or name
+//       paths. Compiles with such options run locally, see start_remote_command.
+b32 is_worker_command(String command, String object_name) {
+    for (s64 i = 0; i < command.size; i += 1) {
+        switch (command[i]) {
+        case ';': case '&': case '|': case '`': case '$': case '<': case '>':
+        case '%': case '^': case '\n': case '\r':
+            return false;
+        }
+    }
+
+    u8 *text = ALLOC(DefaultAllocator, u8, command.size + 1);
+    DEFER(deallocate(DefaultAllocator, text, command.size + 1));
+
+    List<String> arguments = {};
+    DEFER(destroy(&arguments));
+
+    split_arguments(command, text, &arguments);
+    if (arguments.size == 0) return false;
+
+    String program = arguments[0];
+
+    // NOTE: A relative path could name a file that was sent with the request.
+    b32 is_absolute = program.size && (program[0] == '/' || (program.size > 2 && program[1] == ':' && (program[2] == '/' || program[2] == '\\')));
+    for (s64 i = 0; i < program.size; i += 1) {
+        if ((program[i] == '/' || program[i] == '\\') && !is_absolute) return false;
+    }
+
+    for (s64 i = program.size; i > 0; i -= 1) {
+        if (program[i - 1] == '/' || program[i - 1] == '\\') {
+            program = String(program.data + i, program.size - i);
+            break;
+        }
+    }
+
+    // NOTE: Cross compilers have a prefix, e.g. x86_64-w64-mingw32-gcc.
+    b32 is_compiler = false;
+
+    String compilers[] = {"gcc", "g++", "clang", "clang++"};
+    for (s64 i = 0; i < 4; i += 1) {
+        String name = compilers[i];
+        if (program.size < name.size) continue;
+
+        String end_of_program = String(program.data + program.size - name.size, name.size);
+        b32 has_prefix = program.size == name.size || program[program.size - name.size - 1] == '-';
+
+        if (end_of_program == name && has_prefix) is_compiler = true;
+    }
+
+    if (!is_compiler) return false;
+
+    // NOTE: Programs, plugins and files with more options, given with any name.
+    String forbidden[] = {
+        "-wrapper", "-fplugin", "-fpass-plugin", "-load", "-B", "-specs", "--specs", "--config", "-config",
+        "-X", "-Wl,", "-Wa,", "-Wp,", "-mllvm", "-ccc-", "--gcc-toolchain", "-gcc-toolchain", "--gcc-install-dir",
+        "-MF",
+    };
+
+    // NOTE: They only change the paths written into the object.
+    String path_maps[] = {"-ffile-prefix-map=", "-fdebug-prefix-map=", "-fmacro-prefix-map="};
+
+    b32 compile_only = false;
+    b32 has_output   = false;
+
+    for (s64 i = 1; i < arguments.size; i += 1) {
+        String argument = arguments[i];
+
+        if (argument == "-c") {
+            compile_only = true;
+            continue;
+        }
+
+        // NOTE: -o object.o or -oobject.o, nothing else is written outside the slot folder.
+        if (argument.size >= 2 && argument[0] == '-' && argument[1] == 'o') {
+            String output = shrink_front(argument, 2);
+            if (output.size == 0) {
+                if (i + 1 == arguments.size) return false;
+
+                i += 1;
+                output = arguments[i];
+            }
+
+            if (output != object_name || has_output) return false;
+
+            has_output = true;
+            continue;
+        }
+
+        if (argument.size && argument[0] == '-') {
+            if (starts_with_any(argument, forbidden, sizeof(forbidden) / sizeof(forbidden[0]))) return false;
+            if (starts_with_any(argument, path_maps, sizeof(path_maps) / sizeof(path_maps[0]))) continue;
+
+            for (s64 j = 0; j < argument.size; j += 1) {
+                if (argument[j] == '/' || argument[j] == '\\' || argument[j] == ':') return false;
+            }
+
+            continue;
+        }
+
+        // NOTE: The source, or the value of an option like -x c++. @file is not a plain name either.
+        if (!is_plain_name(argument) || argument[0] == '@') return false;
+    }
+
+    return compile_only && has_output;
+}
+
+struct WorkerSlot {
+    b32 used;
+    String folder;
+
+    Connection connection;
+
+    List<String> files;   // NOTE: Written into the folder, deleted once the answer was sent.
+    List<String> outputs; // NOTE: Names in the folder.
+};
+
+INTERNAL void clear_slot(WorkerSlot *slot) {
+    FOR (slot->files, file) {
+        platform_delete_file(*file);
+        destroy(file);
+    }
+    FOR (slot->outputs, output) {
+        platform_delete_file(t_format("%S/%S", slot->folder, *output));
+        destroy(output);
+    }
+
+    slot->files.size   = 0;
+    slot->outputs.size = 0;
+
+    platform_close(&slot->connection);
+    slot->used = false;
+}
+
+// NOTE: Writes the files of the request into the folder of the slot.
+INTERNAL b32 receive_request(WorkerSlot *slot, String *command) {
+    Connection *connection = &slot->connection;
+    s32 timeout = WORKER_REQUEST_TIMEOUT_MS;
+
+    if (!receive_header(connection, timeout)) return false;
+    if (!receive_string(connection, command, timeout)) return false;
+
+    u32 file_count = 0;
+    if (!receive_u32(connection, &file_count, timeout) || file_count > REMOTE_MAX_FILES) return false;
+
+    for (u32 i = 0; i < file_count; i += 1) {
+        String name    = {};
+        String content = {};
+        DEFER(destroy(&name));
+        DEFER(destroy(&content));
+
+        if (!receive_string(connection, &name, timeout) || !is_plain_name(name)) return false;
+        if (!receive_string(connection, &content, timeout)) return false;
+
+        String file = format(DefaultAllocator, "%S/%S", slot->folder, name);
+        append(&slot->files, file);
+
+        if (!write_file(file, content)) return false;
+    }
+
+    u32 output_count = 0;
+    if (!receive_u32(connection, &output_count, timeout) || output_count > REMOTE_MAX_FILES) return false;
+
+    for (u32 i = 0; i < output_count; i += 1) {
+        String name = {};
+        if (!receive_string(connection, &name, timeout)) return false;
+
+        // NOTE: clear_slot deletes the outputs, so only checked names are kept.
+        if (!is_plain_name(name)) {
+            destroy(&name);
+            return false;
+        }
+
+        append(&slot->outputs, name);
+    }
+
+    return slot->outputs.size == 1 && is_worker_command(*command, slot->outputs[0]);
+}
+
+INTERNAL void send_response(WorkerSlot *slot, s32 exit_code, String output) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    write_message_header(&builder);
+    write_binary(&builder, exit_code);
+    write_message_string(&builder, output);
+    write_binary(&builder, (u32)slot->outputs.size);
+
+    FOR (slot->outputs, name) {
+        auto read_result = platform_read_entire_file(t_format("%S/%S", slot->folder, *name));
+        DEFER(destroy(&read_result.content));
+
+        write_message_string(&builder, *name);
+        write_binary(&builder, (u8)(read_result.error ? 0 : 1));
+        write_message_string(&builder, read_result.error ? String() : read_result.content);
+    }
+
+    // NOTE: A client that gave up already is no reason to stop.
+    send_message(&slot->connection, &builder, WORKER_REQUEST_TIMEOUT_MS);
+}
+
+s32 run_worker(u16 port, s32 jobs) {
+    Listener listener = {};
+    if (!platform_listen(port, &listener)) {
+        print("Could not listen on port %d.\n", (s32)port);
+        return -1;
+    }
+    DEFER(platform_close(&listener));
+
+    WorkerSlot *slots = ALLOC(DefaultAllocator, WorkerSlot, jobs);
+    DEFER(deallocate(DefaultAllocator, slots, sizeof(WorkerSlot) * jobs));
+
+    // NOTE: Every slot compiles in its own folder, the files have the same names in all of them.
+    //       Workers started in the same folder differ by their port.
+    for (s32 i = 0; i < jobs; i += 1) {
+        slots[i] = {};
+        slots[i].folder = format(App.persistent_alloc, "%S/worker/%d/%d", App.build_files_folder, (s32)port, i);
+        slots[i].connection.socket = -1;
+
+        create_folders(&App.file_cache, slots[i].folder);
+    }
+
+    print("Worker listening on port %d, compiling up to %d sources at once.\n", (s32)port, jobs);
+    platform_flush_write_buffer(Console.out);
+
+    ProcessLauncher launcher = {};
+    DEFER(destroy(&launcher));
+
+    List<FinishedProcess> finished = {};
+    DEFER(destroy(&finished));
+
+    s32 running = 0;
+    while (true) {
+        // NOTE: Connections are only accepted while a slot is free, the others wait in the backlog.
+        while (running < jobs) {
+            WorkerSlot *slot = 0;
+            for (s32 i = 0; i < jobs && !slot; i += 1) {
+                if (!slots[i].used) slot = &slots[i];
+            }
+
+            if (!platform_accept(&listener, running ? 0 : -1, &slot->connection)) break;
+
+            String command = {};
+            DEFER(destroy(&command));
+
+            if (!receive_request(slot, &command)) {
+                clear_slot(slot);
+                continue;
+            }
+
+            // NOTE: The same for cmd and sh, the folder is on the same drive. The debug info names
+            //       the folder the compiler ran in, which is mapped to . like the workspace is locally.
+            String shell_command = t_format("cd \"%S\" && %S -fdebug-prefix-map=\"%S\"=.", slot->folder, command, slot->folder);
+
+            if (!launch_process(&launcher, shell_command, slot)) {
+                send_response(slot, COMMAND_NOT_FOUND, "Could not start the compiler.");
+                clear_slot(slot);
+                continue;
+            }
+
+            slot->used = true;
+            running += 1;
+        }
+
+        if (running == 0) continue;
+
+        finished.size = 0;
+        wait_for_processes(&launcher, &finished, running < jobs ? WORKER_POLL_MS : -1);
+
+        FOR (finished, process) {
+            WorkerSlot *slot = (WorkerSlot*)process->user_data;
+
+            send_response(slot, process->error ? COMMAND_NOT_FOUND : process->exit_code, process->output);
+            clear_slot(slot);
+
+            running -= 1;
+            destroy(process);
+        }
+    }
+
+    return 0;
+}
+
+
+// NOTE: One line per value, in this order. Commands never contain line breaks.
+enum RemoteJobLine {
+    REMOTE_JOB_HOST,
+    REMOTE_JOB_PORT,
+    REMOTE_JOB_TIMEOUT,
+    REMOTE_JOB_PREPROCESS,
+    REMOTE_JOB_COMPILE,
+    REMOTE_JOB_SOURCE,
+    REMOTE_JOB_SOURCE_NAME,
+    REMOTE_JOB_OBJECT,
+    REMOTE_JOB_OBJECT_NAME,
+
+    REMOTE_JOB_LINE_COUNT,
+};
+
+b32 write_remote_job(String file, RemoteWorker *worker, s32 timeout_ms, RemoteCompile *remote) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "%S\n%d\n%d\n", worker->host, (s32)worker->port, timeout_ms);
+    format(&builder, "%S\n%S\n", remote->preprocess, remote->compile);
+    format(&builder, "%S\n%S\n%S\n%S\n", remote->source, remote->source_name, remote->object, remote->object_name);
+
+    PlatformFile job_file = platform_file_open(file, PlatformFileOverride);
+    if (!job_file.open) return false;
+
+    write_builder_to_file(&builder, &job_file);
+    platform_file_close(&job_file);
+
+    return true;
+}
+
+// NOTE: Sends the preprocessed source and waits for the object.
+INTERNAL s32 compile_on_worker(String *lines, String source, s32 timeout_ms, String *output) {
+    s32 port = 0;
+    parse_number(lines[REMOTE_JOB_PORT], &port);
+
+    Connection connection = {};
+    if (!platform_connect(lines[REMOTE_JOB_HOST], (u16)port, WORKER_CONNECT_TIMEOUT_MS, &connection)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    DEFER(platform_close(&connection));
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    write_message_header(&builder);
+    write_message_string(&builder, lines[REMOTE_JOB_COMPILE]);
+    write_binary(&builder, (u32)1);
+    write_message_string(&builder, lines[REMOTE_JOB_SOURCE_NAME]);
+    write_message_string(&builder, source);
+    write_binary(&builder, (u32)1);
+    write_message_string(&builder, lines[REMOTE_JOB_OBJECT_NAME]);
+
+    if (!send_message(&connection, &builder, timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+
+    s32 exit_code = 0;
+    u32 file_count = 0;
+
+    if (!receive_header(&connection, timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    if (!platform_receive(&connection, &exit_code, sizeof(exit_code), timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    if (!receive_string(&connection, output, timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    if (!receive_u32(&connection, &file_count, timeout_ms) || file_count != 1) return REMOTE_UNAVAILABLE_EXIT_CODE;
+
+    // NOTE: The worker is missing the compiler.
+    if (exit_code == COMMAND_NOT_FOUND) return REMOTE_UNAVAILABLE_EXIT_CODE;
+
+    String name    = {};
+    String content = {};
+    u8 exists = 0;
+    DEFER(destroy(&name));
+    DEFER(destroy(&content));
+
+    if (!receive_string(&connection, &name, timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    if (!platform_receive(&connection, &exists, sizeof(exists), timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    if (!receive_string(&connection, &content, timeout_ms)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+
+    if (exit_code == 0) {
+        if (!exists) return REMOTE_UNAVAILABLE_EXIT_CODE;
+        if (!write_file(lines[REMOTE_JOB_OBJECT], content)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    }
+
+    return exit_code;
+}
+
+s32 run_remote_compile(String job_file) {
+    auto read_result = platform_read_entire_file(job_file);
+    DEFER(destroy(&read_result.content));
+    DEFER(platform_delete_file(job_file));
+
+    if (read_result.error) {
+        print("Could not read %S.\n", job_file);
+        return REMOTE_UNAVAILABLE_EXIT_CODE;
+    }
+
+    String lines[REMOTE_JOB_LINE_COUNT] = {};
+
+    String text = read_result.content;
+    for (s32 i = 0; i < REMOTE_JOB_LINE_COUNT; i += 1) {
+        s64 end = 0;
+        while (end < text.size && text[end] != '\n') end += 1;
+
+        lines[i] = String(text.data, end);
+        text = String(text.data + end, text.size - end);
+        if (text.size) text = shrink_front(text, 1);
+    }
+
+    s32 timeout_ms = 0;
+    if (!parse_number(lines[REMOTE_JOB_TIMEOUT], &timeout_ms) || lines[REMOTE_JOB_OBJECT_NAME] == "") {
+        print("%S is not a remote compile job.\n", job_file);
+        return REMOTE_UNAVAILABLE_EXIT_CODE;
+    }
+
+    // NOTE: Errors of the preprocessor are the same on every machine, they are reported right away.
+    ProcessLauncher launcher = {};
+    DEFER(destroy(&launcher));
+
+    List<FinishedProcess> finished = {};
+    DEFER(destroy(&finished));
+
+    String source = lines[REMOTE_JOB_SOURCE];
+    DEFER(platform_delete_file(source));
+
+    if (!launch_process(&launcher, lines[REMOTE_JOB_PREPROCESS], 0)) return REMOTE_UNAVAILABLE_EXIT_CODE;
+    while (finished.size == 0) wait_for_processes(&launcher, &finished);
+
+    FinishedProcess *preprocess = &finished[0];
+    DEFER(destroy(preprocess));
+
+    if (preprocess->error) return REMOTE_UNAVAILABLE_EXIT_CODE;
+
+    if (preprocess->exit_code != 0) {
+        print("%S", preprocess->output);
+        return preprocess->exit_code;
+    }
+
+    auto source_result = platform_read_entire_file(source);
+    DEFER(destroy(&source_result.content));
+
+    if (source_result.error) return REMOTE_UNAVAILABLE_EXIT_CODE;
+
+    String output = {};
+    DEFER(destroy(&output));
+
+    s32 exit_code = compile_on_worker(lines, source_result.content, timeout_ms, &output);
+
+    // NOTE: Nothing is printed when the command is run locally instead, it prints the same again.
+    if (exit_code != REMOTE_UNAVAILABLE_EXIT_CODE) {
+        print("%S%S", preprocess->output, output);
+    }
+
+    return exit_code;
+}
+
+void destroy(RemoteCompile *remote) {
+    destroy(&remote->preprocess);
+    destroy(&remote->compile);
+    destroy(&remote->source);
+    destroy(&remote->source_name);
+    destroy(&remote->object);
+    destroy(&remote->object_name);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "bricks.h"
+
+
+// NOTE: Distributed compiles. bricks worker runs on other machines and compiles preprocessed
+//       sources it gets over TCP. A build given --worker runs bricks remote_compile in place of
+//       compile commands, which preprocesses locally, sends the source to the worker and writes
+//       the object it gets back. Archives and links always run locally.
+
+#define DEFAULT_WORKER_PORT 7171
+
+// NOTE: Exit code of bricks remote_compile if the worker couldn't be reached, was too slow or
+//       couldn't run the compiler. The build runs the command locally then.
+#define REMOTE_UNAVAILABLE_EXIT_CODE 75
+
+// NOTE: Nothing arriving from a worker for this long counts as the worker failing.
+#define REMOTE_COMPILE_TIMEOUT_MS (5 * 60 * 1000)
+
+struct RemoteWorker {
+    String host;
+    u16 port;
+    s32 slots; // NOTE: Commands sent to it at once.
+
+    s32 running;
+    b32 unavailable; // NOTE: Failed once, it gets no more commands in this build.
+};
+
+
+// NOTE: host, host:port or host:port/slots, e.g. build-02:7171/16. IPv6 addresses go in brackets.
+b32 parse_worker(String text, s32 default_slots, RemoteWorker *worker);
+
+// NOTE: bricks worker. Only returns if it can't listen on the port.
+s32 run_worker(u16 port, s32 jobs);
+
+// NOTE: Whether a worker runs the compile command, which writes object_name. Anything that could
+//       read or write files outside the folder of the worker or run other programs is refused.
+b32 is_worker_command(String command, String object_name);
+
+// NOTE: Describes one compile for bricks remote_compile, see run_remote_compile.
+b32 write_remote_job(String file, RemoteWorker *worker, s32 timeout_ms, RemoteCompile *remote);
+
+// NOTE: bricks remote_compile <job file>. Exits with the exit code of the compiler on the worker
+//       or REMOTE_UNAVAILABLE_EXIT_CODE.
+s32 run_remote_compile(String job_file);
+
+void destroy(RemoteCompile *remote);
@@ -0,0 +1,565 @@
+#include "remote_cache.h"
+
+#include "http.h"
+#include "network.h"
+#include "process.h"
+#include "file_system.h"
+#include "file_cache.h"
+#include "blueprint.h"
+#include "core_compilers.h"
+#include "local_cache.h"
+#include "platform.h"
+#include "io.h"
+
+#include <string.h>
+
+
+extern ApplicationState App;
+
+
+// NOTE: A lookup that takes longer than compiling would doesn't help. The upload timeout is for all
+//       requests of one upload together, the end of a build waits for the uploads still running.
+#define CACHE_LOOKUP_TIMEOUT_MS 5000
+#define CACHE_UPLOAD_TIMEOUT_MS 10000
+#define CACHE_SERVER_TIMEOUT_MS 10000
+
+#define CACHE_SERVER_MAX_ENTRY_SIZE MEGABYTES(512)
+
+
+INTERNAL String to_hex(u64 hash) {
+    u8 digits[16];
+    for (s32 i = 15; i >= 0; i -= 1) {
+        digits[i] = "0123456789abcdef"[hash & 0xf];
+        hash >>= 4;
+    }
+
+    return t_format("%S", String(digits, 16));
+}
+
+INTERNAL b32 parse_hex(String text, u64 *value) {
+    if (text.size != 16) return false;
+
+    u64 result = 0;
+    for (s64 i = 0; i < text.size; i += 1) {
+        u8 c = text[i];
+
+        if      (c >= '0' && c <= '9') result = result * 16 + (c - '0');
+        else if (c >= 'a' && c <= 'f') result = result * 16 + (c - 'a' + 10);
+        else return false;
+    }
+
+    *value = result;
+    return true;
+}
+
+INTERNAL String key_file(String object) {
+    return t_format("%S.cache_key", object);
+}
+
+INTERNAL b32 write_file(String file, String content) {
+    platform_delete_file(file);
+
+    return platform_append_to_file(file, content.data, content.size);
+}
+
+// NOTE: The first word of the command, e.g. x86_64-w64-mingw32-gcc.
+INTERNAL String program_of(String command) {
+    s64 end = 0;
+    while (end < command.size && command[end] != ' ') end += 1;
+
+    return String(command.data, end);
+}
+
+
+// NOTE: One line per value, in this order. Commands never contain line breaks.
+enum CacheLookupLine {
+    CACHE_LOOKUP_URL,
+    CACHE_LOOKUP_LOCAL,
+    CACHE_LOOKUP_WORKSPACE,
+    CACHE_LOOKUP_COMPILER,
+    CACHE_LOOKUP_PREPROCESS,
+    CACHE_LOOKUP_COMPILE,
+    CACHE_LOOKUP_INPUT,
+    CACHE_LOOKUP_DEPFILE,
+    CACHE_LOOKUP_SOURCE,
+    CACHE_LOOKUP_OBJECT,
+
+    CACHE_LOOKUP_LINE_COUNT,
+};
+
+b32 write_cache_lookup(String file, String url, String local, u64 compiler, BuildCommand *command, RemoteCompile *remote) {
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "%S\n%S\n%S\n%S\n", url, local, workspace_folder(), to_hex(compiler));
+    format(&builder, "%S\n%S\n", remote->preprocess, remote->compile);
+    format(&builder, "%S\n%S\n", command->inputs[0], command->depfile);
+    format(&builder, "%S\n%S\n", remote->source, remote->object);
+
+    PlatformFile job_file = platform_file_open(file, PlatformFileOverride);
+    if (!job_file.open) return false;
+
+    write_builder_to_file(&builder, &job_file);
+    platform_file_close(&job_file);
+
+    return true;
+}
+
+// NOTE: Where the entries are looked up: the local cache first, then the server. Either can be missing.
+struct CacheStores {
+    String local;
+
+    HttpUrl url;
+    b32 remote;
+
+    String restore_log;
+};
+
+// NOTE: Entries found on the server are kept in the local cache.
+INTERNAL b32 get_entry(CacheStores *stores, String kind, u64 key, String *content) {
+    if (stores->local != "" && local_cache_read(stores->local, kind, to_hex(key), content)) return true;
+    if (!stores->remote) return false;
+
+    HttpResponse entry = {};
+    if (!http_request(&stores->url, "GET", t_format("/%S/%S", kind, to_hex(key)), "", CACHE_LOOKUP_TIMEOUT_MS, &entry)) return false;
+
+    if (entry.status != 200) {
+        destroy(&entry);
+        return false;
+    }
+
+    if (stores->local != "") local_cache_write(stores->local, kind, to_hex(key), entry.body);
+
+    *content = entry.body;
+
+    return true;
+}
+
+INTERNAL b32 restore_local_object(CacheStores *stores, u64 hash, s64 size, String object) {
+    CacheRestore restore = {};
+    if (!local_cache_restore(stores->local, to_hex(hash), object, &restore)) return false;
+
+    if (restore.size != size) {
+        platform_delete_file(object);
+        return false;
+    }
+
+    log_cache_restore(stores->restore_log, &restore);
+
+    return true;
+}
+
+// NOTE: Writes the object stored for the key. The content hash of downloads is checked, so a
+//       broken entry is a miss and not a broken build.
+INTERNAL b32 restore_object(CacheStores *stores, u64 key, String object) {
+    String entry = {};
+    DEFER(destroy(&entry));
+
+    if (!get_entry(stores, "ac", key, &entry) || entry.size < 18) return false;
+
+    u64 hash = 0;
+    if (!parse_hex(String(entry.data, 16), &hash) || entry[16] != ' ') return false;
+
+    s64 size = 0;
+    for (s64 i = 17; i < entry.size && entry[i] != '\n'; i += 1) {
+        if (entry[i] < '0' || entry[i] > '9') return false;
+
+        size = size * 10 + (entry[i] - '0');
+    }
+
+    if (stores->local != "" && restore_local_object(stores, hash, size, object)) return true;
+    if (!stores->remote) return false;
+
+    HttpResponse download = {};
+    DEFER(destroy(&download));
+
+    if (!http_request(&stores->url, "GET", t_format("/cas/%S", to_hex(hash)), "", CACHE_LOOKUP_TIMEOUT_MS, &download)) return false;
+    if (download.status != 200 || download.body.size != size || hash_content(download.body) != hash) return false;
+
+    if (!write_file(object, download.body)) return false;
+
+    // NOTE: The next build restores it from the local cache.
+    if (stores->local != "") local_cache_store(stores->local, to_hex(hash), object);
+
+    return true;
+}
+
+// NOTE: 0 if the file can't be read.
+INTERNAL u64 hash_file(String file) {
+    auto read_result = platform_read_entire_file(file);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return 0;
+
+    return hash_content(read_result.content);
+}
+
+// NOTE: Undoes map_workspace_paths for a single path.
+INTERNAL String local_path(String path, String workspace) {
+    if (path.size > 1 && path[0] == '.' && (path[1] == '/' || path[1] == '\\')) {
+        return t_format("%S%S", workspace, shrink_front(path, 1));
+    }
+
+    return path;
+}
+
+// NOTE: The action key of the object, then one line per file the preprocessor read: its content
+//       hash and its path, the workspace mapped to . like in the keys. Empty if the depfile is missing.
+INTERNAL String build_manifest(u64 action_key, String depfile, String workspace, Allocator alloc) {
+    auto read_result = platform_read_entire_file(depfile);
+    DEFER(destroy(&read_result.content));
+
+    if (read_result.error) return {};
+
+    List<String> files = {};
+    DEFER(destroy(&files));
+    DEFER(FOR (files, it) destroy(it));
+
+    parse_make_depfile(0, read_result.content, &files);
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "%S\n", to_hex(action_key));
+
+    FOR (files, file) {
+        u64 hash = hash_file(*file);
+        if (hash == 0) return {};
+
+        String path = map_workspace_paths(*file, workspace, DefaultAllocator);
+        DEFER(destroy(&path));
+
+        format(&builder, "%S %S\n", to_hex(hash), path);
+    }
+
+    return to_allocated_string(&builder, alloc);
+}
+
+INTERNAL void append_depfile_path(StringBuilder *builder, String path) {
+    append(builder, ' ');
+
+    for (s64 i = 0; i < path.size; i += 1) {
+        if (path[i] == ' ' || path[i] == '#') append(builder, '\\');
+        if (path[i] == '$') append(builder, '$');
+
+        append(builder, (char)path[i]);
+    }
+}
+
+// NOTE: Direct mode. The files the manifest lists are hashed, if none of them changed the object
+//       is restored without running the preprocessor. The depfile is written from the manifest.
+INTERNAL b32 restore_from_manifest(CacheStores *stores, u64 manifest_key, String workspace, String object, String depfile) {
+    String manifest = {};
+    DEFER(destroy(&manifest));
+
+    if (!get_entry(stores, "mf", manifest_key, &manifest) || manifest.size < 17) return false;
+
+    u64 action_key = 0;
+    if (!parse_hex(String(manifest.data, 16), &action_key)) return false;
+
+    StringBuilder dependencies = {};
+    DEFER(destroy(&dependencies));
+
+    format(&dependencies, "%S:", object);
+
+    String text = shrink_front(manifest, 17);
+    while (text.size) {
+        s64 end = 0;
+        while (end < text.size && text[end] != '\n') end += 1;
+
+        String line = String(text.data, end);
+        text = shrink_front(text, end < text.size ? end + 1 : end);
+
+        u64 hash = 0;
+        if (line.size < 18 || !parse_hex(String(line.data, 16), &hash) || line[16] != ' ') return false;
+
+        String file = local_path(shrink_front(line, 17), workspace);
+        if (hash_file(file) != hash) return false;
+
+        append_depfile_path(&dependencies, file);
+    }
+
+    append(&dependencies, '\n');
+
+    if (!restore_object(stores, action_key, object)) return false;
+
+    String dependency_text = to_allocated_string(&dependencies, DefaultAllocator);
+    DEFER(destroy(&dependency_text));
+
+    return write_file(depfile, dependency_text);
+}
+
+// NOTE: Runs one command and waits for it.
+INTERNAL b32 run_command(String command, FinishedProcess *result) {
+    *result = {};
+
+    ProcessLauncher launcher = {};
+    DEFER(destroy(&launcher));
+
+    List<FinishedProcess> finished = {};
+    DEFER(destroy(&finished));
+
+    if (!launch_process(&launcher, command, 0)) return false;
+    while (finished.size == 0) wait_for_processes(&launcher, &finished);
+
+    *result = finished[0];
+
+    return !result->error && result->exit_code == 0;
+}
+
+u64 compiler_identity(HashTable<String, u64> *known, String compile) {
+    String program = program_of(compile);
+
+    u64 *identity = find(known, program);
+    if (identity) return *identity;
+
+    FinishedProcess version = {};
+    DEFER(destroy(&version));
+
+    u64 result = run_command(t_format("%S --version", program), &version) ? hash_content(version.output) : 0;
+    insert(known, allocate_string(program, DefaultAllocator), result);
+
+    return result;
+}
+
+s32 run_cache_lookup(String job_file) {
+    auto read_result = platform_read_entire_file(job_file);
+    DEFER(destroy(&read_result.content));
+    DEFER(platform_delete_file(job_file));
+
+    if (read_result.error) return CACHE_MISS_EXIT_CODE;
+
+    String lines[CACHE_LOOKUP_LINE_COUNT] = {};
+
+    String text = read_result.content;
+    for (s32 i = 0; i < CACHE_LOOKUP_LINE_COUNT; i += 1) {
+        s64 end = 0;
+        while (end < text.size && text[end] != '\n') end += 1;
+
+        lines[i] = String(text.data, end);
+        text = String(text.data + end, text.size - end);
+        if (text.size) text = shrink_front(text, 1);
+    }
+
+    CacheStores stores = {};
+    stores.local  = lines[CACHE_LOOKUP_LOCAL];
+    stores.remote = lines[CACHE_LOOKUP_URL] != "" && parse_http_url(lines[CACHE_LOOKUP_URL], &stores.url);
+
+    if ((stores.local == "" && !stores.remote) || lines[CACHE_LOOKUP_OBJECT] == "") return CACHE_MISS_EXIT_CODE;
+
+    String workspace = lines[CACHE_LOOKUP_WORKSPACE];
+    stores.restore_log = cache_restore_log(workspace);
+
+    String depfile   = lines[CACHE_LOOKUP_DEPFILE];
+    String object    = lines[CACHE_LOOKUP_OBJECT];
+    String source    = lines[CACHE_LOOKUP_SOURCE];
+
+    platform_delete_file(key_file(object));
+
+    u64 compiler = 0;
+    if (!parse_hex(lines[CACHE_LOOKUP_COMPILER], &compiler) || compiler == 0) return CACHE_MISS_EXIT_CODE;
+
+    auto input_result = platform_read_entire_file(lines[CACHE_LOOKUP_INPUT]);
+    DEFER(destroy(&input_result.content));
+
+    if (input_result.error) return CACHE_MISS_EXIT_CODE;
+
+    // NOTE: The line markers and the prefix map name the workspace, which differs between checkouts.
+    String preprocess = map_workspace_paths(lines[CACHE_LOOKUP_PREPROCESS], workspace, DefaultAllocator);
+    String compile    = map_workspace_paths(lines[CACHE_LOOKUP_COMPILE],    workspace, DefaultAllocator);
+    DEFER(destroy(&preprocess));
+    DEFER(destroy(&compile));
+
+    // NOTE: The options of the preprocessor decide which files the source includes.
+    u64 manifest_key = hash_content(compiler, preprocess);
+    manifest_key = hash_content(manifest_key, compile);
+    manifest_key = hash_content(manifest_key, input_result.content);
+
+    if (restore_from_manifest(&stores, manifest_key, workspace, object, depfile)) return 0;
+
+    // NOTE: The compile reports the errors.
+    FinishedProcess preprocessor = {};
+    DEFER(destroy(&preprocessor));
+    DEFER(platform_delete_file(source));
+
+    if (!run_command(lines[CACHE_LOOKUP_PREPROCESS], &preprocessor)) return CACHE_MISS_EXIT_CODE;
+
+    auto source_result = platform_read_entire_file(source);
+    DEFER(destroy(&source_result.content));
+
+    if (source_result.error) return CACHE_MISS_EXIT_CODE;
+
+    String preprocessed = map_workspace_paths(source_result.content, workspace, DefaultAllocator);
+    DEFER(destroy(&preprocessed));
+
+    u64 action_key = hash_content(compiler, compile);
+    action_key = hash_content(action_key, preprocessed);
+
+    if (restore_object(&stores, action_key, object)) {
+        print("%S", preprocessor.output);
+        return 0;
+    }
+
+    // NOTE: The manifest is made now, from the files the preprocessor just read. Hashing them after
+    //       the compile could pair the object with headers that changed in between.
+    String manifest = build_manifest(action_key, depfile, workspace, DefaultAllocator);
+    DEFER(destroy(&manifest));
+
+    StringBuilder builder = {};
+    DEFER(destroy(&builder));
+
+    format(&builder, "%S\n%S\n%S", to_hex(action_key), to_hex(manifest_key), manifest);
+
+    PlatformFile file = platform_file_open(key_file(object), PlatformFileOverride);
+    if (file.open) {
+        write_builder_to_file(&builder, &file);
+        platform_file_close(&file);
+    }
+
+    return CACHE_MISS_EXIT_CODE;
+}
+
+// NOTE: deadline as returned by platform_time_microseconds.
+INTERNAL b32 put(HttpUrl *url, String path, String body, s64 deadline) {
+    s64 timeout_ms = (deadline - platform_time_microseconds()) / 1000;
+    if (timeout_ms <= 0) return false;
+
+    HttpResponse response = {};
+    DEFER(destroy(&response));
+
+    if (!http_request(url, "PUT", path, body, (s32)timeout_ms, &response)) return false;
+
+    return response.status / 100 == 2;
+}
+
+s32 run_cache_upload(String url_text, String local, String object) {
+    String file = key_file(object);
+    DEFER(platform_delete_file(file));
+
+    auto key_result = platform_read_entire_file(file);
+    DEFER(destroy(&key_result.content));
+
+    HttpUrl url = {};
+    b32 remote = url_text != "" && parse_http_url(url_text, &url);
+
+    if (key_result.error || key_result.content.size < 34 || (local == "" && !remote)) return 1;
+
+    // NOTE: The action key, the manifest key and the manifest, see run_cache_lookup.
+    String keys = key_result.content;
+    String manifest = shrink_front(keys, 34);
+
+    u64 action_key   = 0;
+    u64 manifest_key = 0;
+    if (!parse_hex(String(keys.data, 16), &action_key) || !parse_hex(String(keys.data + 17, 16), &manifest_key)) return 1;
+
+    auto object_result = platform_read_entire_file(object);
+    DEFER(destroy(&object_result.content));
+
+    if (object_result.error) return 1;
+
+    String content = object_result.content;
+    u64 hash = hash_content(content);
+
+    String action = t_format("%S %d\n", to_hex(hash), (s32)content.size);
+
+    // NOTE: Every entry only points to what was stored before it.
+    if (local != "") {
+        if (!local_cache_store(local, to_hex(hash), object)) return 1;
+        if (!local_cache_write(local, "ac", to_hex(action_key), action)) return 1;
+
+        if (manifest.size && !local_cache_write(local, "mf", to_hex(manifest_key), manifest)) return 1;
+    }
+
+    if (!remote) return 0;
+
+    s64 deadline = platform_time_microseconds() + CACHE_UPLOAD_TIMEOUT_MS * 1000;
+
+    if (!put(&url, t_format("/cas/%S", to_hex(hash)), content, deadline)) return 1;
+    if (!put(&url, t_format("/ac/%S", to_hex(action_key)), action, deadline)) return 1;
+
+    if (manifest.size && !put(&url, t_format("/mf/%S", to_hex(manifest_key)), manifest, deadline)) return 1;
+
+    return 0;
+}
+
+
+// NOTE: /anything/ac/<key>, /anything/cas/<hash> or /anything/mf/<key>, so the server can sit behind a prefix.
+INTERNAL b32 parse_cache_path(String path, String *kind, String *key) {
+    s64 slash = find_last(path, '/');
+    if (slash == -1) return false;
+
+    *key = shrink_front(path, slash + 1);
+
+    u64 ignored = 0;
+    if (!parse_hex(*key, &ignored)) return false;
+
+    String rest = String(path.data, slash);
+    if      (rest.size >= 3 && equal(shrink_front(rest, rest.size - 3), "/ac"))  *kind = "ac";
+    else if (rest.size >= 4 && equal(shrink_front(rest, rest.size - 4), "/cas")) *kind = "cas";
+    else if (rest.size >= 3 && equal(shrink_front(rest, rest.size - 3), "/mf"))  *kind = "mf";
+    else return false;
+
+    return true;
+}
+
+// NOTE: A reference server, it answers one request at a time. Anything that can serve and store
+//       files under these paths works as well, e.g. a web server with WebDAV.
+s32 run_cache_server(u16 port, String folder) {
+    Listener listener = {};
+    if (!platform_listen(port, &listener)) {
+        print("Could not listen on port %d.\n", (s32)port);
+        return -1;
+    }
+    DEFER(platform_close(&listener));
+
+    create_folders(&App.file_cache, t_format("%S/ac",  folder));
+    create_folders(&App.file_cache, t_format("%S/cas", folder));
+    create_folders(&App.file_cache, t_format("%S/mf",  folder));
+
+    print("Cache server listening on port %d, storing entries in %S.\n", (s32)port, folder);
+    platform_flush_write_buffer(Console.out);
+
+    while (true) {
+        Connection connection = {};
+        if (!platform_accept(&listener, -1, &connection)) continue;
+        DEFER(platform_close(&connection));
+
+        HttpRequest request = {};
+        DEFER(destroy(&request));
+
+        if (!receive_http_request(&connection, CACHE_SERVER_MAX_ENTRY_SIZE, CACHE_SERVER_TIMEOUT_MS, &request)) {
+            send_http_response(&connection, 400, "", CACHE_SERVER_TIMEOUT_MS);
+            continue;
+        }
+
+        String kind = {};
+        String key  = {};
+        if (!parse_cache_path(request.path, &kind, &key)) {
+            send_http_response(&connection, 404, "", CACHE_SERVER_TIMEOUT_MS);
+            continue;
+        }
+
+        // NOTE: Not temporary, the server runs for a long time.
+        String file = format(DefaultAllocator, "%S/%S/%S", folder, kind, key);
+        DEFER(destroy(&file));
+
+        if (request.method == "GET") {
+            auto read_result = platform_read_entire_file(file);
+            DEFER(destroy(&read_result.content));
+
+            if (read_result.error) send_http_response(&connection, 404, "", CACHE_SERVER_TIMEOUT_MS);
+            else                   send_http_response(&connection, 200, read_result.content, CACHE_SERVER_TIMEOUT_MS);
+        } else if (request.method == "PUT") {
+            // NOTE: Readers never see a half written entry.
+            String temporary = format(DefaultAllocator, "%S.tmp", file);
+            DEFER(destroy(&temporary));
+
+            b32 stored = write_file(temporary, request.body) && platform_move_file(temporary, file);
+            send_http_response(&connection, stored ? 201 : 500, "", CACHE_SERVER_TIMEOUT_MS);
+        } else {
+            send_http_response(&connection, 405, "", CACHE_SERVER_TIMEOUT_MS);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "bricks.h"
+
+
+// NOTE: Compile outputs shared over HTTP, e.g. filled by CI and used by everyone else.
+//       A build given --remote_cache runs bricks cache_lookup before a compile. It first looks for
+//       a manifest of the source, which lists the files it included last time with their content
+//       hashes. If none of them changed, the object is restored without running the preprocessor.
+//       Otherwise it preprocesses the source and asks for the object of that action key. On a miss
+//       the compile runs as usual and bricks cache_upload sends the object and a new manifest
+//       afterwards, without the build waiting for it. bricks cache_server is a small server that
+//       keeps the entries in a folder.
+//
+//       GET/PUT <url>/mf/<manifest key>  The action key, then "<content hash> <path>\n" per file.
+//       GET/PUT <url>/ac/<action key>    "<content hash> <size>\n" of the object.
+//       GET/PUT <url>/cas/<content hash> The object.
+//
+//       Keys and hashes are 16 lower case hex digits. Both keys hash the compiler version and the
+//       compile command without paths (see RemoteCompile). The manifest key adds the preprocess
+//       command and the source, the action key the preprocessed source. The workspace is replaced
+//       by map_workspace_paths in all of them and in the paths of the manifest.
+//
+//       With --local_cache the same entries are kept in a folder on this machine as well, which is
+//       looked at first and also works without a server, see local_cache.h.
+
+#define DEFAULT_CACHE_SERVER_PORT 7172
+
+// NOTE: Exit code of bricks cache_lookup if the compile has to run. The keys and the manifest are
+//       then in the key file of the object, which bricks cache_upload reads.
+#define CACHE_MISS_EXIT_CODE 76
+
+
+// NOTE: Hash of what the compiler of a compile command prints for --version, 0 if it can't be run.
+//       It is part of every key. Runs the compiler once and remembers the result in known, the
+//       keys are allocated with the DefaultAllocator.
+u64 compiler_identity(HashTable<String, u64> *known, String compile);
+
+// NOTE: Describes one lookup for bricks cache_lookup. url or local may be empty, compiler is
+//       the compiler_identity of the compile.
+b32 write_cache_lookup(String file, String url, String local, u64 compiler, BuildCommand *command, RemoteCompile *remote);
+
+// NOTE: bricks cache_lookup <job file>. Exits with 0 if the object was restored.
+s32 run_cache_lookup(String job_file);
+
+// NOTE: bricks cache_upload <url> <local cache> <object>. An empty url or folder isn't written to.
+s32 run_cache_upload(String url, String local, String object);
+
+// NOTE: bricks cache_server [--port N] [--folder F]. Only returns if it can't listen on the port.
+s32 run_cache_server(u16 port, String folder);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "definitions.h"
+
+
+// NOTE: Loading of shared objects / dlls. Implemented in linux/shared_library.cpp
+//       and win32/shared_library.cpp.
+
+struct SharedLibrary {
+    void *handle;
+};
+
+
+b32   platform_load_library(SharedLibrary *library, String file);
+void *platform_find_symbol(SharedLibrary *library, char const *name);
+void  platform_unload_library(SharedLibrary *library);
+
@@ -0,0 +1,281 @@
+#include "file_system.h"
+
+#include "c_string.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+b32 platform_list_folder(String folder, List<FolderEntry> *entries, Allocator alloc) {
+    // TODO: Use the wide char version.
+    char *pattern = to_c_string(folder, "\\*");
+    DEFER(free(pattern));
+
+    WIN32_FIND_DATAA data = {};
+    HANDLE handle = FindFirstFileA(pattern, &data);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    DEFER(FindClose(handle));
+
+    do {
+        String name = String((u8*)data.cFileName, lstrlenA(data.cFileName));
+        if (name == "." || name == "..") continue;
+
+        FolderEntry result = {};
+        result.name      = allocate_string(name, alloc);
+        result.is_folder = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+
+        append(entries, result);
+    } while (FindNextFileA(handle, &data));
+
+    return true;
+}
+
+b32 platform_delete_file(String file) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    if (DeleteFileA(path)) return true;
+
+    // NOTE: Unlike on linux read only files can't be deleted, see platform_make_read_only.
+    if (GetLastError() != ERROR_ACCESS_DENIED) return false;
+
+    DWORD attributes = GetFileAttributesA(path);
+    if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_READONLY)) return false;
+
+    return SetFileAttributesA(path, attributes & ~FILE_ATTRIBUTE_READONLY) && DeleteFileA(path);
+}
+
+b32 platform_move_file(String from, String to) {
+    char *from_path = to_c_string(from);
+    char *to_path   = to_c_string(to);
+    DEFER(free(from_path));
+    DEFER(free(to_path));
+
+    return MoveFileExA(from_path, to_path, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+// TODO: ReFS can share the data of two files with FSCTL_DUPLICATE_EXTENTS_TO_FILE, for now there
+//       are no reflinks on windows.
+// NOTE: No hard links either. The read only attribute belongs to the file, deleting one of its
+//       names clears it for all of them.
+b32 platform_clone_file(String from, String to, b32 allow_link, FileCopyMethod *method) {
+    char *from_path = to_c_string(from);
+    char *to_path   = to_c_string(to);
+    DEFER(free(from_path));
+    DEFER(free(to_path));
+
+    if (!CopyFileA(from_path, to_path, TRUE)) return false;
+
+    // NOTE: The copy keeps the attributes, it may be written to.
+    DWORD attributes = GetFileAttributesA(to_path);
+    if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_READONLY)) {
+        SetFileAttributesA(to_path, attributes & ~FILE_ATTRIBUTE_READONLY);
+    }
+
+    *method = FILE_COPY_BYTES;
+    return true;
+}
+
+b32 platform_touch_file(String file) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    HANDLE handle = CreateFileA(path, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    DEFER(CloseHandle(handle));
+
+    FILETIME now = {};
+    GetSystemTimeAsFileTime(&now);
+
+    return SetFileTime(handle, 0, 0, &now) != 0;
+}
+
+b32 platform_make_read_only(String file) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    DWORD attributes = GetFileAttributesA(path);
+    if (attributes == INVALID_FILE_ATTRIBUTES) return false;
+
+    return SetFileAttributesA(path, attributes | FILE_ATTRIBUTE_READONLY) != 0;
+}
+
+b32 platform_file_age(String file, s64 *seconds) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+
+    FILETIME now = {};
+    GetSystemTimeAsFileTime(&now);
+
+    // NOTE: File times count 100 nanoseconds.
+    s64 now_time  = ((s64)now.dwHighDateTime << 32) | (s64)now.dwLowDateTime;
+    s64 file_time = ((s64)data.ftLastWriteTime.dwHighDateTime << 32) | (s64)data.ftLastWriteTime.dwLowDateTime;
+
+    *seconds = (now_time - file_time) / 10000000;
+
+    return true;
+}
+
+b32 platform_file_time(String file, s64 *time) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+
+    *time = ((s64)data.ftLastWriteTime.dwHighDateTime << 32) | (s64)data.ftLastWriteTime.dwLowDateTime;
+
+    return true;
+}
+
+b32 platform_file_size(String file, s64 *size) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+
+    *size = ((s64)data.nFileSizeHigh << 32) | (s64)data.nFileSizeLow;
+
+    return true;
+}
+
+void platform_file_info(String file, FileInfo *info) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    *info = {};
+
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return;
+
+    info->exists    = true;
+    info->is_folder = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    info->time      = ((s64)data.ftLastWriteTime.dwHighDateTime << 32) | (s64)data.ftLastWriteTime.dwLowDateTime;
+    info->size      = ((s64)data.nFileSizeHigh << 32) | (s64)data.nFileSizeLow;
+}
+
+INTERNAL s64 name_start(String file) {
+    for (s64 i = file.size; i > 0; i -= 1) {
+        if (file[i - 1] == '/' || file[i - 1] == '\\') return i;
+    }
+
+    return 0;
+}
+
+// NOTE: NTFS names are case insensitive, the name in a blueprint might not match the one on disk.
+INTERNAL b32 same_name(String a, String b) {
+    if (a.size != b.size) return false;
+
+    for (s64 i = 0; i < a.size; i += 1) {
+        u8 c = a[i] >= 'A' && a[i] <= 'Z' ? a[i] + ('a' - 'A') : a[i];
+        u8 d = b[i] >= 'A' && b[i] <= 'Z' ? b[i] + ('a' - 'A') : b[i];
+
+        if (c != d) return false;
+    }
+
+    return true;
+}
+
+// NOTE: Windows can't look up files relative to a folder handle without the native API. Instead
+//       a folder with more than a few of the files is listed once, which brings the same times and
+//       sizes as GetFileAttributesEx. The directory entries are only behind for files that are
+//       open for writing, and the build waits for its own commands.
+s64 platform_file_infos(Array<String> files, FileInfo *infos) {
+    s64 calls = 0;
+
+    for (s64 i = 0; i < files.size; ) {
+        String folder = String(files[i].data, name_start(files[i]));
+
+        s64 end = i + 1;
+        while (end < files.size && name_start(files[end]) == folder.size && String(files[end].data, folder.size) == folder) end += 1;
+
+        if (end - i <= 2) {
+            calls += end - i;
+            for (; i < end; i += 1) platform_file_info(files[i], &infos[i]);
+
+            continue;
+        }
+
+        for (s64 j = i; j < end; j += 1) infos[j] = {};
+
+        char *pattern = to_c_string(folder, "*");
+        DEFER(free(pattern));
+
+        WIN32_FIND_DATAA data = {};
+        HANDLE handle = FindFirstFileExA(pattern, FindExInfoBasic, &data, FindExSearchNameMatch, 0, FIND_FIRST_EX_LARGE_FETCH);
+        calls += 1;
+
+        if (handle != INVALID_HANDLE_VALUE) {
+            do {
+                String name = String((u8*)data.cFileName, lstrlenA(data.cFileName));
+
+                for (s64 j = i; j < end; j += 1) {
+                    if (!same_name(String(files[j].data + folder.size, files[j].size - folder.size), name)) continue;
+
+                    FileInfo *info = &infos[j];
+                    info->exists    = true;
+                    info->is_folder = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+                    info->time      = ((s64)data.ftLastWriteTime.dwHighDateTime << 32) | (s64)data.ftLastWriteTime.dwLowDateTime;
+                    info->size      = ((s64)data.nFileSizeHigh << 32) | (s64)data.nFileSizeLow;
+                }
+            } while (FindNextFileA(handle, &data));
+
+            FindClose(handle);
+        }
+
+        i = end;
+    }
+
+    return calls;
+}
+
+b32 platform_read_file_part(String file, s64 offset, void *buffer, s64 size) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    DEFER(CloseHandle(handle));
+
+    s64 done = 0;
+    while (done < size) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset     = (DWORD)((offset + done) & 0xffffffff);
+        overlapped.OffsetHigh = (DWORD)((offset + done) >> 32);
+
+        DWORD bytes = 0;
+        DWORD count = (DWORD)(size - done > 0x40000000 ? 0x40000000 : size - done);
+        if (!ReadFile(handle, (u8*)buffer + done, count, &bytes, &overlapped) || bytes == 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
+
+b32 platform_append_to_file(String file, void const *data, s64 size) {
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    HANDLE handle = CreateFileA(path, FILE_APPEND_DATA, FILE_SHARE_READ, 0, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    DEFER(CloseHandle(handle));
+
+    s64 done = 0;
+    while (done < size) {
+        DWORD bytes = 0;
+        DWORD count = (DWORD)(size - done > 0x40000000 ? 0x40000000 : size - done);
+        if (!WriteFile(handle, (u8 const*)data + done, count, &bytes, 0) || bytes == 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
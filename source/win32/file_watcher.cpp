@@ -0,0 +1,260 @@
+#include "file_watcher.h"
+
+#include "c_string.h"
+
+#include <stdlib.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+// NOTE: Allocated one by one, the system writes into overlapped and buffer while a read is pending.
+struct WatchedFolder {
+    HANDLE handle;
+    OVERLAPPED overlapped;
+    b32 pending; // NOTE: A ReadDirectoryChangesW is running.
+
+    String path;
+    List<String> files; // NOTE: Full names as they were given to platform_watch_file.
+    b32 entries;        // NOTE: Added or removed entries report path, see platform_watch_folder.
+
+    alignas(DWORD) u8 buffer[16 * 1024];
+};
+
+// NOTE: One handle per folder, all completing on one port, so there is no limit of 64 like with
+//       WaitForMultipleObjects.
+struct PlatformWatcher {
+    HANDLE port;
+
+    List<WatchedFolder*> folders;
+};
+
+// NOTE: Writes, renames into the folder and deletes. Attribute changes don't change the contents.
+//       Folder names for the folders globs walk through.
+#define WATCH_FILTER (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE)
+
+
+INTERNAL b32 is_separator(u8 c) {
+    return c == '/' || c == '\\';
+}
+
+INTERNAL String folder_of(String file) {
+    for (s64 i = file.size; i > 0; i -= 1) {
+        if (is_separator(file[i - 1])) return String(file.data, i - 1);
+    }
+
+    return ".";
+}
+
+INTERNAL String name_of(String file) {
+    for (s64 i = file.size; i > 0; i -= 1) {
+        if (is_separator(file[i - 1])) return String(file.data + i, file.size - i);
+    }
+
+    return file;
+}
+
+// NOTE: NTFS names are case insensitive, the name in a blueprint might not match the one on disk.
+INTERNAL b32 same_name(String a, String b) {
+    if (a.size != b.size) return false;
+
+    for (s64 i = 0; i < a.size; i += 1) {
+        u8 c = a[i] >= 'A' && a[i] <= 'Z' ? a[i] + ('a' - 'A') : a[i];
+        u8 d = b[i] >= 'A' && b[i] <= 'Z' ? b[i] + ('a' - 'A') : b[i];
+
+        if (c != d) return false;
+    }
+
+    return true;
+}
+
+INTERNAL b32 start_read(WatchedFolder *folder) {
+    folder->overlapped = {};
+
+    BOOL result = ReadDirectoryChangesW(folder->handle, folder->buffer, sizeof(folder->buffer), FALSE, WATCH_FILTER, 0, &folder->overlapped, 0);
+    folder->pending = result != 0;
+
+    return folder->pending;
+}
+
+INTERNAL WatchedFolder *watch_folder(FileWatcher *watcher, String folder) {
+    if (!watcher->platform) {
+        HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, 0, 0, 1);
+        if (!port) return 0;
+
+        watcher->platform = (PlatformWatcher*)calloc(1, sizeof(PlatformWatcher));
+        watcher->platform->port = port;
+    }
+
+    PlatformWatcher *platform = watcher->platform;
+
+    WatchedFolder *watched = 0;
+    FOR (platform->folders, it) {
+        if (same_name((*it)->path, folder)) {
+            watched = *it;
+            break;
+        }
+    }
+
+    if (!watched) {
+        // TODO: Use the wide char version.
+        char *path = to_c_string(folder);
+        DEFER(free(path));
+
+        DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+        HANDLE handle = CreateFileA(path, FILE_LIST_DIRECTORY, share, 0, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, 0);
+        if (handle == INVALID_HANDLE_VALUE) return 0;
+
+        watched = (WatchedFolder*)calloc(1, sizeof(WatchedFolder));
+        watched->handle = handle;
+        watched->path   = allocate_string(folder, DefaultAllocator);
+
+        // NOTE: Added before anything can fail, so destroy closes the handle.
+        append(&platform->folders, watched);
+
+        if (!CreateIoCompletionPort(handle, platform->port, (ULONG_PTR)watched, 0)) return 0;
+        if (!start_read(watched)) return 0;
+    } else if (!watched->pending) {
+        if (!start_read(watched)) return 0;
+    }
+
+    return watched;
+}
+
+b32 platform_watch_file(FileWatcher *watcher, String file) {
+    WatchedFolder *watched = watch_folder(watcher, folder_of(file));
+    if (!watched) return false;
+
+    FOR (watched->files, it) {
+        if (*it == file) return true;
+    }
+
+    append(&watched->files, allocate_string(file, DefaultAllocator));
+
+    return true;
+}
+
+b32 platform_watch_folder(FileWatcher *watcher, String folder) {
+    WatchedFolder *watched = watch_folder(watcher, folder);
+    if (!watched) return false;
+
+    watched->entries = true;
+
+    return true;
+}
+
+INTERNAL void add_changed(List<String> *changed, String *file) {
+    FOR (*changed, other) {
+        if (other->data == file->data) return;
+    }
+
+    append(changed, *file);
+}
+
+INTERNAL void read_events(WatchedFolder *folder, DWORD bytes, List<String> *changed) {
+    // NOTE: The buffer overflowed and the changes are lost, so every file in the folder counts as changed.
+    if (bytes == 0) {
+        if (folder->entries) add_changed(changed, &folder->path);
+
+        FOR (folder->files, file) add_changed(changed, file);
+        return;
+    }
+
+    u8 *it = folder->buffer;
+    while (true) {
+        FILE_NOTIFY_INFORMATION *info = (FILE_NOTIFY_INFORMATION*)it;
+
+        if (folder->entries && info->Action != FILE_ACTION_MODIFIED) add_changed(changed, &folder->path);
+
+        if (info->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+            char name_buffer[MAX_PATH * 3];
+            int size = WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), name_buffer, sizeof(name_buffer), 0, 0);
+
+            String name = String((u8*)name_buffer, size);
+
+            FOR (folder->files, file) {
+                if (same_name(name_of(*file), name)) add_changed(changed, file);
+            }
+        }
+
+        if (info->NextEntryOffset == 0) break;
+        it += info->NextEntryOffset;
+    }
+}
+
+// NOTE: Returns 0 on timeout, -1 on errors.
+INTERNAL s32 wait_for_events(PlatformWatcher *platform, DWORD timeout_ms, List<String> *changed) {
+    DWORD bytes = 0;
+    ULONG_PTR key = 0;
+    OVERLAPPED *overlapped = 0;
+
+    BOOL result = GetQueuedCompletionStatus(platform->port, &bytes, &key, &overlapped, timeout_ms);
+    if (!overlapped) return GetLastError() == WAIT_TIMEOUT ? 0 : -1;
+
+    WatchedFolder *folder = (WatchedFolder*)key;
+    folder->pending = false;
+
+    // NOTE: The folder is gone or can't be read anymore. Its files changed in any case.
+    if (!result) {
+        if (folder->entries) add_changed(changed, &folder->path);
+
+        FOR (folder->files, file) add_changed(changed, file);
+        return 1;
+    }
+
+    read_events(folder, bytes, changed);
+
+    // NOTE: If this fails the read starts again once the next build watches its files again.
+    start_read(folder);
+
+    return 1;
+}
+
+b32 platform_wait_for_changes(FileWatcher *watcher, s32 debounce_ms, List<String> *changed) {
+    PlatformWatcher *platform = watcher->platform;
+    if (!platform) return false;
+
+    // NOTE: Events of files that aren't watched, e.g. objects next to sources, don't end the wait.
+    while (changed->size == 0) {
+        if (wait_for_events(platform, INFINITE, changed) == -1) return false;
+    }
+
+    while (true) {
+        s32 result = wait_for_events(platform, debounce_ms, changed);
+        if (result == -1) return false;
+        if (result == 0)  break;
+    }
+
+    return true;
+}
+
+void destroy(FileWatcher *watcher) {
+    PlatformWatcher *platform = watcher->platform;
+    if (!platform) return;
+
+    FOR (platform->folders, it) {
+        WatchedFolder *folder = *it;
+
+        // NOTE: The buffer is written until the cancelled read completed.
+        if (folder->pending) {
+            DWORD bytes = 0;
+            CancelIoEx(folder->handle, &folder->overlapped);
+            GetOverlappedResult(folder->handle, &folder->overlapped, &bytes, TRUE);
+        }
+
+        CloseHandle(folder->handle);
+
+        FOR (folder->files, file) destroy(file);
+
+        destroy(&folder->files);
+        destroy(&folder->path);
+
+        free(folder);
+    }
+    destroy(&platform->folders);
+
+    CloseHandle(platform->port);
+    free(platform);
+
+    watcher->platform = 0;
+}
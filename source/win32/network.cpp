@@ -0,0 +1,182 @@
+#include "network.h"
+
+#include "c_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+
+INTERNAL b32 init_winsock() {
+    static b32 initialized = false;
+    if (initialized) return true;
+
+    WSADATA data = {};
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+
+    initialized = true;
+    return true;
+}
+
+// NOTE: Returns 0 on timeout, -1 on errors.
+INTERNAL int wait_for(SOCKET socket, b32 write, s32 timeout_ms) {
+    WSAPOLLFD poll_fd = {};
+    poll_fd.fd     = socket;
+    poll_fd.events = write ? POLLOUT : POLLIN;
+
+    return WSAPoll(&poll_fd, 1, timeout_ms);
+}
+
+INTERNAL void set_no_delay(SOCKET socket) {
+    BOOL enable = TRUE;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (char const*)&enable, sizeof(enable));
+}
+
+b32 platform_listen(u16 port, Listener *listener) {
+    listener->socket = -1;
+    if (!init_winsock()) return false;
+
+    SOCKET socket_handle = socket(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
+    if (socket_handle == INVALID_SOCKET) return false;
+
+    DWORD disable = 0;
+    setsockopt(socket_handle, IPPROTO_IPV6, IPV6_V6ONLY, (char const*)&disable, sizeof(disable));
+
+    sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr   = in6addr_any;
+    address.sin6_port   = htons(port);
+
+    if (bind(socket_handle, (sockaddr*)&address, sizeof(address)) != 0 || listen(socket_handle, 64) != 0) {
+        closesocket(socket_handle);
+        return false;
+    }
+
+    listener->socket = (s64)socket_handle;
+
+    return true;
+}
+
+b32 platform_accept(Listener *listener, s32 timeout_ms, Connection *connection) {
+    connection->socket = -1;
+
+    if (wait_for((SOCKET)listener->socket, false, timeout_ms) <= 0) return false;
+
+    SOCKET socket_handle = accept((SOCKET)listener->socket, 0, 0);
+    if (socket_handle == INVALID_SOCKET) return false;
+
+    set_no_delay(socket_handle);
+    connection->socket = (s64)socket_handle;
+
+    return true;
+}
+
+b32 platform_connect(String host, u16 port, s32 timeout_ms, Connection *connection) {
+    connection->socket = -1;
+    if (!init_winsock()) return false;
+
+    char *c_host = to_c_string(host);
+    DEFER(free(c_host));
+
+    char c_port[8] = {};
+    snprintf(c_port, sizeof(c_port), "%u", (u32)port);
+
+    addrinfo hints = {};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *addresses = 0;
+    if (getaddrinfo(c_host, c_port, &hints, &addresses) != 0) return false;
+    DEFER(freeaddrinfo(addresses));
+
+    for (addrinfo *it = addresses; it; it = it->ai_next) {
+        SOCKET socket_handle = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if (socket_handle == INVALID_SOCKET) continue;
+
+        u_long non_blocking = 1;
+        ioctlsocket(socket_handle, FIONBIO, &non_blocking);
+
+        b32 connected = connect(socket_handle, it->ai_addr, (int)it->ai_addrlen) == 0;
+        if (!connected && WSAGetLastError() == WSAEWOULDBLOCK && wait_for(socket_handle, true, timeout_ms) > 0) {
+            int error = 0;
+            int size  = sizeof(error);
+            connected = getsockopt(socket_handle, SOL_SOCKET, SO_ERROR, (char*)&error, &size) == 0 && error == 0;
+        }
+
+        if (!connected) {
+            closesocket(socket_handle);
+            continue;
+        }
+
+        non_blocking = 0;
+        ioctlsocket(socket_handle, FIONBIO, &non_blocking);
+        set_no_delay(socket_handle);
+
+        connection->socket = (s64)socket_handle;
+        return true;
+    }
+
+    return false;
+}
+
+b32 platform_send(Connection *connection, void const *data, s64 size, s32 timeout_ms) {
+    s64 done = 0;
+    while (done < size) {
+        if (wait_for((SOCKET)connection->socket, true, timeout_ms) <= 0) return false;
+
+        s64 chunk = size - done;
+        if (chunk > MEGABYTES(1)) chunk = MEGABYTES(1);
+
+        int bytes = send((SOCKET)connection->socket, (char const*)data + done, (int)chunk, 0);
+        if (bytes <= 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
+
+b32 platform_receive(Connection *connection, void *data, s64 size, s32 timeout_ms) {
+    s64 done = 0;
+    while (done < size) {
+        if (wait_for((SOCKET)connection->socket, false, timeout_ms) <= 0) return false;
+
+        s64 chunk = size - done;
+        if (chunk > MEGABYTES(1)) chunk = MEGABYTES(1);
+
+        int bytes = recv((SOCKET)connection->socket, (char*)data + done, (int)chunk, 0);
+        if (bytes <= 0) return false;
+
+        done += bytes;
+    }
+
+    return true;
+}
+
+s64 platform_receive_some(Connection *connection, void *data, s64 size, s32 timeout_ms) {
+    if (wait_for((SOCKET)connection->socket, false, timeout_ms) <= 0) return 0;
+
+    if (size > MEGABYTES(1)) size = MEGABYTES(1);
+
+    int bytes = recv((SOCKET)connection->socket, (char*)data, (int)size, 0);
+
+    return bytes > 0 ? bytes : 0;
+}
+
+void platform_close(Connection *connection) {
+    if (connection->socket == -1) return;
+
+    closesocket((SOCKET)connection->socket);
+    connection->socket = -1;
+}
+
+void platform_close(Listener *listener) {
+    if (listener->socket == -1) return;
+
+    closesocket((SOCKET)listener->socket);
+    listener->socket = -1;
+}
@@ -0,0 +1,400 @@
+#include "process.h"
+
+#include "platform.h"
+#include "string_builder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h> // NOTE: Resolves to K32GetProcessMemoryInfo in kernel32, no Psapi.lib needed.
+
+
+// NOTE: Commands run in cmd like they run in sh on linux. Their output is read from a named pipe
+//       with overlapped reads, so a single WaitForMultipleObjects waits for the output and the exit
+//       of all children. The process is waited for as well, programs started by the command can
+//       keep the pipe open after it exited, e.g. mspdbsrv started by cl.
+//
+//       Every command runs in its own job object. cmd starts the actual command as its child, the
+//       job has the time and memory of both.
+struct PlatformLauncher {
+    u32 pipe_count; // NOTE: Makes the names of the pipes unique.
+};
+
+struct RunningProcess {
+    HANDLE process;
+    HANDLE job;
+
+    HANDLE pipe;
+    OVERLAPPED overlapped;
+    b32 pipe_closed;
+    u8 buffer[KILOBYTES(16)];
+
+    s64 index; // NOTE: In ProcessLauncher::running.
+
+    StringBuilder output;
+    void *user_data;
+
+    s64 start_time;
+};
+
+// NOTE: Exit code of cmd for a command it couldn't find.
+#define COMMAND_NOT_FOUND 9009
+
+// NOTE: WaitForMultipleObjects takes at most MAXIMUM_WAIT_OBJECTS handles, two per process.
+//       With more processes only the first ones are waited for, in slices of this length,
+//       and all of them are checked after every slice.
+#define WAIT_SLICE_MS 10
+
+
+s32 platform_processor_count() {
+    SYSTEM_INFO info = {};
+    GetSystemInfo(&info);
+
+    if (info.dwNumberOfProcessors < 1) return 1;
+
+    return (s32)info.dwNumberOfProcessors;
+}
+
+// NOTE: Windows has no load average, only memory is known.
+b32 platform_system_load(SystemLoad *load) {
+    *load = {};
+
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) return false;
+
+    load->available_memory = (s64)status.ullAvailPhys;
+
+    return true;
+}
+
+s64 platform_time_microseconds() {
+    LARGE_INTEGER frequency = {};
+    LARGE_INTEGER counter   = {};
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (s64)(counter.QuadPart / frequency.QuadPart * 1000000 + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+}
+
+// NOTE: The peak working set, which is what the resident set size is on linux.
+s64 platform_peak_memory() {
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+
+    return (s64)counters.PeakWorkingSetSize;
+}
+
+String platform_executable_path(Allocator alloc) {
+    char buffer[MAX_PATH];
+    DWORD size = GetModuleFileNameA(0, buffer, sizeof(buffer));
+    if (size == 0 || size == sizeof(buffer)) return {};
+
+    return allocate_string(String((u8*)buffer, (s64)size), alloc);
+}
+
+s32 platform_process_id() {
+    return (s32)GetCurrentProcessId();
+}
+
+INTERNAL b32 init_platform_launcher(ProcessLauncher *launcher) {
+    if (launcher->platform) return true;
+
+    launcher->platform = ALLOC(DefaultAllocator, PlatformLauncher, 1);
+
+    return launcher->platform != 0;
+}
+
+// NOTE: Anonymous pipes can't be read with overlapped reads, so every process gets a named pipe.
+//       Only the write end is inheritable.
+INTERNAL b32 create_output_pipe(ProcessLauncher *launcher, HANDLE *read, HANDLE *write) {
+    char name[128];
+    snprintf(name, sizeof(name), "\\\\.\\pipe\\bricks-%lu-%u", GetCurrentProcessId(), launcher->platform->pipe_count);
+    launcher->platform->pipe_count += 1;
+
+    *read = CreateNamedPipeA(name, PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                             PIPE_TYPE_BYTE | PIPE_WAIT, 1, 0, KILOBYTES(64), 0, 0);
+    if (*read == INVALID_HANDLE_VALUE) return false;
+
+    SECURITY_ATTRIBUTES attributes = {};
+    attributes.nLength        = sizeof(attributes);
+    attributes.bInheritHandle = TRUE;
+
+    *write = CreateFileA(name, GENERIC_WRITE, 0, &attributes, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (*write == INVALID_HANDLE_VALUE) {
+        CloseHandle(*read);
+        return false;
+    }
+
+    return true;
+}
+
+// NOTE: Only the pipe is inherited, so other children don't keep the pipes of their siblings alive.
+//       The process starts suspended, it is resumed once it is in its job.
+INTERNAL b32 spawn_shell(String command, HANDLE output, PROCESS_INFORMATION *info) {
+    SIZE_T list_size = 0;
+    InitializeProcThreadAttributeList(0, 1, 0, &list_size);
+
+    LPPROC_THREAD_ATTRIBUTE_LIST list = (LPPROC_THREAD_ATTRIBUTE_LIST)malloc(list_size);
+    DEFER(free(list));
+
+    if (!InitializeProcThreadAttributeList(list, 1, 0, &list_size)) return false;
+    DEFER(DeleteProcThreadAttributeList(list));
+
+    if (!UpdateProcThreadAttribute(list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &output, sizeof(output), 0, 0)) return false;
+
+    STARTUPINFOEXA startup = {};
+    startup.StartupInfo.cb         = sizeof(startup);
+    startup.StartupInfo.dwFlags    = STARTF_USESTDHANDLES;
+    startup.StartupInfo.hStdOutput = output;
+    startup.StartupInfo.hStdError  = output;
+    startup.lpAttributeList        = list;
+
+    // NOTE: With /s cmd only strips the outer quotes, the ones in the command are kept.
+    String prefix = "cmd.exe /s /c \"";
+
+    char *c_command = (char*)malloc(prefix.size + command.size + 2);
+    memcpy(c_command, prefix.data, prefix.size);
+    memcpy(c_command + prefix.size, command.data, command.size);
+    c_command[prefix.size + command.size]     = '"';
+    c_command[prefix.size + command.size + 1] = '\0';
+    DEFER(free(c_command));
+
+    DWORD flags = CREATE_SUSPENDED | CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT;
+
+    return CreateProcessA(0, c_command, 0, 0, TRUE, flags, 0, 0, &startup.StartupInfo, info) != 0;
+}
+
+// NOTE: Reads until a read is pending. Returns false once the pipe is closed.
+INTERNAL b32 read_output(RunningProcess *process) {
+    while (true) {
+        DWORD bytes = 0;
+
+        if (ReadFile(process->pipe, process->buffer, sizeof(process->buffer), &bytes, &process->overlapped)) {
+            append(&process->output, String(process->buffer, (s64)bytes));
+            continue;
+        }
+
+        if (GetLastError() == ERROR_IO_PENDING) return true;
+
+        return false;
+    }
+}
+
+b32 launch_process(ProcessLauncher *launcher, String command, void *user_data) {
+    if (!init_platform_launcher(launcher)) return false;
+
+    HANDLE read  = 0;
+    HANDLE write = 0;
+    if (!create_output_pipe(launcher, &read, &write)) return false;
+
+    HANDLE job = CreateJobObjectA(0, 0);
+    if (!job) {
+        CloseHandle(read);
+        CloseHandle(write);
+        return false;
+    }
+
+    PROCESS_INFORMATION info = {};
+    b32 spawned = spawn_shell(command, write, &info);
+    CloseHandle(write);
+
+    if (!spawned) {
+        CloseHandle(read);
+        CloseHandle(job);
+        return false;
+    }
+
+    // NOTE: Without the job the command still runs, only its time and memory are unknown.
+    if (!AssignProcessToJobObject(job, info.hProcess)) {
+        CloseHandle(job);
+        job = 0;
+    }
+
+    ResumeThread(info.hThread);
+    CloseHandle(info.hThread);
+
+    RunningProcess *process = ALLOC(DefaultAllocator, RunningProcess, 1);
+    process->process = info.hProcess;
+    process->job     = job;
+    process->pipe    = read;
+    process->index   = launcher->running.size;
+    process->user_data  = user_data;
+    process->start_time = platform_time_microseconds();
+
+    process->overlapped.hEvent = CreateEventA(0, TRUE, FALSE, 0);
+    process->pipe_closed = !process->overlapped.hEvent || !read_output(process);
+
+    append(&launcher->running, process);
+
+    return true;
+}
+
+// NOTE: Reads what is left in the pipe. Output of programs the command started and that still
+//       have the pipe open is lost.
+INTERNAL void drain_output(RunningProcess *process) {
+    while (!process->pipe_closed) {
+        DWORD bytes = 0;
+
+        if (!GetOverlappedResult(process->pipe, &process->overlapped, &bytes, FALSE)) {
+            if (GetLastError() == ERROR_IO_INCOMPLETE) {
+                CancelIoEx(process->pipe, &process->overlapped);
+                GetOverlappedResult(process->pipe, &process->overlapped, &bytes, TRUE);
+            }
+
+            process->pipe_closed = true;
+            break;
+        }
+
+        append(&process->output, String(process->buffer, (s64)bytes));
+        process->pipe_closed = !read_output(process);
+    }
+}
+
+INTERNAL void close_process(RunningProcess *process) {
+    CloseHandle(process->pipe);
+    CloseHandle(process->process);
+    if (process->job) CloseHandle(process->job);
+    if (process->overlapped.hEvent) CloseHandle(process->overlapped.hEvent);
+
+    destroy(&process->output);
+    deallocate(DefaultAllocator, process, sizeof(RunningProcess));
+}
+
+INTERNAL void finish_process(ProcessLauncher *launcher, RunningProcess *process, List<FinishedProcess> *finished) {
+    drain_output(process);
+
+    DWORD exit_code = 0;
+    GetExitCodeProcess(process->process, &exit_code);
+
+    FinishedProcess result = {};
+    result.user_data = process->user_data;
+    result.output    = to_allocated_string(&process->output, DefaultAllocator);
+    result.duration  = platform_time_microseconds() - process->start_time;
+    result.exit_code = (s32)exit_code;
+    result.error     = exit_code == COMMAND_NOT_FOUND;
+
+    // NOTE: Times are in 100 nanoseconds. The peak memory of the job is committed memory, not the
+    //       working set like on linux, of the largest process in it.
+    JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accounting = {};
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+
+    if (process->job && QueryInformationJobObject(process->job, JobObjectBasicAccountingInformation, &accounting, sizeof(accounting), 0)) {
+        result.cpu_time = (accounting.TotalUserTime.QuadPart + accounting.TotalKernelTime.QuadPart) / 10;
+    }
+    if (process->job && QueryInformationJobObject(process->job, JobObjectExtendedLimitInformation, &limits, sizeof(limits), 0)) {
+        result.peak_memory = (s64)limits.PeakProcessMemoryUsed;
+    }
+
+    append(finished, result);
+
+    RunningProcess *last = launcher->running[launcher->running.size - 1];
+    launcher->running[process->index] = last;
+    last->index = process->index;
+    launcher->running.size -= 1;
+
+    close_process(process);
+}
+
+// NOTE: Handles what is signaled, returns the number of processes that finished.
+INTERNAL s32 handle_signaled(ProcessLauncher *launcher, List<FinishedProcess> *finished) {
+    s32 count = 0;
+
+    // NOTE: Backwards, finished processes are replaced by the last one.
+    for (s64 i = launcher->running.size; i > 0; i -= 1) {
+        RunningProcess *process = launcher->running[i - 1];
+
+        if (!process->pipe_closed && WaitForSingleObject(process->overlapped.hEvent, 0) == WAIT_OBJECT_0) {
+            DWORD bytes = 0;
+
+            if (GetOverlappedResult(process->pipe, &process->overlapped, &bytes, FALSE)) {
+                append(&process->output, String(process->buffer, (s64)bytes));
+                process->pipe_closed = !read_output(process);
+            } else {
+                process->pipe_closed = true;
+            }
+        }
+
+        if (WaitForSingleObject(process->process, 0) == WAIT_OBJECT_0) {
+            finish_process(launcher, process, finished);
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+s32 wait_for_processes(ProcessLauncher *launcher, List<FinishedProcess> *finished, s32 timeout_ms) {
+    s32 count = 0;
+    if (launcher->running.size == 0) return count;
+
+    // NOTE: Output of a process that is still running can end the wait early, the timeout
+    //       isn't started again for that.
+    s64 start_time = platform_time_microseconds();
+
+    while (count == 0) {
+        HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+        DWORD handle_count = 0;
+
+        FOR (launcher->running, it) {
+            RunningProcess *process = *it;
+            if (handle_count + 2 > MAXIMUM_WAIT_OBJECTS) break;
+
+            handles[handle_count++] = process->process;
+            if (!process->pipe_closed) handles[handle_count++] = process->overlapped.hEvent;
+        }
+
+        s64 remaining = -1;
+        if (timeout_ms >= 0) {
+            remaining = timeout_ms - (platform_time_microseconds() - start_time) / 1000;
+            if (remaining < 0) remaining = 0;
+        }
+
+        s64 slice = remaining;
+        if (handle_count + 2 > MAXIMUM_WAIT_OBJECTS && (slice < 0 || slice > WAIT_SLICE_MS)) slice = WAIT_SLICE_MS;
+
+        DWORD result = WaitForMultipleObjects(handle_count, handles, FALSE, slice < 0 ? INFINITE : (DWORD)slice);
+        if (result == WAIT_FAILED) return count;
+
+        count += handle_signaled(launcher, finished);
+
+        if (count == 0 && remaining == 0) return count;
+    }
+
+    return count;
+}
+
+s32 running_process_count(ProcessLauncher *launcher) {
+    return (s32)launcher->running.size;
+}
+
+void destroy(ProcessLauncher *launcher) {
+    FOR (launcher->running, it) {
+        RunningProcess *process = *it;
+
+        // NOTE: The buffer of a pending read can only be freed once the read was cancelled.
+        if (!process->pipe_closed) {
+            DWORD bytes = 0;
+            CancelIoEx(process->pipe, &process->overlapped);
+            GetOverlappedResult(process->pipe, &process->overlapped, &bytes, TRUE);
+        }
+
+        WaitForSingleObject(process->process, INFINITE);
+
+        close_process(process);
+    }
+
+    if (launcher->platform) deallocate(DefaultAllocator, launcher->platform, sizeof(PlatformLauncher));
+
+    destroy(&launcher->running);
+    destroy(&launcher->finished);
+}
+
+void destroy(FinishedProcess *process) {
+    destroy(&process->output);
+}
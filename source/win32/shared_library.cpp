@@ -0,0 +1,33 @@
+#include "shared_library.h"
+
+#include "c_string.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+b32 platform_load_library(SharedLibrary *library, String file) {
+    // TODO: Use the wide char version.
+    char *path = to_c_string(file);
+    DEFER(free(path));
+
+    library->handle = LoadLibraryA(path);
+
+    return library->handle != 0;
+}
+
+void *platform_find_symbol(SharedLibrary *library, char const *name) {
+    if (!library->handle) return 0;
+
+    return (void*)GetProcAddress((HMODULE)library->handle, name);
+}
+
+void platform_unload_library(SharedLibrary *library) {
+    if (library->handle) FreeLibrary((HMODULE)library->handle);
+
+    library->handle = 0;
+}
+
@@ -0,0 +1,28 @@
+#! /bin/bash
+
+# Builds the tests with bricks --group test and runs them. Run it from the root of the repository
+# after build_gcc.sh, BRICKS selects another bricks executable.
+
+BRICKS=${BRICKS:-build/debug/bricks}
+failed=0
+
+echo Building tests
+"$BRICKS" --group test || exit 1
+
+echo Building the sample compiler plugin
+(cd samples/compiler_plugin && ./build_gcc.sh) || exit 1
+
+for test in test_compiler_plugin test_compression; do
+    echo Running $test
+    build/test/$test || failed=1
+done
+
+echo Running test_workers.sh
+BRICKS="$BRICKS" test/test_workers.sh || failed=1
+
+if [ $failed -ne 0 ]; then
+    echo Some tests failed.
+    exit 1
+fi
+
+echo run_tests.sh finished.
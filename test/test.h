@@ -0,0 +1,39 @@
+#pragma once
+
+#include "definitions.h"
+#include "string2.h"
+#include "io.h"
+
+
+// NOTE: Checks for the executables of the group "test", built with bricks --group test and run
+//       by test/run_tests.sh. A failed check prints where it is and the test goes on, the result
+//       of test_result is the exit code of the test.
+
+struct TestState {
+    s32 checks;
+    s32 failed;
+};
+
+INTERNAL TestState Test;
+
+#define CHECK(condition) check_condition((condition), #condition, __FILE__, __LINE__)
+
+INTERNAL b32 check_condition(b32 passed, char const *condition, char const *file, s32 line) {
+    Test.checks += 1;
+    if (passed) return true;
+
+    Test.failed += 1;
+    print("%S:%d: check failed: %S\n", String(file), line, String(condition));
+
+    return false;
+}
+
+INTERNAL s32 test_result(String name) {
+    if (Test.failed) {
+        print("%S: %d of %d checks failed.\n", name, Test.failed, Test.checks);
+        return 1;
+    }
+
+    print("%S: all %d checks passed.\n", name, Test.checks);
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "bricks.h"
+
+#include "bricks_plugin.h"
+#include "shared_library.h"
+#include "platform.h"
+#include "test.h"
+
+
+// NOTE: Loads the sample plugin in samples/compiler_plugin, once directly to check the version
+//       handshake and the vtable, and once through load_compiler_plugin like a blueprint does.
+//
+//       test_compiler_plugin [plugin]
+
+extern ApplicationState App;
+
+#if defined(OS_WINDOWS)
+#define SAMPLE_PLUGIN "samples/compiler_plugin/wrapper_plugin.dll"
+#else
+#define SAMPLE_PLUGIN "samples/compiler_plugin/wrapper_plugin.so"
+#endif
+
+
+// NOTE: Collects what the plugin reports. Strings are allocated with the DefaultAllocator.
+struct TestHost {
+    List<String> commands;
+    List<String> dependencies;
+    List<s32> diagnostics;
+};
+
+INTERNAL String from_plugin_string(BricksString str) {
+    return allocate_string(String((u8*)str.data, str.size), DefaultAllocator);
+}
+
+INTERNAL BricksString to_plugin_string(String str) {
+    BricksString result = {};
+    result.data = (char const*)str.data;
+    result.size = str.size;
+
+    return result;
+}
+
+INTERNAL void test_add_command(void *context, BricksString command) {
+    append(&((TestHost*)context)->commands, from_plugin_string(command));
+}
+
+INTERNAL void test_add_diagnostic(void *context, s32 kind, BricksString message) {
+    append(&((TestHost*)context)->diagnostics, kind);
+}
+
+INTERNAL void test_add_dependency(void *context, BricksString file) {
+    append(&((TestHost*)context)->dependencies, from_plugin_string(file));
+}
+
+INTERNAL void reset(TestHost *host) {
+    FOR (host->commands,     it) destroy(it);
+    FOR (host->dependencies, it) destroy(it);
+
+    host->commands.size     = 0;
+    host->dependencies.size = 0;
+    host->diagnostics.size  = 0;
+}
+
+INTERNAL void destroy(TestHost *host) {
+    reset(host);
+
+    destroy(&host->commands);
+    destroy(&host->dependencies);
+    destroy(&host->diagnostics);
+}
+
+INTERNAL void test_vtable(BricksCompilerPlugin const *vtable) {
+    TestHost test_host = {};
+    DEFER(destroy(&test_host));
+
+    BricksHost host = {};
+    host.version = BRICKS_PLUGIN_VERSION;
+    host.context = &test_host;
+    host.add_command    = test_add_command;
+    host.add_diagnostic = test_add_diagnostic;
+    host.add_dependency = test_add_dependency;
+
+    BricksString source = to_plugin_string("source/main.cpp");
+
+    BricksEntity entity = {};
+    entity.kind         = BRICKS_ENTITY_EXECUTABLE;
+    entity.name         = to_plugin_string("app");
+    entity.file_path    = to_plugin_string("build/app");
+    entity.sources.data = &source;
+    entity.sources.size = 1;
+
+    vtable->generate_commands(&host, &entity);
+
+    if (CHECK(test_host.commands.size == 1)) {
+        String command = test_host.commands[0];
+
+        CHECK(starts_with(command, "gcc"));
+        CHECK(contains(command, "-obuild/app"));
+        CHECK(contains(command, "\"source/main.cpp\""));
+    }
+    CHECK(test_host.diagnostics.size == 0);
+
+    // NOTE: The sample only builds executables and reports an error for anything else.
+    reset(&test_host);
+    entity.kind = BRICKS_ENTITY_LIBRARY;
+    vtable->generate_commands(&host, &entity);
+
+    CHECK(test_host.commands.size == 0);
+    CHECK(test_host.diagnostics.size == 1 && test_host.diagnostics[0] == BRICKS_DIAG_ERROR);
+
+    reset(&test_host);
+    vtable->process_diagnostics(&host, &entity, to_plugin_string("a.cpp:1:2: error: x\nin a.cpp\nb.h:3:4: warning: y\n"));
+
+    CHECK(test_host.diagnostics.size == 2);
+    if (test_host.diagnostics.size == 2) {
+        CHECK(test_host.diagnostics[0] == BRICKS_DIAG_ERROR);
+        CHECK(test_host.diagnostics[1] == BRICKS_DIAG_WARNING);
+    }
+
+    reset(&test_host);
+    vtable->parse_depfile(&host, &entity, to_plugin_string("main.o: source/main.cpp include/a.h \\\n include/b\\ c.h\n"));
+
+    if (CHECK(test_host.dependencies.size == 3)) {
+        CHECK(test_host.dependencies[0] == "source/main.cpp");
+        CHECK(test_host.dependencies[1] == "include/a.h");
+        CHECK(test_host.dependencies[2] == "include/b c.h");
+    }
+}
+
+// NOTE: What load_compiler_plugin checks, done by hand.
+INTERNAL void test_handshake(String file) {
+    SharedLibrary library = {};
+    if (!CHECK(platform_load_library(&library, file))) return;
+    DEFER(platform_unload_library(&library));
+
+    auto entry = (BricksCompilerPluginEntry*)platform_find_symbol(&library, BRICKS_PLUGIN_ENTRY);
+    if (!CHECK(entry != 0)) return;
+
+    // NOTE: A host older than the plugin supports gets no vtable.
+    CHECK(entry(BRICKS_PLUGIN_MIN_VERSION - 1) == 0);
+
+    BricksCompilerPlugin const *vtable = entry(BRICKS_PLUGIN_VERSION);
+    if (!CHECK(vtable != 0)) return;
+
+    CHECK(vtable->version >= BRICKS_PLUGIN_MIN_VERSION && vtable->version <= BRICKS_PLUGIN_VERSION);
+    CHECK(vtable->size == sizeof(BricksCompilerPlugin));
+    CHECK(vtable->name && String(vtable->name) == "gcc_wrapper");
+
+    CHECK(vtable->generate_commands    != 0);
+    CHECK(vtable->process_diagnostics  != 0);
+    CHECK(vtable->parse_depfile        != 0);
+    CHECK(vtable->generate_job_command != 0);
+
+    if (vtable->generate_commands && vtable->process_diagnostics && vtable->parse_depfile) test_vtable(vtable);
+}
+
+INTERNAL Compiler *find_compiler(String name) {
+    FOR (App.compilers, compiler) {
+        if (compiler->name == name) return compiler;
+    }
+
+    return 0;
+}
+
+INTERNAL void test_load_compiler_plugin(String file) {
+    CHECK(load_compiler_plugin(file));
+    CHECK(!App.has_errors);
+
+    Compiler *compiler = find_compiler("gcc_wrapper");
+    if (CHECK(compiler != 0)) {
+        CHECK(compiler->generate_commands    != 0);
+        CHECK(compiler->process_diagnostics  != 0);
+        CHECK(compiler->parse_depfile        != 0);
+        CHECK(compiler->generate_job_command != 0);
+    }
+
+    // NOTE: Blueprints that load the same plugin get the one that is loaded already.
+    s64 compiler_count = App.compilers.size;
+
+    CHECK(load_compiler_plugin(file));
+    CHECK(App.compilers.size == compiler_count);
+
+    CHECK(!load_compiler_plugin("samples/compiler_plugin/missing_plugin.so"));
+    CHECK(App.has_errors);
+    CHECK(App.compilers.size == compiler_count);
+}
+
+s32 application_main(Array<String> args) {
+    init(&App.persistent_memory, MEGABYTES(1));
+    DEFER(destroy(&App.persistent_memory));
+
+    App.persistent_alloc = make_pool_allocator(&App.persistent_memory);
+
+    String file = args.size > 1 ? args[1] : String(SAMPLE_PLUGIN);
+
+    if (!platform_file_exists(file)) {
+        print("%S does not exist, build it with samples/compiler_plugin/build_gcc.sh first.\n", file);
+        return 1;
+    }
+
+    test_handshake(file);
+    test_load_compiler_plugin(file);
+
+    return test_result("test_compiler_plugin");
+}
@@ -0,0 +1,216 @@
+#include "compression.h"
+
+#include "test.h"
+
+#include <string.h>
+
+
+// NOTE: Round trips through the LZ4 block format of compression.cpp, the lengths around the
+//       points where the format changes, and inputs that decompress has to reject.
+//
+//       test_compression
+
+
+// NOTE: xorshift, the same bytes on every run.
+INTERNAL u64 Random = 88172645463325252ull;
+
+INTERNAL u8 random_byte() {
+    Random ^= Random << 13;
+    Random ^= Random >> 7;
+    Random ^= Random << 17;
+
+    return (u8)Random;
+}
+
+struct Buffer {
+    u8 *data;
+    s64 size;
+};
+
+INTERNAL Buffer make_buffer(s64 size) {
+    Buffer result = {};
+    result.data = ALLOC(DefaultAllocator, u8, size + 1);
+    result.size = size;
+
+    return result;
+}
+
+INTERNAL void destroy(Buffer *buffer) {
+    deallocate(DefaultAllocator, buffer->data, buffer->size + 1);
+    *buffer = {};
+}
+
+INTERNAL String to_string(Buffer buffer) {
+    return String(buffer.data, buffer.size);
+}
+
+// NOTE: Returns the compressed size, -1 if the round trip failed.
+INTERNAL s64 round_trip(String input) {
+    Buffer compressed = make_buffer(compress_bound(input.size));
+    DEFER(destroy(&compressed));
+
+    compressed.size = compress(input, compressed.data);
+    if (!CHECK(compressed.size > 0 && compressed.size <= compress_bound(input.size))) return -1;
+
+    Buffer output = make_buffer(input.size);
+    DEFER(destroy(&output));
+
+    if (!CHECK(decompress(to_string(compressed), output.data, output.size))) return -1;
+    if (input.size > 0 && !CHECK(memcmp(output.data, input.data, input.size) == 0)) return -1;
+
+    // NOTE: The caller keeps the size, anything else is wrong.
+    Buffer shorter = make_buffer(input.size);
+    DEFER(destroy(&shorter));
+
+    if (input.size > 0) CHECK(!decompress(to_string(compressed), shorter.data, input.size - 1));
+
+    Buffer longer = make_buffer(input.size + 1);
+    DEFER(destroy(&longer));
+
+    CHECK(!decompress(to_string(compressed), longer.data, input.size + 1));
+
+    return compressed.size;
+}
+
+INTERNAL void test_empty() {
+    CHECK(round_trip({}) == 1);
+
+    u8 output = 0;
+    CHECK(!decompress({}, &output, 1));
+}
+
+// NOTE: Up to 12 bytes nothing is matched, the input is one sequence of literals.
+INTERNAL void test_small_inputs() {
+    u8 same[12];
+    memset(same, 'a', sizeof(same));
+
+    for (s64 size = 1; size < 13; size += 1) {
+        CHECK(round_trip(String(same, size)) == size + 1);
+    }
+
+    u8 text[] = "abcdabcdabcdabcd";
+    for (s64 size = 1; size <= 16; size += 1) round_trip(String(text, size));
+}
+
+// NOTE: Literal counts of 15 and more continue in extra bytes, 270 is the first one with two.
+INTERNAL void test_long_literals() {
+    s64 sizes[] = {14, 15, 16, 269, 270, 271, 524, 525, 4000};
+
+    for (s64 i = 0; i < (s64)(sizeof(sizes) / sizeof(sizes[0])); i += 1) {
+        Buffer input = make_buffer(sizes[i]);
+        DEFER(destroy(&input));
+
+        for (s64 j = 0; j < input.size; j += 1) input.data[j] = random_byte();
+
+        CHECK(round_trip(to_string(input)) != -1);
+    }
+}
+
+// NOTE: Match lengths of 19 and more continue in extra bytes, 274 is the first one with two. A run
+//       of one byte is one literal and a match with an offset of 1 up to the last 5 bytes, so the
+//       match overlaps the bytes it writes.
+INTERNAL void test_long_matches() {
+    s64 sizes[] = {13, 24, 25, 26, 40, 279, 280, 281, 300, 100000};
+
+    for (s64 i = 0; i < (s64)(sizeof(sizes) / sizeof(sizes[0])); i += 1) {
+        Buffer input = make_buffer(sizes[i]);
+        DEFER(destroy(&input));
+
+        memset(input.data, 'x', input.size);
+
+        s64 size = round_trip(to_string(input));
+        if (input.size >= 40) CHECK(size != -1 && size < input.size / 2);
+    }
+
+    // NOTE: Offsets shorter than the match, and literals between the matches.
+    Buffer input = make_buffer(5000);
+    DEFER(destroy(&input));
+
+    for (s64 j = 0; j < input.size; j += 1) {
+        input.data[j] = j % 700 < 20 ? random_byte() : (u8)('a' + j % 3);
+    }
+
+    s64 size = round_trip(to_string(input));
+    CHECK(size != -1 && size < input.size / 4);
+}
+
+// NOTE: Repeats that are further apart than the largest offset can't be matched.
+INTERNAL void test_far_repeats() {
+    Buffer input = make_buffer(200000);
+    DEFER(destroy(&input));
+
+    for (s64 j = 0; j < 70000; j += 1) input.data[j] = random_byte();
+    memcpy(input.data + 70000, input.data, 70000);
+    memcpy(input.data + 140000, input.data + 30000, 60000);
+
+    CHECK(round_trip(to_string(input)) != -1);
+}
+
+INTERNAL void test_corrupt_input() {
+    String text = "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.";
+
+    Buffer compressed = make_buffer(compress_bound(text.size));
+    DEFER(destroy(&compressed));
+
+    compressed.size = compress(text, compressed.data);
+
+    Buffer output = make_buffer(text.size);
+    DEFER(destroy(&output));
+
+    if (!CHECK(decompress(to_string(compressed), output.data, output.size))) return;
+
+    // NOTE: Cut off anywhere, the input ends in the middle of a sequence or misses the last one.
+    for (s64 size = 0; size < compressed.size; size += 1) {
+        CHECK(!decompress(String(compressed.data, size), output.data, output.size));
+    }
+
+    // NOTE: A match before the start of the output.
+    u8 before_start[] = {0x10, 'a', 0x02, 0x00, 0x10, 'b'};
+    CHECK(!decompress(String(before_start, sizeof(before_start)), output.data, 7));
+
+    // NOTE: An offset of 0.
+    u8 zero_offset[] = {0x10, 'a', 0x00, 0x00, 0x10, 'b'};
+    CHECK(!decompress(String(zero_offset, sizeof(zero_offset)), output.data, 6));
+
+    // NOTE: Lengths that continue past the end of the input.
+    u8 literal_length[] = {0xf0, 0xff};
+    CHECK(!decompress(String(literal_length, sizeof(literal_length)), output.data, output.size));
+
+    u8 match_length[] = {0x1f, 'a', 0x01, 0x00, 0xff};
+    CHECK(!decompress(String(match_length, sizeof(match_length)), output.data, output.size));
+
+    // NOTE: More literals than the input has.
+    u8 literals[] = {0x50, 'a', 'b'};
+    CHECK(!decompress(String(literals, sizeof(literals)), output.data, 5));
+
+    // NOTE: A match that writes past the end of the output.
+    u8 long_match[] = {0x1f, 'a', 0x01, 0x00, 0x20, 0x00};
+    CHECK(!decompress(String(long_match, sizeof(long_match)), output.data, 10));
+
+    // NOTE: Random bytes may decompress to anything, but must never write past the output.
+    Buffer noise = make_buffer(64);
+    DEFER(destroy(&noise));
+
+    Buffer small = make_buffer(32);
+    DEFER(destroy(&small));
+
+    for (s32 round = 0; round < 1000; round += 1) {
+        for (s64 j = 0; j < noise.size; j += 1) noise.data[j] = random_byte();
+
+        small.data[small.size] = 0xa5;
+        decompress(to_string(noise), small.data, small.size);
+
+        CHECK(small.data[small.size] == 0xa5);
+    }
+}
+
+s32 application_main(Array<String> args) {
+    test_empty();
+    test_small_inputs();
+    test_long_literals();
+    test_long_matches();
+    test_far_repeats();
+    test_corrupt_input();
+
+    return test_result("test_compression");
+}
@@ -0,0 +1,71 @@
+#! /bin/bash
+
+# Starts two workers in the same folder on localhost and builds a small project against them.
+# Checks that the workers compiled without failing, that the program runs and that the debug info
+# doesn't name the folders the workers compiled in. Run it from the root of the repository.
+
+BRICKS=$(realpath "${BRICKS:-build/debug/bricks}")
+FOLDER=build/test/workers
+PORTS="7181 7182"
+
+rm -rf "$FOLDER"
+mkdir -p "$FOLDER/worker" "$FOLDER/project/source"
+
+workers=()
+trap 'kill ${workers[@]} 2> /dev/null' EXIT
+
+for port in $PORTS; do
+    (cd "$FOLDER/worker" && exec "$BRICKS" worker --port $port --jobs 2 > worker_$port.log 2>&1) &
+    workers+=($!)
+done
+
+for port in $PORTS; do
+    for i in $(seq 50); do
+        grep -q "Worker listening" "$FOLDER/worker/worker_$port.log" 2> /dev/null && break
+        sleep 0.1
+    done
+done
+
+cd "$FOLDER/project"
+
+cat > blueprint << 'BLUEPRINT'
+executable: app {
+    folder: "build";
+    debug_info: minimal;
+    sources: glob "source/*.cpp";
+}
+BLUEPRINT
+
+count=8
+for i in $(seq $count); do
+    echo "int value_$i() { return $i; }" > source/value_$i.cpp
+done
+
+{
+    for i in $(seq $count); do echo "int value_$i();"; done
+    echo "int main() { return value_1() + value_$count() == $((count + 1)) ? 0 : 1; }"
+} > source/main.cpp
+
+failed=0
+
+"$BRICKS" --worker localhost:7181/2,localhost:7182/2 > build.log 2>&1 || failed=1
+cat build.log
+
+# NOTE: Free local jobs compile as well, so only some compiles have to run on the workers.
+grep -q "compiles ran on workers" build.log || { echo "No compile ran on a worker."; failed=1; }
+grep -q "ran locally after their worker failed" build.log && { echo "A worker failed."; failed=1; }
+build/app || { echo "The program built by the workers failed."; failed=1; }
+
+for object in $(find . -name "*.o"); do
+    if strings "$object" | grep -q "/worker/"; then
+        echo "$object names the folder of a worker."
+        failed=1
+    fi
+done
+
+if [ $failed -ne 0 ]; then
+    echo test_workers.sh failed.
+    exit 1
+fi
+
+echo test_workers.sh finished.